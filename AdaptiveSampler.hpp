@@ -0,0 +1,153 @@
+#ifndef AdaptiveSampler_H
+#define AdaptiveSampler_H
+
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <stdexcept>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+
+// Quadtree (Dim = 2) / octree (Dim = 3) refinement of a box in parameter space.
+// Cells are split only when the ESS verdict or the equilibrium state h changes
+// between their corners, so uniform regions are covered by a few large cells
+// and the evaluations concentrate along the ESS boundaries.
+template <size_t Dim>
+class AdaptiveSampler {
+    public:
+        using Point = std::array<double, Dim>;
+        using Lattice = std::array<uint32_t, Dim>;
+
+        struct Sample {
+            double h;
+            bool is_ess;
+        };
+
+        struct Cell {
+            Lattice origin;        // lower corner on the finest lattice
+            int level;             // 0 is the whole box
+            double h;              // mean of h over the corners
+            double ess_fraction;   // fraction of corners that are ESS
+        };
+
+        using Evaluator = std::function<Sample(const Point&)>;
+
+        AdaptiveSampler(const Point& lower, const Point& upper, int min_level, int max_level,
+                        double h_tolerance, Evaluator evaluate)
+            : lower(lower), upper(upper), min_level(min_level), max_level(max_level),
+              h_tolerance(h_tolerance), evaluate(std::move(evaluate)) {
+            if (min_level < 0 || min_level > max_level || max_level > 20) {
+                throw std::runtime_error("AdaptiveSampler: levels must satisfy 0 <= min_level <= max_level <= 20");
+            }
+        }
+
+        // Number of refinement levels needed to reach `resolution` along the widest axis.
+        static int LevelsForResolution(const Point& lower, const Point& upper, double resolution) {
+            double widest = 0.0;
+            for (size_t d = 0; d < Dim; d++) {
+                widest = std::max(widest, upper[d] - lower[d]);
+            }
+            int level = 0;
+            while (widest / static_cast<double>(1u << level) > resolution) {
+                level++;
+            }
+            return level;
+        }
+
+        std::vector<Cell> Run() {
+            std::vector<Cell> leaves;
+            std::vector<std::pair<Lattice, int>> stack = {{Lattice{}, 0}};
+            while (!stack.empty()) {
+                auto [origin, level] = stack.back();
+                stack.pop_back();
+
+                uint32_t span = 1u << (max_level - level);
+                bool first = true;
+                double h_min = 0.0, h_max = 0.0, h_sum = 0.0;
+                int n_ess = 0;
+                for (size_t corner = 0; corner < NumCorners; corner++) {
+                    Lattice p = origin;
+                    for (size_t d = 0; d < Dim; d++) {
+                        if ((corner >> d) & 1) { p[d] += span; }
+                    }
+                    const Sample& s = SampleAt(p);
+                    h_sum += s.h;
+                    n_ess += s.is_ess;
+                    if (first) { h_min = h_max = s.h; first = false; }
+                    h_min = std::min(h_min, s.h);
+                    h_max = std::max(h_max, s.h);
+                }
+                bool split = (n_ess != 0 && n_ess != static_cast<int>(NumCorners)) || (h_max - h_min > h_tolerance);
+
+                if (level < min_level || (split && level < max_level)) {
+                    uint32_t half = span / 2;
+                    for (size_t child = 0; child < NumCorners; child++) {
+                        Lattice c = origin;
+                        for (size_t d = 0; d < Dim; d++) {
+                            if ((child >> d) & 1) { c[d] += half; }
+                        }
+                        stack.push_back({c, level + 1});
+                    }
+                } else {
+                    leaves.push_back({origin, level, h_sum / NumCorners,
+                                      static_cast<double>(n_ess) / NumCorners});
+                }
+            }
+            return leaves;
+        }
+
+        Point Lower(const Cell& cell) const { return ToPoint(cell.origin); }
+
+        Point Size(const Cell& cell) const {
+            Point size;
+            for (size_t d = 0; d < Dim; d++) {
+                size[d] = (upper[d] - lower[d]) / static_cast<double>(1u << cell.level);
+            }
+            return size;
+        }
+
+        size_t NumEvaluations() const { return cache.size(); }
+
+        // Number of evaluations a uniform grid at the finest level would need.
+        size_t NumUniformEvaluations() const {
+            size_t n = 1;
+            for (size_t d = 0; d < Dim; d++) { n *= (1u << max_level) + 1; }
+            return n;
+        }
+
+    private:
+        static constexpr size_t NumCorners = 1u << Dim;
+
+        Point lower, upper;
+        int min_level, max_level;
+        double h_tolerance;
+        Evaluator evaluate;
+        // corners are shared between neighbouring cells, so every lattice point is evaluated once
+        std::unordered_map<uint64_t, Sample> cache;
+
+        Point ToPoint(const Lattice& p) const {
+            Point x;
+            double n = static_cast<double>(1u << max_level);
+            for (size_t d = 0; d < Dim; d++) {
+                x[d] = lower[d] + (upper[d] - lower[d]) * (static_cast<double>(p[d]) / n);
+            }
+            return x;
+        }
+
+        const Sample& SampleAt(const Lattice& p) {
+            uint64_t key = 0;
+            for (size_t d = 0; d < Dim; d++) {
+                key = (key << 21) | p[d];
+            }
+            auto it = cache.find(key);
+            if (it == cache.end()) {
+                it = cache.emplace(key, evaluate(ToPoint(p))).first;
+            }
+            return it->second;
+        }
+};
+
+#endif
@@ -0,0 +1,188 @@
+#ifndef AgentSimulator_H
+#define AgentSimulator_H
+
+#include "Norms.hpp"
+#include "SweepEngine.hpp"
+#include "CounterRNG.hpp"
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cmath>
+#include <stdexcept>
+
+
+namespace two_action {
+
+// Agent-based donation game under public assessment with the error model of Game.hpp.
+// In every interaction a random donor meets a random recipient; the donor's intended
+// action follows its action rule, cooperation fails with probability mu_e, an observed
+// defection is perceived as cooperation with probability perception_error, the
+// institution assigns the image prescribed by the resident assessment rule and flips
+// it with probability assessment_error.
+//
+// Invaders are rare probes: they only meet residents, and interactions with them do
+// not update resident images, so the resident state is that of the monomorphic
+// population as in Game::calc_invader_stats.
+//
+// The population is stored as a structure of arrays (images, counters) indexed by
+// agent; residents occupy [0, population_size) and invaders the rest.
+class AgentSimulator {
+    public:
+        double assessment_error;
+        double perception_error;
+        double mu_e;
+        Norm norm;
+        ActionRule invader;
+        size_t population_size;
+        size_t num_invaders;
+
+        struct Result {
+            Estimate h;                 // share of good residents
+            Estimate resident_coop;     // cooperation among residents
+            Estimate resident_payoff;
+            Estimate invader_h;         // share of good invaders
+            Estimate coop_mut_to_res;
+            Estimate coop_res_to_mut;
+            Estimate invader_payoff;
+            uint64_t interactions = 0;
+            unsigned threads = 0;       // workers that ran the replicates
+        };
+
+        AgentSimulator(double assessment_error, double perception_error, double mu_e, const Norm& norm,
+                       const ActionRule& invader, size_t population_size = 1000, size_t num_invaders = 100)
+            : assessment_error(assessment_error), perception_error(perception_error), mu_e(mu_e), norm(norm),
+              invader(invader), population_size(population_size), num_invaders(num_invaders) {
+            if (population_size < 2) { throw std::runtime_error("AgentSimulator: need at least two residents"); }
+            for (size_t i = 0; i < 4; i++) {
+                act_threshold[0][i] = CounterRNG::Threshold(norm.action_rule.coop_probs[i]);
+                act_threshold[1][i] = CounterRNG::Threshold(invader.coop_probs[i]);
+            }
+            for (size_t i = 0; i < 8; i++) {
+                good_threshold[i] = CounterRNG::Threshold(norm.assessment_rule.good_probs[i]);
+            }
+            implementation_threshold = CounterRNG::Threshold(mu_e);
+            perception_threshold = CounterRNG::Threshold(perception_error);
+            assignment_threshold = CounterRNG::Threshold(assessment_error);
+        }
+
+        // Runs num_replicates independent populations for burn_in + rounds rounds, where a
+        // round is one interaction per agent on average, and splits the measured rounds of
+        // every replicate into num_batches batches. Replicate r uses stream r of `seed`.
+        Result Run(double benefit, double cost, size_t burn_in, size_t rounds, size_t num_replicates = 8,
+                   size_t num_batches = 10, uint64_t seed = 1, unsigned num_threads = 0) const {
+            if (num_batches == 0 || rounds < num_batches) {
+                throw std::runtime_error("AgentSimulator: need at least one round per batch");
+            }
+            std::vector<BatchTotals> batches(num_replicates * num_batches);
+            ParallelFor(num_replicates, [&](size_t begin, size_t end, unsigned) {
+                for (size_t r = begin; r < end; r++) {
+                    RunReplicate(CounterRNG(seed, r), burn_in, rounds, num_batches, &batches[r * num_batches]);
+                }
+            }, num_threads);
+
+            Result result;
+            // as in ParallelFor: no more workers than replicates
+            result.threads = static_cast<unsigned>(std::min<size_t>(NumWorkerThreads(num_threads),
+                                                                    std::max<size_t>(num_replicates, 1)));
+            std::vector<double> h, rc, rp, ih, mr, rm, ip;
+            for (const auto& b : batches) {
+                double coop_rr = b.Rate(b.coop_rr, b.n_rr);
+                double coop_mr = b.Rate(b.coop_mr, b.n_mr);
+                double coop_rm = b.Rate(b.coop_rm, b.n_rm);
+                h.push_back(b.good_residents / b.samples);
+                ih.push_back(b.good_invaders / b.samples);
+                rc.push_back(coop_rr);
+                mr.push_back(coop_mr);
+                rm.push_back(coop_rm);
+                rp.push_back((benefit - cost) * coop_rr);
+                ip.push_back(benefit * coop_rm - cost * coop_mr);
+                result.interactions += b.n_rr + b.n_mr + b.n_rm;
+            }
+            result.h = Estimate::FromBatches(h);
+            result.resident_coop = Estimate::FromBatches(rc);
+            result.resident_payoff = Estimate::FromBatches(rp);
+            if (num_invaders > 0) {
+                result.invader_h = Estimate::FromBatches(ih);
+                result.coop_mut_to_res = Estimate::FromBatches(mr);
+                result.coop_res_to_mut = Estimate::FromBatches(rm);
+                result.invader_payoff = Estimate::FromBatches(ip);
+            }
+            return result;
+        }
+
+    private:
+        std::array<std::array<uint64_t, 4>, 2> act_threshold;   // [resident/invader][donor image * 2 + recipient image]
+        std::array<uint64_t, 8> good_threshold;                 // [donor * 4 + recipient * 2 + action]
+        uint64_t implementation_threshold, perception_threshold, assignment_threshold;
+
+        struct BatchTotals {
+            uint64_t coop_rr = 0, n_rr = 0;   // resident -> resident
+            uint64_t coop_mr = 0, n_mr = 0;   // invader -> resident
+            uint64_t coop_rm = 0, n_rm = 0;   // resident -> invader
+            double good_residents = 0.0, good_invaders = 0.0;
+            double samples = 0.0;
+
+            static double Rate(uint64_t k, uint64_t n) { return n > 0 ? static_cast<double>(k) / n : 0.0; }
+        };
+
+        // Actual action (1 = C) of a donor of type `type` and the image the institution assigns.
+        uint8_t Act(CounterRNG& rng, int type, uint8_t donor, uint8_t recipient, uint8_t& image) const {
+            uint8_t action = rng.Bernoulli(act_threshold[type][donor * 2 + recipient]);
+            if (action && rng.Bernoulli(implementation_threshold)) { action = 0; }
+            uint8_t observed = action;
+            if (!observed && rng.Bernoulli(perception_threshold)) { observed = 1; }
+            image = rng.Bernoulli(good_threshold[donor * 4 + recipient * 2 + observed]);
+            if (rng.Bernoulli(assignment_threshold)) { image ^= 1; }
+            return action;
+        }
+
+        void RunReplicate(CounterRNG rng, size_t burn_in, size_t rounds, size_t num_batches, BatchTotals* batches) const {
+            const size_t n_res = population_size, n_all = population_size + num_invaders;
+            std::vector<uint8_t> image(n_all);
+            for (auto& x : image) { x = static_cast<uint8_t>(rng.Next() & 1); }
+            uint64_t good_residents = 0, good_invaders = 0;
+            for (size_t i = 0; i < n_res; i++) { good_residents += image[i]; }
+            for (size_t i = n_res; i < n_all; i++) { good_invaders += image[i]; }
+
+            const size_t per_batch = rounds / num_batches;
+            for (size_t round = 0; round < burn_in + per_batch * num_batches; round++) {
+                BatchTotals scratch;
+                BatchTotals& t = (round < burn_in) ? scratch : batches[(round - burn_in) / per_batch];
+                for (size_t k = 0; k < n_all; k++) {
+                    size_t donor = rng.Index(n_all);
+                    uint8_t new_image;
+                    if (donor < n_res) {
+                        size_t recipient = rng.Index(n_all - 1);
+                        recipient += (recipient >= donor);
+                        uint8_t action = Act(rng, 0, image[donor], image[recipient], new_image);
+                        if (recipient < n_res) {
+                            t.coop_rr += action;
+                            t.n_rr++;
+                            good_residents += new_image;
+                            good_residents -= image[donor];
+                            image[donor] = new_image;
+                        } else {
+                            t.coop_rm += action;
+                            t.n_rm++;
+                        }
+                    } else {
+                        size_t recipient = rng.Index(n_res);
+                        uint8_t action = Act(rng, 1, image[donor], image[recipient], new_image);
+                        t.coop_mr += action;
+                        t.n_mr++;
+                        good_invaders += new_image;
+                        good_invaders -= image[donor];
+                        image[donor] = new_image;
+                    }
+                }
+                t.good_residents += static_cast<double>(good_residents) / n_res;
+                t.good_invaders += (num_invaders > 0) ? static_cast<double>(good_invaders) / num_invaders : 0.0;
+                t.samples += 1.0;
+            }
+        }
+};
+
+}  // namespace two_action
+
+#endif
@@ -1,3 +1,6 @@
+#ifndef AllNorms_H
+#define AllNorms_H
+
 #include "Norms.hpp"
 #include "Game.hpp"
 #include <bitset>
@@ -7,7 +10,7 @@
 
 using IntVec = std::vector<int>;
 
-std::vector<IntVec> create_self_symmetric_norms() {
+inline std::vector<IntVec> create_self_symmetric_norms() {
     std::vector<IntVec> norms;
     
     for (int i = 0; i < (1 << 6); ++i) {
@@ -26,14 +29,14 @@ std::vector<IntVec> create_self_symmetric_norms() {
     return norms;
 }
 
-bool is_flipped(const IntVec& a, const IntVec& b) {
+inline bool is_flipped(const IntVec& a, const IntVec& b) {
     for (size_t i = 0; i < a.size(); ++i)
         if (b[i] != 1 - a[i])
             return false;
     return true;
 }
 
-std::vector<IntVec> generate_all_norms() {
+inline std::vector<IntVec> generate_all_norms() {
     std::vector<IntVec> SNorms = create_self_symmetric_norms();
     std::vector<IntVec> NormsToCheck;
 
@@ -66,3 +69,5 @@ std::vector<IntVec> generate_all_norms() {
     NormsToCheck.insert(NormsToCheck.end(), SNorms.begin(), SNorms.end());
     return NormsToCheck;
 }
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef AssessmentRule_H
+#define AssessmentRule_H
+
+#include <array>
+#include <map>
+#include <tuple>
+#include <string>
+#include <sstream>
+#include <stdexcept>
+
+
+// Assessment rule of a model with NA actions, shared by Norms.hpp (NA = 2) and
+// NormsWithPunishment.hpp (NA = 3), which pass their Reputation and Action enums.
+// good_probs has the layout of GameEngine.hpp: (donor * 2 + recipient) * NA + action.
+// ActionToString and ReputationToString are those of the model's namespace.
+template <int NA, typename Reputation, typename Action>
+class BasicAssessmentRule {
+    public:
+        static constexpr int NumEntries = 4 * NA;
+
+        std::array<double, NumEntries> good_probs;
+
+        // Constructor using std::array
+        BasicAssessmentRule(const std::array<double, NumEntries>& g_probs) : good_probs(g_probs) {}
+
+        // Constructor using std::map
+        BasicAssessmentRule(const std::map<std::tuple<Reputation, Reputation, Action>, double>& g_probs) {
+            if (g_probs.size() != NumEntries) {
+                throw std::runtime_error("AssessmentRule: g_probs must have " + std::to_string(NumEntries) + " elements");
+            }
+            for (int i = 0; i < NumEntries; i++) {
+                good_probs[i] = g_probs.at({static_cast<Reputation>(i / NA / 2), static_cast<Reputation>(i / NA % 2),
+                                            static_cast<Action>(i % NA)});
+            }
+        }
+
+        // Assignment errors flip the image; perception errors make a defection (action 0)
+        // look like a cooperation (action 1).
+        BasicAssessmentRule RescaleWithError(double assignment_error = 0, double perception_error = 0) const {
+            std::array<double, NumEntries> rescaled = {0.0};
+            for (int i = 0; i < NumEntries; i++) {
+                rescaled[i] = (1 - assignment_error) * good_probs[i] + assignment_error * (1 - good_probs[i]);
+            }
+            for (int i = 0; i < NumEntries; i += NA) {
+                rescaled[i] = (1 - perception_error) * rescaled[i] + perception_error * rescaled[i + 1];
+            }
+            return BasicAssessmentRule{rescaled};
+        }
+
+        double operator()(Reputation r1, Reputation r2, Action a) const { return good_probs[Index(r1, r2, a)]; }
+
+        void Set(Reputation r1, Reputation r2, Action a, double p) { good_probs[Index(r1, r2, a)] = p; }
+
+        bool IsDeterministic() const {
+            for (double p : good_probs) {
+                if (p != 0.0 && p != 1.0) { return false; }
+            }
+            return true;
+        }
+
+        int ID() const {
+            if (!IsDeterministic()) { return -1; }
+            int id = 0;
+            for (int i = 0; i < NumEntries; i++) {
+                if (good_probs[i] == 1.0) { id += 1 << i; }
+            }
+            return id;
+        }
+
+        static BasicAssessmentRule MakeDeterministicRule(int id) {
+            if (id < 0 || id >= (1 << NumEntries)) {
+                throw std::runtime_error("AssessmentRule: id must be between 0 and " + std::to_string((1 << NumEntries) - 1));
+            }
+            std::array<double, NumEntries> g_probs;
+            for (int i = 0; i < NumEntries; i++) { g_probs[i] = (id >> i) & 1; }
+            return BasicAssessmentRule(g_probs);
+        }
+
+        static BasicAssessmentRule AllGood() { return MakeDeterministicRule((1 << NumEntries) - 1); }
+        static BasicAssessmentRule AllBad() { return MakeDeterministicRule(0); }
+
+        // good when cooperating
+        static BasicAssessmentRule ImageScoring() {
+            std::array<double, NumEntries> g_probs;
+            for (int i = 0; i < NumEntries; i++) { g_probs[i] = (i % NA == 1) ? 1.0 : 0.0; }
+            return BasicAssessmentRule{g_probs};
+        }
+
+        // the image of the recipient, whatever the action
+        static BasicAssessmentRule KeepRecipient() {
+            std::array<double, NumEntries> g_probs;
+            for (int i = 0; i < NumEntries; i++) { g_probs[i] = i / NA % 2; }
+            return BasicAssessmentRule{g_probs};
+        }
+
+        std::string Inspect() const {
+            std::stringstream ss;
+            ss << "AssessmentRule: " << ID() << std::endl;
+            ss << "===================" << std::endl;
+            for (int i = 0; i < NumEntries; i++) {
+                Reputation rep_d = static_cast<Reputation>(i / NA / 2);
+                Reputation rep_r = static_cast<Reputation>(i / NA % 2);
+                Action act = static_cast<Action>(i % NA);
+                ss << "(" << ReputationToString(rep_d) << " -> " << ReputationToString(rep_r) << ", "
+                   << ActionToString(act) << ") : " << good_probs[i] << "\n";
+            }
+            return ss.str();
+        }
+
+    private:
+        static int Index(Reputation r1, Reputation r2, Action a) {
+            const int d = static_cast<int>(r1), r = static_cast<int>(r2), x = static_cast<int>(a);
+            if (d < 0 || d > 1 || r < 0 || r > 1 || x < 0 || x >= NA) {
+                throw std::runtime_error("Invalid reputation-action combination");
+            }
+            return (d * 2 + r) * NA + x;
+        }
+};
+
+template <int NA, typename Reputation, typename Action>
+inline bool operator==(const BasicAssessmentRule<NA, Reputation, Action>& t1,
+                       const BasicAssessmentRule<NA, Reputation, Action>& t2) {
+    return t1.good_probs == t2.good_probs;
+}
+
+template <int NA, typename Reputation, typename Action>
+inline bool operator!=(const BasicAssessmentRule<NA, Reputation, Action>& t1,
+                       const BasicAssessmentRule<NA, Reputation, Action>& t2) {
+    return !(t1 == t2);
+}
+
+#endif
@@ -0,0 +1,614 @@
+#ifndef BatchRunner_H
+#define BatchRunner_H
+
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "NormsWithPunishment.hpp"
+#include "GameWithPunishment.hpp"
+#include "SweepEngine.hpp"
+#include "ResultCache.hpp"
+
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+
+
+// Runs many sweeps in one process. A manifest lists jobs, each a set of norms of one
+// model, a grid of parameters and a sink:
+//
+//     [job leading_eight_errors]
+//     model = two_action
+//     norms = leading_eight
+//     assessment_error = 0:0.1:0.002      # start:stop:step, or a list 0.01,0.02
+//     perception_error = 0:0.1:0.002
+//     mu_e = 0:0.1:0.002
+//     benefit = 1
+//     cost = 0.8
+//     columns = h,is_ess
+//     sink = rows                          # one row per point, summary per norm or invaders
+//     layout = order, norm_id as ID, h, is_ess as isNash, assessment_error, perception_error, mu_e
+//     output = leading_eight_ESS_with_errors.csv
+//
+// The invaders sink writes a row per point and deterministic invader, with the invader's
+// ID, action rule and payoff. A layout lists the fields of the rows, optionally renamed
+// with `as`: order (position of the norm in the job), norm_id, the axes, the columns and
+// for invaders invader, invader_BB ... invader_GG and invader_payoff; without one, the rows
+// are norm_id, the axes, the columns and the invader fields. figures.manifest reproduces
+// the datasets of the figure scripts this way.
+//
+// The points of all jobs are grouped by the game they need (model, norm and error
+// rates): every game is built once, in one parallel pass, and evaluated for all the
+// payoff parameters of all jobs that use it.
+namespace batch {
+
+enum class Model { TwoAction, WithPunishment };
+
+// Norms of equalizers_norms.cpp in Job::norms: discriminators whose assessment after
+// defection (and, for the cautious one, after cooperation) depends on the assessment
+// error, benefit and cost of the point.
+constexpr int GenerousScoringEqualizer = -1, CautiousScoringEqualizer = -2;
+
+struct Axis {
+    std::string name;
+    std::vector<double> values;
+};
+
+struct Job {
+    std::string name;
+    Model model = Model::TwoAction;
+    std::vector<int> norms;
+    std::vector<Axis> axes;              // in the order of ModelAxes
+    std::vector<std::string> columns;
+    std::string sink = "rows";
+    bool only_ess = false;               // rows and invaders sinks: write ESS points only
+    bool skip_resident = false;          // invaders sink: leave out the residents' action rule
+    bool rescale_payoffs = false;        // payoffs with benefit and cost times 1 - mu_e
+    std::vector<std::pair<std::string, std::string>> layout;   // (header, field)
+    std::string output;
+
+    size_t NumPoints() const {
+        size_t n = norms.size();
+        for (const auto& axis : axes) { n *= axis.values.size(); }
+        return n;
+    }
+
+    // results per point: the columns, then the payoffs of the 16 deterministic invaders
+    size_t Stride() const { return columns.size() + (sink == "invaders" ? 16 : 0); }
+};
+
+// Axes of each model; the first NumGameAxes fix the game, the rest are payoff parameters.
+inline const std::vector<std::string>& ModelAxes(Model model) {
+    static const std::vector<std::string> two_action = {"assessment_error", "perception_error", "mu_e", "benefit", "cost"};
+    static const std::vector<std::string> with_punishment = {"assessment_error", "perception_error", "benefit", "cost",
+                                                             "punishment", "punishment_cost"};
+    return model == Model::TwoAction ? two_action : with_punishment;
+}
+
+inline int NumGameAxes(Model model) { return model == Model::TwoAction ? 3 : 2; }
+
+inline const std::vector<std::string>& ModelColumns(Model model) {
+    static const std::vector<std::string> two_action = {"h", "cooperation", "is_ess", "delta_v", "ess_margin",
+                                                        "resident_payoff"};
+    static const std::vector<std::string> with_punishment = {"h", "cooperation", "resident_punishment", "is_ess", "delta_v"};
+    return model == Model::TwoAction ? two_action : with_punishment;
+}
+
+namespace detail {
+
+inline std::string Trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) { return ""; }
+    size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+inline std::vector<std::string> Split(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, sep)) { parts.push_back(Trim(part)); }
+    return parts;
+}
+
+inline double ToDouble(const std::string& s) {
+    size_t used = 0;
+    double x = std::stod(s, &used);
+    if (used != s.size()) { throw std::invalid_argument(s); }
+    return x;
+}
+
+// "start:stop:step" (stop included up to rounding) or a comma-separated list.
+inline std::vector<double> ParseValues(const std::string& s) {
+    std::vector<double> values;
+    auto range = Split(s, ':');
+    if (range.size() == 3) {
+        double start = ToDouble(range[0]), stop = ToDouble(range[1]), step = ToDouble(range[2]);
+        if (!(step > 0.0) || stop < start) { throw std::invalid_argument(s); }
+        long n = std::lround(std::floor((stop - start) / step + 1e-9)) + 1;
+        for (long i = 0; i < n; i++) { values.push_back(start + i * step); }
+    } else if (range.size() == 1) {
+        for (const auto& v : Split(s, ',')) { values.push_back(ToDouble(v)); }
+    } else {
+        throw std::invalid_argument(s);
+    }
+    if (values.empty()) { throw std::invalid_argument(s); }
+    return values;
+}
+
+// "all", "leading_eight", L1 ... L8 (two-action only) and decimal or 0x-prefixed IDs,
+// comma-separated; with `equalizers` also generous_scoring_equalizer and
+// cautious_scoring_equalizer (two-action only).
+inline std::vector<int> ParseNorms(const std::string& s, Model model, bool equalizers = false) {
+    std::vector<int> ids;
+    for (const auto& item : Split(s, ',')) {
+        if (equalizers && model == Model::TwoAction && item == "generous_scoring_equalizer") {
+            ids.push_back(GenerousScoringEqualizer);
+        } else if (equalizers && model == Model::TwoAction && item == "cautious_scoring_equalizer") {
+            ids.push_back(CautiousScoringEqualizer);
+        } else if (item == "all") {
+            if (model == Model::TwoAction) {
+                for (int id = 0; id < 4096; id++) { ids.push_back(id); }
+            } else {
+                for (int a = 0; a < 4096; a++) { for (int r = 0; r < 81; r++) { ids.push_back((a << 7) | r); } }
+            }
+        } else if (model == Model::TwoAction && (item == "leading_eight" || (item.size() == 2 && item[0] == 'L'))) {
+            const std::vector<two_action::Norm> l8 = {two_action::Norm::L1(), two_action::Norm::L2(), two_action::Norm::L3(),
+                                                      two_action::Norm::L4(), two_action::Norm::L5(), two_action::Norm::L6(),
+                                                      two_action::Norm::L7(), two_action::Norm::L8()};
+            if (item == "leading_eight") {
+                for (const auto& norm : l8) { ids.push_back(norm.ID()); }
+            } else {
+                int k = item[1] - '1';
+                if (k < 0 || k > 7) { throw std::invalid_argument(item); }
+                ids.push_back(l8[k].ID());
+            }
+        } else {
+            size_t used = 0;
+            int id = std::stoi(item, &used, item.compare(0, 2, "0x") == 0 ? 16 : 10);
+            if (used != item.size()) { throw std::invalid_argument(item); }
+            bool valid = (model == Model::TwoAction) ? (id >= 0 && id < 4096)
+                                                     : (id >= 0 && id < (1 << 19) && (id & 0x7F) < 81);
+            if (!valid) { throw std::invalid_argument(item); }
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
+
+// Norm of an ID or an equalizer code at the given assessment error, benefit and cost.
+inline two_action::Norm MakeNorm(int norm, double assessment_error, double benefit, double cost) {
+    if (norm >= 0) { return two_action::Norm::ConstructFromID(norm); }
+    const double x = 1.0 - cost / ((1 - 2 * assessment_error) * benefit);
+    const double y = cost / ((1 - 2 * assessment_error) * benefit);
+    // BBD, BBC, BGD, BGC, GBD, GBC, GGD, GGC
+    const two_action::AssessmentRule generous({x, 1.0, x, 1.0, x, 1.0, x, 1.0});
+    const two_action::AssessmentRule cautious({0.0, y, x, 1.0, 0.0, y, x, 1.0});
+    return two_action::Norm(norm == GenerousScoringEqualizer ? generous : cautious, two_action::ActionRule::DISC());
+}
+
+}  // namespace detail
+
+// Parses a manifest; errors name the offending line.
+inline std::vector<Job> ParseManifest(std::istream& in) {
+    std::vector<Job> jobs;
+    std::vector<std::map<std::string, std::pair<std::string, int>>> entries;
+    std::string line;
+    int line_number = 0;
+    auto fail = [&](int at, const std::string& what) {
+        throw std::runtime_error("manifest line " + std::to_string(at) + ": " + what);
+    };
+    while (std::getline(in, line)) {
+        line_number++;
+        line = detail::Trim(line.substr(0, line.find('#')));
+        if (line.empty()) { continue; }
+        if (line.front() == '[') {
+            if (line.back() != ']' || line.compare(0, 5, "[job ") != 0) { fail(line_number, "expected [job <name>]"); }
+            jobs.emplace_back();
+            jobs.back().name = detail::Trim(line.substr(5, line.size() - 6));
+            entries.emplace_back();
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (jobs.empty() || eq == std::string::npos) { fail(line_number, "expected key = value inside a job"); }
+        std::string key = detail::Trim(line.substr(0, eq));
+        if (entries.back().count(key)) { fail(line_number, "duplicate key " + key); }
+        entries.back()[key] = {detail::Trim(line.substr(eq + 1)), line_number};
+    }
+
+    for (size_t j = 0; j < jobs.size(); j++) {
+        Job& job = jobs[j];
+        auto& e = entries[j];
+        auto take = [&](const std::string& key, bool required) -> std::pair<std::string, int> {
+            auto it = e.find(key);
+            if (it == e.end()) {
+                if (required) { throw std::runtime_error("manifest job " + job.name + ": missing " + key); }
+                return {"", 0};
+            }
+            auto value = it->second;
+            e.erase(it);
+            return value;
+        };
+        auto model = take("model", false);
+        if (model.first == "with_punishment") {
+            job.model = Model::WithPunishment;
+        } else if (!model.first.empty() && model.first != "two_action") {
+            fail(model.second, "unknown model " + model.first);
+        }
+        auto norms = take("norms", true);
+        try { job.norms = detail::ParseNorms(norms.first, job.model, true); }
+        catch (const std::exception&) { fail(norms.second, "invalid norms " + norms.first); }
+        for (const auto& name : ModelAxes(job.model)) {
+            auto values = take(name, true);
+            try { job.axes.push_back({name, detail::ParseValues(values.first)}); }
+            catch (const std::exception&) { fail(values.second, "invalid values " + values.first); }
+        }
+        auto columns = take("columns", true);
+        job.columns = detail::Split(columns.first, ',');
+        for (const auto& c : job.columns) {
+            const auto& known = ModelColumns(job.model);
+            if (std::find(known.begin(), known.end(), c) == known.end()) { fail(columns.second, "unknown column " + c); }
+        }
+        auto sink = take("sink", false);
+        if (!sink.first.empty()) { job.sink = sink.first; }
+        if (job.sink != "rows" && job.sink != "summary" && job.sink != "invaders") {
+            fail(sink.second, "sink must be rows, summary or invaders");
+        }
+        if (job.sink == "summary" && std::find(job.columns.begin(), job.columns.end(), "is_ess") == job.columns.end()) {
+            fail(sink.second, "the summary sink needs the is_ess column");
+        }
+        if (job.sink == "invaders" && job.model != Model::TwoAction) {
+            fail(sink.second, "the invaders sink is two_action only");
+        }
+        auto flag = [&](const std::string& key) {
+            auto value = take(key, false);
+            if (!value.first.empty() && value.first != "true" && value.first != "false") {
+                fail(value.second, key + " must be true or false");
+            }
+            return value;
+        };
+        auto only_ess = flag("only_ess");
+        job.only_ess = only_ess.first == "true";
+        auto skip_resident = flag("skip_resident");
+        job.skip_resident = skip_resident.first == "true";
+        if (job.skip_resident && job.sink != "invaders") {
+            fail(skip_resident.second, "skip_resident needs the invaders sink");
+        }
+        auto rescale_payoffs = flag("rescale_payoffs");
+        job.rescale_payoffs = rescale_payoffs.first == "true";
+        if (job.rescale_payoffs && job.model != Model::TwoAction) {
+            fail(rescale_payoffs.second, "rescale_payoffs is two_action only");
+        }
+        auto layout = take("layout", false);
+        if (!layout.first.empty()) {
+            if (job.sink == "summary") { fail(layout.second, "the summary sink has no layout"); }
+            std::vector<std::string> fields = {"order", "norm_id"};
+            for (const auto& axis : job.axes) { fields.push_back(axis.name); }
+            fields.insert(fields.end(), job.columns.begin(), job.columns.end());
+            if (job.sink == "invaders") {
+                for (const char* f : {"invader", "invader_BB", "invader_BG", "invader_GB", "invader_GG", "invader_payoff"}) {
+                    fields.push_back(f);
+                }
+            }
+            for (const auto& item : detail::Split(layout.first, ',')) {
+                size_t as = item.find(" as ");
+                std::string field = detail::Trim(item.substr(0, as));
+                std::string header = (as == std::string::npos) ? field : detail::Trim(item.substr(as + 4));
+                if (std::find(fields.begin(), fields.end(), field) == fields.end() || header.empty()) {
+                    fail(layout.second, "unknown field " + item);
+                }
+                job.layout.emplace_back(header, field);
+            }
+        }
+        job.output = take("output", true).first;
+        if (!e.empty()) { fail(e.begin()->second.second, "unknown key " + e.begin()->first); }
+    }
+    return jobs;
+}
+
+// Column values of every point of every job, computed with one game per distinct
+// (model, norm, error rates) across all jobs.
+class BatchRunner {
+    public:
+        std::vector<Job> jobs;
+        std::vector<std::vector<double>> results;   // per job: point * Job::Stride() + column
+        size_t num_games = 0;                       // distinct games built
+        size_t num_points = 0;
+        size_t cache_hits = 0;                      // two-action points read from `cache`
+
+        // Optional cache of two-action results: points whose columns it holds are looked up
+        // first, and the misses are added after the pass when the cache is writable.
+        two_action::ResultCache* cache = nullptr;
+
+        explicit BatchRunner(std::vector<Job> jobs) : jobs(std::move(jobs)) {}
+
+        void Run(unsigned num_threads = 0) {
+            // requests of all jobs, grouped by game; the equalizer norms also depend on the
+            // benefit and cost
+            struct Key {
+                int model, norm;
+                double e[5];
+                bool operator==(const Key& o) const {
+                    return model == o.model && norm == o.norm && std::memcmp(e, o.e, sizeof(e)) == 0;
+                }
+            };
+            struct KeyHash {
+                size_t operator()(const Key& k) const {
+                    uint64_t h = static_cast<uint64_t>(k.model) * 0x9e3779b97f4a7c15ULL ^ static_cast<uint64_t>(k.norm);
+                    for (double x : k.e) {
+                        uint64_t bits;
+                        std::memcpy(&bits, &x, sizeof(bits));
+                        h = (h ^ bits) * 0xbf58476d1ce4e5b9ULL;
+                        h ^= h >> 31;
+                    }
+                    return static_cast<size_t>(h);
+                }
+            };
+            std::unordered_map<Key, size_t, KeyHash> index;
+            std::vector<Key> keys;
+            std::vector<std::pair<uint32_t, uint64_t>> requests;   // (job, point)
+            std::vector<size_t> request_key;
+
+            results.assign(jobs.size(), {});
+            column_codes.assign(jobs.size(), {});
+            num_points = 0;
+            for (size_t j = 0; j < jobs.size(); j++) {
+                const Job& job = jobs[j];
+                const size_t n = job.NumPoints();
+                results[j].assign(n * job.Stride(), 0.0);
+                const auto& known = ModelColumns(job.model);
+                for (const auto& c : job.columns) {
+                    column_codes[j].push_back(static_cast<int>(std::find(known.begin(), known.end(), c) - known.begin()));
+                }
+                num_points += n;
+                for (size_t k = 0; k < n; k++) {
+                    auto [norm, values] = Point(job, k);
+                    Key key{static_cast<int>(job.model), norm, {0.0, 0.0, 0.0, 0.0, 0.0}};
+                    for (int a = 0; a < NumGameAxes(job.model); a++) { key.e[a] = values[a]; }
+                    if (norm < 0) { key.e[3] = values[3]; key.e[4] = values[4]; }
+                    auto it = index.emplace(key, keys.size()).first;
+                    if (it->second == keys.size()) { keys.push_back(key); }
+                    requests.emplace_back(static_cast<uint32_t>(j), k);
+                    request_key.push_back(it->second);
+                }
+            }
+            num_games = keys.size();
+
+            // requests in CSR order by key
+            std::vector<size_t> start(keys.size() + 1, 0), order(requests.size());
+            for (size_t r = 0; r < requests.size(); r++) { start[request_key[r] + 1]++; }
+            for (size_t g = 0; g < keys.size(); g++) { start[g + 1] += start[g]; }
+            std::vector<size_t> fill(start.begin(), start.end() - 1);
+            for (size_t r = 0; r < requests.size(); r++) { order[fill[request_key[r]]++] = r; }
+
+            struct Pending {
+                int norm;
+                two_action::ResultCache::Params params;
+                two_action::ResultCache::Entry entry;
+            };
+            const unsigned max_threads = NumWorkerThreads(num_threads);
+            std::vector<std::vector<Pending>> pending(max_threads);
+            std::vector<size_t> hits(max_threads, 0);
+            ParallelFor(keys.size(), [&](size_t begin, size_t end, unsigned t) {
+                for (size_t g = begin; g < end; g++) {
+                    const Key& key = keys[g];
+                    if (key.model == static_cast<int>(Model::TwoAction)) {
+                        // the game is only built if some point misses the cache
+                        std::unique_ptr<two_action::Game> game;
+                        for (size_t r = start[g]; r < start[g + 1]; r++) {
+                            const auto& request = requests[order[r]];
+                            const bool cached = cache && key.norm >= 0 && Cacheable(request.first);
+                            two_action::ResultCache::Params params;
+                            two_action::ResultCache::Entry entry;
+                            if (cached) {
+                                auto values = Point(jobs[request.first], request.second).second;
+                                params = {values[0], values[1], values[2], values[3], values[4]};
+                                if (cache->Lookup(key.norm, params, entry)) {
+                                    Fill(entry, request);
+                                    hits[t]++;
+                                    continue;
+                                }
+                            }
+                            if (!game) {
+                                game.reset(new two_action::Game(key.e[0], key.e[1], key.e[2],
+                                                                detail::MakeNorm(key.norm, key.e[0], key.e[3], key.e[4])));
+                            }
+                            if (cached) {
+                                entry = two_action::ResultCache::Compute(*game, params[3], params[4]);
+                                Fill(entry, request);
+                                if (cache->Writable()) { pending[t].push_back({key.norm, params, entry}); }
+                            } else {
+                                Evaluate(*game, request);
+                            }
+                        }
+                    } else {
+                        with_punishment::Game game(key.e[0], key.e[1], with_punishment::Norm::ConstructFromID(key.norm));
+                        for (size_t r = start[g]; r < start[g + 1]; r++) { Evaluate(game, requests[order[r]]); }
+                    }
+                }
+            }, num_threads);
+
+            cache_hits = 0;
+            for (unsigned t = 0; t < max_threads; t++) {
+                cache_hits += hits[t];
+                for (const auto& p : pending[t]) { cache->Insert(p.norm, p.params, p.entry); }
+            }
+        }
+
+        // Norm ID and axis values of point k: norms vary slowest, the last axis fastest.
+        static std::pair<int, std::vector<double>> Point(const Job& job, size_t k) {
+            std::vector<double> values(job.axes.size());
+            for (size_t a = job.axes.size(); a-- > 0;) {
+                const auto& v = job.axes[a].values;
+                values[a] = v[k % v.size()];
+                k /= v.size();
+            }
+            return {job.norms[k], values};
+        }
+
+        void Write(size_t j, std::ostream& os) const {
+            const Job& job = jobs[j];
+            const auto& res = results[j];
+            const size_t nc = job.columns.size();
+            const size_t ess_column = std::find(job.columns.begin(), job.columns.end(), "is_ess") - job.columns.begin();
+            if (job.sink != "summary") {
+                auto layout = job.layout;
+                if (layout.empty()) {
+                    layout.emplace_back("norm_id", "norm_id");
+                    for (const auto& axis : job.axes) { layout.emplace_back(axis.name, axis.name); }
+                    for (const auto& c : job.columns) { layout.emplace_back(c, c); }
+                    if (job.sink == "invaders") {
+                        layout.emplace_back("invader", "invader");
+                        layout.emplace_back("invader_payoff", "invader_payoff");
+                    }
+                }
+                std::vector<std::pair<Field, size_t>> fields;
+                for (size_t f = 0; f < layout.size(); f++) {
+                    os << (f ? "," : "") << layout[f].first;
+                    fields.push_back(Resolve(job, layout[f].second));
+                }
+                os << "\n";
+
+                const size_t stride = job.Stride(), per_norm = job.NumPoints() / job.norms.size();
+                auto write_row = [&](size_t k, int norm, const std::vector<double>& values, int invader) {
+                    const double* row = &res[k * stride];
+                    for (size_t f = 0; f < fields.size(); f++) {
+                        if (f > 0) { os << ","; }
+                        const size_t i = fields[f].second;
+                        switch (fields[f].first) {
+                            case Order: os << k / per_norm + 1; break;
+                            case NormId: os << norm; break;
+                            case AxisValue: os << values[i]; break;
+                            case ColumnValue: os << row[i]; break;
+                            case InvaderId: os << invader; break;
+                            case InvaderRule: os << ((invader >> i) & 1); break;
+                            case InvaderPayoff: os << row[nc + invader]; break;
+                        }
+                    }
+                    os << "\n";
+                };
+                for (size_t k = 0; k < job.NumPoints(); k++) {
+                    if (job.only_ess && ess_column < nc && res[k * stride + ess_column] == 0.0) { continue; }
+                    auto [norm, values] = Point(job, k);
+                    if (job.sink == "rows") {
+                        write_row(k, norm, values, -1);
+                        continue;
+                    }
+                    const int resident = job.skip_resident
+                                             ? detail::MakeNorm(norm, values[0], values[3], values[4]).action_rule.ID()
+                                             : -1;
+                    for (int invader = 0; invader < 16; invader++) {
+                        if (invader != resident) { write_row(k, norm, values, invader); }
+                    }
+                }
+                return;
+            }
+            // summary: per norm, the number of points and of ESS points, and the mean of
+            // every other column over the ESS points
+            const size_t per_norm = job.NumPoints() / job.norms.size();
+            os << "norm_id,points,ess_points,ess_fraction";
+            for (size_t c = 0; c < nc; c++) { if (c != ess_column) { os << ",mean_" << job.columns[c] << "_ess"; } }
+            os << "\n";
+            for (size_t n = 0; n < job.norms.size(); n++) {
+                long ess = 0;
+                std::vector<double> sums(nc, 0.0);
+                for (size_t k = n * per_norm; k < (n + 1) * per_norm; k++) {
+                    if (res[k * nc + ess_column] == 0.0) { continue; }
+                    ess++;
+                    for (size_t c = 0; c < nc; c++) { sums[c] += res[k * nc + c]; }
+                }
+                os << job.norms[n] << "," << per_norm << "," << ess << "," << static_cast<double>(ess) / per_norm;
+                for (size_t c = 0; c < nc; c++) {
+                    if (c != ess_column) { os << "," << (ess > 0 ? sums[c] / ess : 0.0); }
+                }
+                os << "\n";
+            }
+        }
+
+    private:
+        std::vector<std::vector<int>> column_codes;   // per job: index of each column in ModelColumns
+
+        // fields of a layout; the index is that of the axis, column or invader action
+        enum Field { Order, NormId, AxisValue, ColumnValue, InvaderId, InvaderRule, InvaderPayoff };
+
+        static std::pair<Field, size_t> Resolve(const Job& job, const std::string& name) {
+            if (name == "order") { return {Order, 0}; }
+            if (name == "norm_id") { return {NormId, 0}; }
+            if (name == "invader") { return {InvaderId, 0}; }
+            if (name == "invader_payoff") { return {InvaderPayoff, 0}; }
+            const std::string rules[] = {"invader_BB", "invader_BG", "invader_GB", "invader_GG"};
+            for (size_t r = 0; r < 4; r++) { if (name == rules[r]) { return {InvaderRule, r}; } }
+            for (size_t a = 0; a < job.axes.size(); a++) { if (name == job.axes[a].name) { return {AxisValue, a}; } }
+            const auto column = std::find(job.columns.begin(), job.columns.end(), name);
+            return {ColumnValue, static_cast<size_t>(column - job.columns.begin())};
+        }
+
+        // whether `cache` holds every column of job j
+        bool Cacheable(size_t j) const {
+            if (jobs[j].sink == "invaders" || jobs[j].rescale_payoffs) { return false; }
+            for (int code : column_codes[j]) { if (code > 4) { return false; } }
+            return true;
+        }
+
+        void Fill(const two_action::ResultCache::Entry& entry, const std::pair<uint32_t, uint64_t>& request) {
+            const auto& codes = column_codes[request.first];
+            double* out = &results[request.first][request.second * jobs[request.first].Stride()];
+            const double values[] = {entry.h, entry.cooperation, entry.is_ess ? 1.0 : 0.0, entry.delta_v, entry.ess_margin};
+            for (size_t c = 0; c < codes.size(); c++) { out[c] = values[codes[c]]; }
+        }
+
+        void Evaluate(const two_action::Game& game, const std::pair<uint32_t, uint64_t>& request) {
+            const Job& job = jobs[request.first];
+            const std::vector<double> values = Point(job, request.second).second;
+            const double benefit = values[3], cost = values[4];
+            // benefit and cost of the payoffs, as in L6_L3_payoff_difference when rescaled
+            const double payoff_benefit = job.rescale_payoffs ? (1.0 - values[2]) * benefit : benefit;
+            const double payoff_cost = job.rescale_payoffs ? (1.0 - values[2]) * cost : cost;
+            const auto& codes = column_codes[request.first];
+            double* out = &results[request.first][request.second * job.Stride()];
+            for (size_t c = 0; c < codes.size(); c++) {
+                switch (codes[c]) {
+                    case 0: out[c] = game.equilibrium_state; break;
+                    case 1: out[c] = game.resident_coop; break;
+                    case 2: out[c] = game.isESS(benefit, cost); break;
+                    case 3: out[c] = game.calc_delta_v(benefit, cost); break;
+                    case 4: out[c] = game.calc_ess_margin(benefit, cost); break;
+                    case 5: out[c] = game.calc_resident_payoff(payoff_benefit, payoff_cost); break;
+                }
+            }
+            if (job.sink == "invaders") {
+                for (int i = 0; i < 16; i++) {
+                    out[codes.size() + i] = game.calc_invader_payoff(two_action::ActionRule::MakeDeterministicRule(i),
+                                                                     payoff_benefit, payoff_cost);
+                }
+            }
+        }
+
+        void Evaluate(const with_punishment::Game& game, const std::pair<uint32_t, uint64_t>& request) {
+            const Job& job = jobs[request.first];
+            const std::vector<double> values = Point(job, request.second).second;
+            const double benefit = values[2], cost = values[3], punishment = values[4], punishment_cost = values[5];
+            const auto& codes = column_codes[request.first];
+            double* out = &results[request.first][request.second * job.Stride()];
+            for (size_t c = 0; c < codes.size(); c++) {
+                switch (codes[c]) {
+                    case 0: out[c] = game.equilibrium_state; break;
+                    case 1: out[c] = game.resident_coop; break;
+                    case 2: out[c] = game.resident_punishment; break;
+                    case 3: out[c] = game.isESS(benefit, cost, punishment, punishment_cost); break;
+                    case 4: out[c] = game.calc_delta_v(benefit, cost, punishment, punishment_cost); break;
+                }
+            }
+        }
+};
+
+}  // namespace batch
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef CounterRNG_H
+#define CounterRNG_H
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+
+
+// Counter-based generator: the k-th output of stream s is a SplitMix64 hash of
+// (seed, s, k), so every replicate draws the same numbers whichever thread runs it.
+class CounterRNG {
+    public:
+        static constexpr uint64_t One = uint64_t(1) << 53;   // threshold of probability one
+
+        CounterRNG(uint64_t seed, uint64_t stream) : key(Mix(Mix(seed) ^ (stream * Gamma))), counter(0) {}
+
+        uint64_t Next() { return Mix(key + (++counter) * Gamma); }
+        uint64_t Counter() const { return counter; }
+
+        double Uniform() { return (Next() >> 11) * 0x1.0p-53; }
+
+        // Uniform index in [0, n) by multiply-shift (bias below n / 2^64).
+        size_t Index(size_t n) { return static_cast<size_t>((static_cast<unsigned __int128>(Next()) * n) >> 64); }
+
+        // True with the probability whose Threshold() is `threshold`. Probabilities zero and
+        // one consume no random number, so deterministic rules cost nothing.
+        bool Bernoulli(uint64_t threshold) {
+            if (threshold == 0) { return false; }
+            if (threshold >= One) { return true; }
+            return (Next() >> 11) < threshold;
+        }
+
+        static uint64_t Threshold(double p) {
+            if (!(p > 0.0)) { return 0; }
+            if (p >= 1.0) { return One; }
+            return static_cast<uint64_t>(std::ldexp(p, 53));
+        }
+
+        static uint64_t Mix(uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+    private:
+        static constexpr uint64_t Gamma = 0x9e3779b97f4a7c15ULL;
+        uint64_t key;
+        uint64_t counter;
+};
+
+// Mean of the batch means of a replicated simulation with a 95% confidence half width.
+struct Estimate {
+    double mean = 0.0;
+    double half_width = 0.0;
+
+    static Estimate FromBatches(const std::vector<double>& batches) {
+        Estimate e;
+        const size_t k = batches.size();
+        if (k == 0) { return e; }
+        for (double x : batches) { e.mean += x; }
+        e.mean /= k;
+        if (k > 1) {
+            double var = 0.0;
+            for (double x : batches) { var += (x - e.mean) * (x - e.mean); }
+            e.half_width = 1.96 * std::sqrt(var / (k - 1) / k);
+        }
+        return e;
+    }
+
+    bool Contains(double x, double widen = 1.0) const { return std::abs(x - mean) <= widen * half_width; }
+};
+
+#endif
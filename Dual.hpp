@@ -0,0 +1,68 @@
+#ifndef Dual_H
+#define Dual_H
+
+#include <array>
+#include <cmath>
+
+
+// Forward-mode dual number with N derivative components: every operation applies
+// the chain rule to the gradient `d` along with the value `v`. Comparisons only look
+// at values, so branching code (e.g. the c2 == 0 case of the equilibrium state)
+// takes the same branch as with doubles, and values are bitwise those of doubles.
+template <int N>
+struct Dual {
+    double v;
+    std::array<double, N> d;
+
+    Dual(double v = 0.0) : v(v), d{} {}
+
+    // Independent variable number i.
+    static Dual Variable(double v, int i) {
+        Dual x(v);
+        x.d[i] = 1.0;
+        return x;
+    }
+
+    Dual& operator+=(const Dual& y) { v += y.v; for (int i = 0; i < N; i++) { d[i] += y.d[i]; } return *this; }
+    Dual& operator-=(const Dual& y) { v -= y.v; for (int i = 0; i < N; i++) { d[i] -= y.d[i]; } return *this; }
+    Dual& operator*=(const Dual& y) {
+        for (int i = 0; i < N; i++) { d[i] = d[i] * y.v + v * y.d[i]; }
+        v *= y.v;
+        return *this;
+    }
+    Dual& operator/=(const Dual& y) {
+        v /= y.v;
+        for (int i = 0; i < N; i++) { d[i] = (d[i] - v * y.d[i]) / y.v; }
+        return *this;
+    }
+
+    friend Dual operator+(Dual x, const Dual& y) { return x += y; }
+    friend Dual operator-(Dual x, const Dual& y) { return x -= y; }
+    friend Dual operator*(Dual x, const Dual& y) { return x *= y; }
+    friend Dual operator/(Dual x, const Dual& y) { return x /= y; }
+    friend Dual operator-(Dual x) {
+        x.v = -x.v;
+        for (int i = 0; i < N; i++) { x.d[i] = -x.d[i]; }
+        return x;
+    }
+
+    friend bool operator<(const Dual& x, const Dual& y) { return x.v < y.v; }
+    friend bool operator>(const Dual& x, const Dual& y) { return x.v > y.v; }
+    friend bool operator<=(const Dual& x, const Dual& y) { return x.v <= y.v; }
+    friend bool operator>=(const Dual& x, const Dual& y) { return x.v >= y.v; }
+    friend bool operator==(const Dual& x, const Dual& y) { return x.v == y.v; }
+    friend bool operator!=(const Dual& x, const Dual& y) { return x.v != y.v; }
+
+    friend Dual sqrt(Dual x) {
+        x.v = std::sqrt(x.v);
+        const double scale = 0.5 / x.v;
+        for (int i = 0; i < N; i++) { x.d[i] *= scale; }
+        return x;
+    }
+    friend Dual abs(const Dual& x) { return x.v < 0.0 ? -x : x; }
+};
+
+template <int N>
+double ValueOf(const Dual<N>& x) { return x.v; }
+
+#endif
@@ -0,0 +1,388 @@
+#ifndef ESSBitmap_H
+#define ESSBitmap_H
+
+#include <vector>
+#include <array>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+
+
+// Compressed set of 32-bit integers in the style of roaring bitmaps. Values are
+// grouped by their upper 16 bits; each group is stored as a sorted array when it
+// holds at most 4096 values and as a 65536-bit bitset otherwise.
+class RoaringBitmap {
+    public:
+        static constexpr uint32_t ArrayLimit = 4096;
+        static constexpr size_t BitsetWords = 1024;
+
+        struct Container {
+            uint16_t key = 0;
+            bool is_bitset = false;
+            uint32_t cardinality = 0;
+            std::vector<uint16_t> array;
+            std::vector<uint64_t> bits;
+
+            bool Contains(uint16_t low) const {
+                if (is_bitset) { return (bits[low >> 6] >> (low & 63)) & 1; }
+                return std::binary_search(array.begin(), array.end(), low);
+            }
+
+            void Add(uint16_t low) {
+                if (is_bitset) {
+                    uint64_t mask = uint64_t(1) << (low & 63);
+                    if (!(bits[low >> 6] & mask)) { bits[low >> 6] |= mask; cardinality++; }
+                    return;
+                }
+                auto it = std::lower_bound(array.begin(), array.end(), low);
+                if (it != array.end() && *it == low) { return; }
+                array.insert(it, low);
+                cardinality++;
+                if (cardinality > ArrayLimit) { ToBitset(); }
+            }
+
+            void ToBitset() {
+                bits.assign(BitsetWords, 0);
+                for (uint16_t v : array) { bits[v >> 6] |= uint64_t(1) << (v & 63); }
+                array.clear();
+                array.shrink_to_fit();
+                is_bitset = true;
+            }
+
+            // Switches to the cheaper representation for the current cardinality.
+            void Normalize() {
+                if (is_bitset && cardinality <= ArrayLimit) {
+                    array.clear();
+                    array.reserve(cardinality);
+                    for (size_t w = 0; w < BitsetWords; w++) {
+                        uint64_t word = bits[w];
+                        while (word) {
+                            int b = __builtin_ctzll(word);
+                            array.push_back(static_cast<uint16_t>(w * 64 + b));
+                            word &= word - 1;
+                        }
+                    }
+                    bits.clear();
+                    bits.shrink_to_fit();
+                    is_bitset = false;
+                } else if (!is_bitset && cardinality > ArrayLimit) {
+                    ToBitset();
+                }
+            }
+        };
+
+        RoaringBitmap() = default;
+
+        void Add(uint32_t x) {
+            FindOrInsert(static_cast<uint16_t>(x >> 16)).Add(static_cast<uint16_t>(x & 0xFFFF));
+        }
+
+        bool Contains(uint32_t x) const {
+            const Container* c = Find(static_cast<uint16_t>(x >> 16));
+            return c != nullptr && c->Contains(static_cast<uint16_t>(x & 0xFFFF));
+        }
+
+        uint64_t Cardinality() const {
+            uint64_t n = 0;
+            for (const auto& c : containers) { n += c.cardinality; }
+            return n;
+        }
+
+        bool Empty() const { return containers.empty(); }
+
+        std::vector<uint32_t> ToVector() const {
+            std::vector<uint32_t> values;
+            values.reserve(Cardinality());
+            for (const auto& c : containers) {
+                uint32_t high = static_cast<uint32_t>(c.key) << 16;
+                if (c.is_bitset) {
+                    for (size_t w = 0; w < BitsetWords; w++) {
+                        uint64_t word = c.bits[w];
+                        while (word) {
+                            values.push_back(high | static_cast<uint32_t>(w * 64 + __builtin_ctzll(word)));
+                            word &= word - 1;
+                        }
+                    }
+                } else {
+                    for (uint16_t v : c.array) { values.push_back(high | v); }
+                }
+            }
+            return values;
+        }
+
+        static RoaringBitmap And(const RoaringBitmap& a, const RoaringBitmap& b) {
+            RoaringBitmap result;
+            size_t i = 0, j = 0;
+            while (i < a.containers.size() && j < b.containers.size()) {
+                const Container& x = a.containers[i];
+                const Container& y = b.containers[j];
+                if (x.key < y.key) { i++; continue; }
+                if (y.key < x.key) { j++; continue; }
+                Container c = AndContainers(x, y);
+                if (c.cardinality > 0) { result.containers.push_back(std::move(c)); }
+                i++; j++;
+            }
+            return result;
+        }
+
+        static RoaringBitmap Or(const RoaringBitmap& a, const RoaringBitmap& b) {
+            RoaringBitmap result;
+            size_t i = 0, j = 0;
+            while (i < a.containers.size() || j < b.containers.size()) {
+                if (j == b.containers.size() || (i < a.containers.size() && a.containers[i].key < b.containers[j].key)) {
+                    result.containers.push_back(a.containers[i++]);
+                } else if (i == a.containers.size() || b.containers[j].key < a.containers[i].key) {
+                    result.containers.push_back(b.containers[j++]);
+                } else {
+                    result.containers.push_back(OrContainers(a.containers[i++], b.containers[j++]));
+                }
+            }
+            return result;
+        }
+
+        // Values of a that are not in b.
+        static RoaringBitmap AndNot(const RoaringBitmap& a, const RoaringBitmap& b) {
+            RoaringBitmap result;
+            for (const auto& x : a.containers) {
+                const Container* y = b.Find(x.key);
+                if (y == nullptr) { result.containers.push_back(x); continue; }
+                Container c;
+                c.key = x.key;
+                for (uint32_t v : ContainerValues(x)) {
+                    if (!y->Contains(static_cast<uint16_t>(v))) { c.array.push_back(static_cast<uint16_t>(v)); }
+                }
+                c.cardinality = static_cast<uint32_t>(c.array.size());
+                c.Normalize();
+                if (c.cardinality > 0) { result.containers.push_back(std::move(c)); }
+            }
+            return result;
+        }
+
+        bool operator==(const RoaringBitmap& other) const { return ToVector() == other.ToVector(); }
+        bool operator!=(const RoaringBitmap& other) const { return !(*this == other); }
+
+        // Number of bytes Write produces.
+        size_t SerializedSize() const {
+            size_t n = sizeof(uint32_t);
+            for (const auto& c : containers) {
+                n += sizeof(uint16_t) + sizeof(uint8_t) + sizeof(uint32_t);
+                n += c.is_bitset ? BitsetWords * sizeof(uint64_t) : c.cardinality * sizeof(uint16_t);
+            }
+            return n;
+        }
+
+        void Write(std::ostream& os) const {
+            uint32_t n = static_cast<uint32_t>(containers.size());
+            os.write(reinterpret_cast<const char*>(&n), sizeof(n));
+            for (const auto& c : containers) {
+                uint8_t type = c.is_bitset ? 1 : 0;
+                os.write(reinterpret_cast<const char*>(&c.key), sizeof(c.key));
+                os.write(reinterpret_cast<const char*>(&type), sizeof(type));
+                os.write(reinterpret_cast<const char*>(&c.cardinality), sizeof(c.cardinality));
+                if (c.is_bitset) {
+                    os.write(reinterpret_cast<const char*>(c.bits.data()), BitsetWords * sizeof(uint64_t));
+                } else {
+                    os.write(reinterpret_cast<const char*>(c.array.data()), c.array.size() * sizeof(uint16_t));
+                }
+            }
+        }
+
+        static RoaringBitmap Read(std::istream& is) {
+            RoaringBitmap bitmap;
+            uint32_t n = 0;
+            is.read(reinterpret_cast<char*>(&n), sizeof(n));
+            for (uint32_t k = 0; k < n && is; k++) {
+                Container c;
+                uint8_t type = 0;
+                is.read(reinterpret_cast<char*>(&c.key), sizeof(c.key));
+                is.read(reinterpret_cast<char*>(&type), sizeof(type));
+                is.read(reinterpret_cast<char*>(&c.cardinality), sizeof(c.cardinality));
+                c.is_bitset = (type == 1);
+                if (c.is_bitset) {
+                    c.bits.resize(BitsetWords);
+                    is.read(reinterpret_cast<char*>(c.bits.data()), BitsetWords * sizeof(uint64_t));
+                } else {
+                    c.array.resize(c.cardinality);
+                    is.read(reinterpret_cast<char*>(c.array.data()), c.array.size() * sizeof(uint16_t));
+                }
+                bitmap.containers.push_back(std::move(c));
+            }
+            if (!is) { throw std::runtime_error("RoaringBitmap: truncated input"); }
+            return bitmap;
+        }
+
+    private:
+        std::vector<Container> containers;   // sorted by key
+
+        const Container* Find(uint16_t key) const {
+            auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                                       [](const Container& c, uint16_t k) { return c.key < k; });
+            return (it != containers.end() && it->key == key) ? &*it : nullptr;
+        }
+
+        Container& FindOrInsert(uint16_t key) {
+            auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                                       [](const Container& c, uint16_t k) { return c.key < k; });
+            if (it == containers.end() || it->key != key) {
+                Container c;
+                c.key = key;
+                it = containers.insert(it, std::move(c));
+            }
+            return *it;
+        }
+
+        static std::vector<uint32_t> ContainerValues(const Container& c) {
+            RoaringBitmap single;
+            single.containers.push_back(c);
+            single.containers[0].key = 0;
+            return single.ToVector();
+        }
+
+        static Container AndContainers(const Container& x, const Container& y) {
+            Container c;
+            c.key = x.key;
+            if (x.is_bitset && y.is_bitset) {
+                c.is_bitset = true;
+                c.bits.resize(BitsetWords);
+                for (size_t w = 0; w < BitsetWords; w++) {
+                    c.bits[w] = x.bits[w] & y.bits[w];
+                    c.cardinality += __builtin_popcountll(c.bits[w]);
+                }
+                c.Normalize();
+            } else if (!x.is_bitset && !y.is_bitset) {
+                std::set_intersection(x.array.begin(), x.array.end(), y.array.begin(), y.array.end(),
+                                      std::back_inserter(c.array));
+                c.cardinality = static_cast<uint32_t>(c.array.size());
+            } else {
+                const Container& arr = x.is_bitset ? y : x;
+                const Container& bs = x.is_bitset ? x : y;
+                for (uint16_t v : arr.array) {
+                    if (bs.Contains(v)) { c.array.push_back(v); }
+                }
+                c.cardinality = static_cast<uint32_t>(c.array.size());
+            }
+            return c;
+        }
+
+        static Container OrContainers(const Container& x, const Container& y) {
+            Container c;
+            c.key = x.key;
+            if (!x.is_bitset && !y.is_bitset) {
+                std::set_union(x.array.begin(), x.array.end(), y.array.begin(), y.array.end(),
+                               std::back_inserter(c.array));
+                c.cardinality = static_cast<uint32_t>(c.array.size());
+                c.Normalize();
+                return c;
+            }
+            c.is_bitset = true;
+            c.bits.assign(BitsetWords, 0);
+            for (const Container* src : {&x, &y}) {
+                if (src->is_bitset) {
+                    for (size_t w = 0; w < BitsetWords; w++) { c.bits[w] |= src->bits[w]; }
+                } else {
+                    for (uint16_t v : src->array) { c.bits[v >> 6] |= uint64_t(1) << (v & 63); }
+                }
+            }
+            for (size_t w = 0; w < BitsetWords; w++) { c.cardinality += __builtin_popcountll(c.bits[w]); }
+            return c;
+        }
+};
+
+
+// ESS membership over the norm IDs (Norm::ID()) at a list of grid points,
+// as produced by the ess_bitmap executables.
+class ESSBitmapStore {
+    public:
+        struct GridPoint {
+            double assessment_error;
+            double perception_error;
+            double mu_e;
+            double benefit;
+            double cost;
+        };
+
+        struct Entry {
+            GridPoint point;
+            RoaringBitmap ess;
+        };
+
+        int num_actions;             // 2 for Norms.hpp, 3 for NormsWithPunishment.hpp
+        std::array<double, 2> punishment_params = {0.0, 0.0};   // (punishment, punishment_cost)
+        std::vector<Entry> entries;
+
+        explicit ESSBitmapStore(int num_actions = 2) : num_actions(num_actions) {}
+
+        void Save(const std::string& filename) const {
+            std::ofstream file(filename, std::ios::binary);
+            if (!file.is_open()) { throw std::runtime_error("ESSBitmapStore: cannot open " + filename); }
+            file.write(Magic, sizeof(Magic));
+            uint32_t version = Version, n = static_cast<uint32_t>(entries.size());
+            int32_t actions = num_actions;
+            file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+            file.write(reinterpret_cast<const char*>(&actions), sizeof(actions));
+            file.write(reinterpret_cast<const char*>(punishment_params.data()), sizeof(punishment_params));
+            file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+            for (const auto& e : entries) {
+                file.write(reinterpret_cast<const char*>(&e.point), sizeof(GridPoint));
+                e.ess.Write(file);
+            }
+        }
+
+        static ESSBitmapStore Load(const std::string& filename) {
+            std::ifstream file(filename, std::ios::binary);
+            if (!file.is_open()) { throw std::runtime_error("ESSBitmapStore: cannot open " + filename); }
+            char magic[sizeof(Magic)];
+            uint32_t version = 0, n = 0;
+            int32_t actions = 0;
+            file.read(magic, sizeof(magic));
+            file.read(reinterpret_cast<char*>(&version), sizeof(version));
+            if (!file || std::string(magic, sizeof(magic)) != std::string(Magic, sizeof(Magic)) || version != Version) {
+                throw std::runtime_error("ESSBitmapStore: " + filename + " is not an ESS bitmap file");
+            }
+            file.read(reinterpret_cast<char*>(&actions), sizeof(actions));
+            ESSBitmapStore store(actions);
+            file.read(reinterpret_cast<char*>(store.punishment_params.data()), sizeof(store.punishment_params));
+            file.read(reinterpret_cast<char*>(&n), sizeof(n));
+            for (uint32_t k = 0; k < n; k++) {
+                Entry e;
+                file.read(reinterpret_cast<char*>(&e.point), sizeof(GridPoint));
+                e.ess = RoaringBitmap::Read(file);
+                store.entries.push_back(std::move(e));
+            }
+            return store;
+        }
+
+        // Norms that are ESS at every grid point accepted by `in_region`.
+        template <typename Predicate>
+        RoaringBitmap IntersectRegion(Predicate in_region) const {
+            bool first = true;
+            RoaringBitmap result;
+            for (const auto& e : entries) {
+                if (!in_region(e.point)) { continue; }
+                result = first ? e.ess : RoaringBitmap::And(result, e.ess);
+                first = false;
+                if (result.Empty()) { break; }
+            }
+            return result;
+        }
+
+        // Norms that are ESS at some grid point accepted by `in_region`.
+        template <typename Predicate>
+        RoaringBitmap UnionRegion(Predicate in_region) const {
+            RoaringBitmap result;
+            for (const auto& e : entries) {
+                if (in_region(e.point)) { result = RoaringBitmap::Or(result, e.ess); }
+            }
+            return result;
+        }
+
+    private:
+        static constexpr char Magic[4] = {'E', 'S', 'S', 'B'};
+        static constexpr uint32_t Version = 1;
+};
+
+#endif
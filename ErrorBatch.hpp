@@ -0,0 +1,147 @@
+#ifndef ErrorBatch_H
+#define ErrorBatch_H
+
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "SweepEngine.hpp"
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <limits>
+
+
+namespace two_action {
+
+// One norm at many error triples (assessment_error, perception_error, mu_e), for fixed
+// benefit and cost. Evaluate runs the rescaling, the equilibrium state, the resident
+// cooperation and the payoffs of the 16 deterministic invaders for a whole array of
+// points; the loops over points have no branches or calls so that the compiler
+// vectorizes them (GCC at -O3 with -fno-math-errno -fno-trapping-math, which CMake sets
+// for the targets using this header). Every quantity repeats the operations of Game in
+// the same order, so the results equal those of Game bit for bit unless the compiler
+// contracts them into fused multiply-adds.
+class ErrorBatch {
+    public:
+        static constexpr size_t BlockSize = 256;
+
+        ErrorBatch(const Norm& norm, double benefit, double cost)
+            : good(norm.assessment_rule.good_probs), coop(norm.action_rule.coop_probs),
+              skip(norm.action_rule.ID()), benefit(benefit), cost(cost) {}
+
+        // Points i < n in structure-of-arrays form. Outputs: equilibrium_state and
+        // resident cooperation (Game::equilibrium_state, resident_coop), ess_margin
+        // (Game::calc_ess_margin) and, if not null, is_ess (Game::isESS) and the invader
+        // attaining the margin.
+        void Evaluate(size_t n, const double* assessment_error, const double* perception_error, const double* mu_e,
+                      double* equilibrium_state, double* resident_coop, double* ess_margin,
+                      uint8_t* is_ess = nullptr, int8_t* best_invader = nullptr) const {
+            for (size_t first = 0; first < n; first += BlockSize) {
+                const size_t count = std::min(BlockSize, n - first);
+                Block(count, assessment_error + first, perception_error + first, mu_e + first,
+                      equilibrium_state + first, resident_coop + first, ess_margin + first,
+                      is_ess ? is_ess + first : nullptr, best_invader ? best_invader + first : nullptr);
+            }
+        }
+
+        // Evaluate on all threads.
+        void EvaluateParallel(size_t n, const double* assessment_error, const double* perception_error,
+                              const double* mu_e, double* equilibrium_state, double* resident_coop,
+                              double* ess_margin, uint8_t* is_ess = nullptr, int8_t* best_invader = nullptr,
+                              unsigned num_threads = 0) const {
+            const size_t num_blocks = (n + BlockSize - 1) / BlockSize;
+            ParallelFor(num_blocks, [&](size_t begin, size_t end, unsigned) {
+                const size_t first = begin * BlockSize, last = std::min(n, end * BlockSize);
+                Evaluate(last - first, assessment_error + first, perception_error + first, mu_e + first,
+                         equilibrium_state + first, resident_coop + first, ess_margin + first,
+                         is_ess ? is_ess + first : nullptr, best_invader ? best_invader + first : nullptr);
+            }, num_threads);
+        }
+
+    private:
+        std::array<double, 8> good;
+        std::array<double, 4> coop;
+        int skip;
+        double benefit, cost;
+
+        void Block(size_t n, const double* __restrict ae, const double* __restrict pe, const double* __restrict mu,
+                   double* __restrict h_out, double* __restrict coop_out, double* __restrict margin_out,
+                   uint8_t* is_ess, int8_t* best_invader) const {
+            // resident quantities of the block, kept for the invader loops
+            alignas(64) double r[8][BlockSize];       // assessment table R, as in Game::RescaleAssessment
+            alignas(64) double s[4][BlockSize];       // cooperation of the residents S[k][C]
+            alignas(64) double hh[BlockSize], q[BlockSize], self[BlockSize];
+            alignas(64) double margin[BlockSize], best[BlockSize], ess[BlockSize];
+
+            const double b = benefit, c = cost;
+            for (size_t i = 0; i < n; i++) {
+                double R[8];
+                for (int k = 0; k < 8; k++) { R[k] = (1.0 - ae[i]) * good[k] + ae[i] * (1.0 - good[k]); }
+                for (int k = 0; k < 8; k += 2) { R[k] = (1.0 - pe[i]) * R[k] + pe[i] * R[k + 1]; }
+                const double one_mu = 1.0 - mu[i];
+                double S[4], rs[4];
+                for (int k = 0; k < 4; k++) {
+                    S[k] = coop[k] * one_mu;
+                    rs[k] = R[2 * k + 1] * S[k] + R[2 * k] * (1.0 - S[k]);
+                }
+                // GameEngine::EquilibriumState without the branch
+                const double c2 = rs[3] - rs[2] - rs[1] + rs[0];
+                const double c1 = rs[2] + rs[1] - 2.0 * rs[0] - 1.0;
+                const double c0 = rs[0];
+                const double linear = -c0 / c1 - 0.0 * c0 * c0 / (c1 * c1 * c1);
+                const double quadratic = (-c1 - std::sqrt(c1 * c1 - 4.0 * c2 * c0)) / (2.0 * c2);
+                const double h = std::abs(c2) < 1e-9 ? linear : quadratic;
+                const double f = h * h * S[3] + h * (1.0 - h) * (S[2] + S[1]) + (1.0 - h) * (1.0 - h) * S[0];
+
+                for (int k = 0; k < 8; k++) { r[k][i] = R[k]; }
+                for (int k = 0; k < 4; k++) { s[k][i] = S[k]; }
+                hh[i] = h;
+                q[i] = one_mu;
+                self[i] = (b - c) * f;
+                h_out[i] = h;
+                coop_out[i] = f;
+                margin[i] = std::numeric_limits<double>::infinity();
+                best[i] = -1.0;
+                ess[i] = 1.0;
+            }
+
+            for (int j = 0; j < 16; j++) {
+                if (j == skip) { continue; }
+                const double p_bb = (j & 1) ? 1.0 : 0.0, p_bg = (j & 2) ? 1.0 : 0.0;
+                const double p_gb = (j & 4) ? 1.0 : 0.0, p_gg = (j & 8) ? 1.0 : 0.0;
+                const double jd = j;
+                for (size_t i = 0; i < n; i++) {
+                    // GameEngine::Invader for ToTable(MakeDeterministicRule(j), mu_e)
+                    const double a_bb = p_bb * q[i], a_bg = p_bg * q[i], a_gb = p_gb * q[i], a_gg = p_gg * q[i];
+                    const double rs_bb = r[1][i] * a_bb + r[0][i] * (1.0 - a_bb);
+                    const double rs_bg = r[3][i] * a_bg + r[2][i] * (1.0 - a_bg);
+                    const double rs_gb = r[5][i] * a_gb + r[4][i] * (1.0 - a_gb);
+                    const double rs_gg = r[7][i] * a_gg + r[6][i] * (1.0 - a_gg);
+                    const double h = hh[i];
+                    const double num = h * rs_bg + (1.0 - h) * rs_bb;
+                    const double den = 1.0 - h * rs_gg + h * rs_bg - (1.0 - h) * rs_gb + (1.0 - h) * rs_bb;
+                    const double H = num / den;
+                    const double mut_to_res = h * H * a_gg + (1.0 - h) * H * a_gb + h * (1.0 - H) * a_bg
+                                            + (1.0 - h) * (1.0 - H) * a_bb;
+                    const double res_to_mut = h * H * s[3][i] + h * (1.0 - H) * s[2][i] + (1.0 - h) * H * s[1][i]
+                                            + (1.0 - h) * (1.0 - H) * s[0][i];
+                    const double payoff = b * res_to_mut - c * mut_to_res;
+                    // selects as arithmetic on 0/1 masks: best and ess hold small integers, so
+                    // the products are exact
+                    const double m = self[i] - payoff;
+                    const double lower = m < margin[i];
+                    margin[i] = std::min(margin[i], m);
+                    best[i] += lower * (jd - best[i]);
+                    ess[i] *= !(payoff > self[i]);
+                }
+            }
+
+            for (size_t i = 0; i < n; i++) { margin_out[i] = margin[i]; }
+            if (is_ess) { for (size_t i = 0; i < n; i++) { is_ess[i] = ess[i] != 0.0; } }
+            if (best_invader) { for (size_t i = 0; i < n; i++) { best_invader[i] = static_cast<int8_t>(best[i]); } }
+        }
+};
+
+}  // namespace two_action
+
+#endif
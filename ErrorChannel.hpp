@@ -0,0 +1,153 @@
+#ifndef ErrorChannel_H
+#define ErrorChannel_H
+
+#include "GameEngine.hpp"
+
+#include <stdexcept>
+
+
+// Errors between the action a donor intends and the image it earns, for the models of
+// GameEngine.hpp (actions 0 = D, 1 = C, ..., reputations 0 = B, 1 = G):
+//     implementation[a][b]: probability that a donor intending action a performs b
+//     perception[a][b]:     probability that the observer sees b when a was performed
+//     assignment[x][y]:     probability that the image x given by the norm is recorded as y
+// Every row sums to one.
+//
+// The constructor composes perception and assignment once into one affine map of the
+// assessment table, the same for every (donor, recipient) pair:
+//     R'(X, Y, a) = offset[a] + sum_b gain[a][b] R(X, Y, b)
+// so a norm costs one small matrix product at a parameter point whatever the error model.
+// Implementation errors act on the action tables (Actions).
+template <int NA, typename Scalar = double>
+class ErrorChannel {
+    public:
+        using Engine = GameEngine<NA, Scalar>;
+        using Matrix = std::array<std::array<Scalar, NA>, NA>;
+        using Assignment = std::array<std::array<Scalar, 2>, 2>;
+        static constexpr int D = 0, C = 1, B = 0, G = 1;
+
+        Matrix implementation;
+        Matrix perception;
+        Assignment assignment;
+        Matrix gain;
+        std::array<Scalar, NA> offset;
+
+        ErrorChannel(const Matrix& implementation, const Matrix& perception, const Assignment& assignment)
+            : ErrorChannel(implementation, perception, assignment, false) {
+            CheckRows(implementation, "implementation");
+            CheckRows(perception, "perception");
+            CheckRows(assignment, "assignment");
+        }
+
+        // The errors of Game.hpp and GameWithPunishment.hpp: the recorded image is flipped
+        // with probability assessment_error, a defection is seen as cooperation with
+        // probability perception_error, and intended cooperation fails with probability
+        // implementation_error. The rates are not checked, as the games never did (finite
+        // differences step outside [0, 1]).
+        static ErrorChannel Standard(Scalar assessment_error, Scalar perception_error,
+                                     Scalar implementation_error = 0.0) {
+            Matrix implementation = Identity(), perception = Identity();
+            implementation[C][C] = 1.0 - implementation_error;
+            implementation[C][D] = implementation_error;
+            perception[D][D] = 1.0 - perception_error;
+            perception[D][C] = perception_error;
+            Assignment assignment = {{{1.0 - assessment_error, assessment_error},
+                                      {assessment_error, 1.0 - assessment_error}}};
+            return ErrorChannel(implementation, perception, assignment, false);
+        }
+
+        static Matrix Identity() {
+            Matrix m{};
+            for (int a = 0; a < NA; a++) { m[a][a] = 1.0; }
+            return m;
+        }
+
+        // Assessment table with perception and assignment errors.
+        typename Engine::AssessmentTable Assessment(const typename Engine::AssessmentTable& r) const {
+            typename Engine::AssessmentTable out;
+            Assessments(1, r.data(), out.data());
+            return out;
+        }
+
+        // The same for n tables stored one after another, in one pass over their rows.
+        void Assessments(size_t n, const Scalar* r, Scalar* out) const {
+            for (size_t row = 0; row < 4 * n; row++) {
+                const Scalar* in = r + row * NA;
+                for (int a = 0; a < NA; a++) {
+                    Scalar sum = offset[a];
+                    for (int b = 0; b < NA; b++) { sum += gain[a][b] * in[b]; }
+                    out[row * NA + a] = sum;
+                }
+            }
+        }
+
+        // Action table with implementation errors. Defection takes the remaining
+        // probability, as in the ToTable functions of the games.
+        typename Engine::ActionTable Actions(const typename Engine::ActionTable& s) const {
+            typename Engine::ActionTable out;
+            for (int k = 0; k < 4; k++) {
+                Scalar rest = 0.0;
+                for (int a = 1; a < NA; a++) {
+                    Scalar p = 0.0;
+                    for (int i = 0; i < NA; i++) {
+                        int b = (i + 1) % NA;
+                        p += s[k][b] * implementation[b][a];
+                    }
+                    out[k][a] = p;
+                    rest += p;
+                }
+                out[k][D] = 1.0 - rest;
+            }
+            return out;
+        }
+
+        // Probability of a good image given the intended action: the expectation of `r`
+        // over the performed actions. Terms are added in the order of GameEngine::RS.
+        typename Engine::AssessmentTable Intended(const typename Engine::AssessmentTable& r) const {
+            typename Engine::AssessmentTable out;
+            for (int k = 0; k < 4; k++) {
+                for (int a = 0; a < NA; a++) {
+                    Scalar sum = 0.0;
+                    for (int i = 0; i < NA; i++) {
+                        int b = (i + 1) % NA;
+                        sum += implementation[a][b] * r[k * NA + b];
+                    }
+                    out[k * NA + a] = sum;
+                }
+            }
+            return out;
+        }
+
+    private:
+        // composes the assessment map without checking the matrices
+        ErrorChannel(const Matrix& implementation, const Matrix& perception, const Assignment& assignment, bool)
+            : implementation(implementation), perception(perception), assignment(assignment) {
+            const Scalar slope = assignment[G][G] - assignment[B][G];
+            for (int a = 0; a < NA; a++) {
+                Scalar sum = 0.0;
+                for (int b = 0; b < NA; b++) {
+                    gain[a][b] = perception[a][b] * slope;
+                    sum += perception[a][b];
+                }
+                offset[a] = assignment[B][G] * sum;
+            }
+        }
+
+        template <typename Rows>
+        static void CheckRows(const Rows& m, const char* name) {
+            for (const auto& row : m) {
+                double sum = 0.0;
+                for (const auto& x : row) {
+                    if (!(ValueOf(x) >= 0.0 && ValueOf(x) <= 1.0)) {
+                        throw std::runtime_error(std::string("ErrorChannel: ") + name + " probabilities must lie in [0, 1]");
+                    }
+                    sum += ValueOf(x);
+                }
+                if (std::abs(sum - 1.0) > 1e-9) {
+                    throw std::runtime_error(std::string("ErrorChannel: rows of the ") + name + " matrix must sum to one");
+                }
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef EvolutionaryDynamics_H
+#define EvolutionaryDynamics_H
+
+#include "PolymorphicGame.hpp"
+#include "AgentSimulator.hpp"
+#include "SweepEngine.hpp"
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace two_action {
+
+enum class Dynamics {
+    Replicator,          // dx_i = x_i (pi_i - mean payoff)
+    PairwiseComparison   // Fermi imitation: dx_i = x_i sum_j x_j tanh(s (pi_i - pi_j) / 2)
+};
+
+// Deterministic evolutionary dynamics on the simplex of the action rules of a
+// PolymorphicGame, integrated with the adaptive Dormand-Prince RK45 scheme.
+class EvolutionaryDynamics {
+    public:
+        const PolymorphicGame& game;
+        double benefit;
+        double cost;
+        Dynamics dynamics;
+        double selection_strength;   // pairwise comparison only
+
+        struct Trajectory {
+            std::vector<double> x;   // final state
+            double t = 0.0;
+            size_t steps = 0, rejected = 0;
+            bool converged = false;  // velocity dropped below the stationarity tolerance
+        };
+
+        // Per initial condition the index of the vertex (action rule) it converged to, or
+        // NumTypes() when it ended in the interior or on a face.
+        struct Basins {
+            std::vector<long> counts;            // size NumTypes() + 1
+            std::vector<uint32_t> outcome;
+            std::vector<std::vector<double>> endpoints;
+            long unconverged = 0;
+
+            double Share(size_t i) const {
+                long n = 0;
+                for (long c : counts) { n += c; }
+                return n > 0 ? static_cast<double>(counts[i]) / n : 0.0;
+            }
+        };
+
+        EvolutionaryDynamics(const PolymorphicGame& game, double benefit, double cost,
+                             Dynamics dynamics = Dynamics::Replicator, double selection_strength = 1.0)
+            : game(game), benefit(benefit), cost(cost), dynamics(dynamics), selection_strength(selection_strength) {}
+
+        std::vector<double> Velocity(const std::vector<double>& x) const {
+            double g = -1.0;
+            return Velocity(x, g);
+        }
+
+        // `g` warm-starts the image solve and is updated to the population image at x.
+        std::vector<double> Velocity(const std::vector<double>& x, double& g) const {
+            const size_t k = game.NumTypes();
+            std::vector<double> pi = game.calc_payoffs(x, benefit, cost, g);
+            std::vector<double> v(k, 0.0);
+            if (dynamics == Dynamics::Replicator) {
+                double mean = 0.0;
+                for (size_t i = 0; i < k; i++) { mean += x[i] * pi[i]; }
+                for (size_t i = 0; i < k; i++) { v[i] = x[i] * (pi[i] - mean); }
+            } else {
+                for (size_t i = 0; i < k; i++) {
+                    if (x[i] == 0.0) { continue; }
+                    double flow = 0.0;
+                    for (size_t j = 0; j < k; j++) {
+                        if (j != i) { flow += x[j] * std::tanh(0.5 * selection_strength * (pi[i] - pi[j])); }
+                    }
+                    v[i] = x[i] * flow;
+                }
+            }
+            return v;
+        }
+
+        // Integrates from x until t_max or until the largest velocity component drops
+        // below stationary_tolerance. Steps are controlled on the RMS of the scaled
+        // embedded error; after every step the state is projected back onto the simplex.
+        Trajectory Integrate(std::vector<double> x, double t_max, double rel_tolerance = 1e-6,
+                             double abs_tolerance = 1e-9, double stationary_tolerance = 1e-9) const {
+            static constexpr double a[7][6] = {
+                {},
+                {1.0 / 5},
+                {3.0 / 40, 9.0 / 40},
+                {44.0 / 45, -56.0 / 15, 32.0 / 9},
+                {19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729},
+                {9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656},
+                {35.0 / 384, 0.0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84}};
+            // fifth- minus fourth-order weights
+            static constexpr double e[7] = {71.0 / 57600, 0.0, -71.0 / 16695, 71.0 / 1920,
+                                            -17253.0 / 339200, 22.0 / 525, -1.0 / 40};
+
+            const size_t k = x.size();
+            Trajectory tr;
+            std::vector<std::vector<double>> stage(7);
+            std::vector<double> y(k), next(k);
+            double g = -1.0;   // consecutive stages are close, so each image solve starts from the last
+            stage[0] = Velocity(x, g);
+            double h = 0.1;
+            while (tr.t < t_max) {
+                double vmax = 0.0;
+                for (double v : stage[0]) { vmax = std::max(vmax, std::abs(v)); }
+                if (vmax < stationary_tolerance) { tr.converged = true; break; }
+                h = std::min(h, t_max - tr.t);
+
+                for (int s = 1; s < 7; s++) {
+                    for (size_t i = 0; i < k; i++) {
+                        double sum = 0.0;
+                        for (int r = 0; r < s; r++) { sum += a[s][r] * stage[r][i]; }
+                        y[i] = x[i] + h * sum;
+                    }
+                    if (s == 6) { next = y; }
+                    stage[s] = Velocity(y, g);
+                }
+                double err = 0.0;
+                for (size_t i = 0; i < k; i++) {
+                    double d = 0.0;
+                    for (int s = 0; s < 7; s++) { d += e[s] * stage[s][i]; }
+                    double scale = abs_tolerance + rel_tolerance * std::max(std::abs(x[i]), std::abs(next[i]));
+                    err += (h * d / scale) * (h * d / scale);
+                }
+                err = std::sqrt(err / k);
+                if (err <= 1.0) {
+                    tr.t += h;
+                    tr.steps++;
+                    ProjectToSimplex(next);
+                    x.swap(next);
+                    stage[0] = Velocity(x, g);   // the last stage is not reused after the projection
+                } else {
+                    tr.rejected++;
+                }
+                h *= std::min(5.0, std::max(0.2, 0.9 * std::pow(std::max(err, 1e-10), -0.2)));
+            }
+            tr.x = x;
+            return tr;
+        }
+
+        // Integrates num_samples initial conditions drawn uniformly from the simplex (stream i
+        // of `seed` for sample i) in parallel and counts the vertex each one ends at.
+        Basins SampleBasins(size_t num_samples, double t_max, double vertex_tolerance = 1e-3,
+                            uint64_t seed = 1, unsigned num_threads = 0) const {
+            const size_t k = game.NumTypes();
+            Basins basins;
+            basins.outcome.resize(num_samples);
+            basins.endpoints.resize(num_samples);
+            std::vector<uint8_t> converged(num_samples);
+            ParallelFor(num_samples, [&](size_t begin, size_t end, unsigned) {
+                for (size_t n = begin; n < end; n++) {
+                    CounterRNG rng(seed, n);
+                    Trajectory tr = Integrate(UniformSimplexPoint(rng, k), t_max);
+                    size_t best = std::max_element(tr.x.begin(), tr.x.end()) - tr.x.begin();
+                    basins.outcome[n] = (tr.x[best] > 1.0 - vertex_tolerance) ? best : k;
+                    basins.endpoints[n] = tr.x;
+                    converged[n] = tr.converged;
+                }
+            }, num_threads);
+            basins.counts.assign(k + 1, 0);
+            for (size_t n = 0; n < num_samples; n++) {
+                basins.counts[basins.outcome[n]]++;
+                basins.unconverged += !converged[n];
+            }
+            return basins;
+        }
+
+        // Dirichlet(1, ..., 1) sample.
+        static std::vector<double> UniformSimplexPoint(CounterRNG& rng, size_t k) {
+            std::vector<double> x(k);
+            double total = 0.0;
+            for (auto& xi : x) {
+                xi = -std::log(1.0 - rng.Uniform());
+                total += xi;
+            }
+            for (auto& xi : x) { xi /= total; }
+            return x;
+        }
+
+        static void ProjectToSimplex(std::vector<double>& x) {
+            double total = 0.0;
+            for (auto& xi : x) {
+                xi = std::max(xi, 0.0);
+                total += xi;
+            }
+            for (auto& xi : x) { xi /= total; }
+        }
+};
+
+}  // namespace two_action
+
+#endif
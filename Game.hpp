@@ -2,112 +2,158 @@
 #define GAME_H
 
 #include "Norms.hpp"
+#include "GameEngine.hpp"
+#include "ErrorChannel.hpp"
 
+#include <optional>
 
-class Game {
+
+namespace two_action {
+
+// Scalar is double, or a Dual from Dual.hpp to differentiate the equilibrium state,
+// cooperation, payoffs and Delta_v with respect to the error rates, benefit and cost.
+template <typename Scalar = double>
+class BasicGame {
     public:
-        double assessment_error;
-        double perception_error;
-        double mu_e;
+        using Engine = GameEngine<2, Scalar>;
+        using Channel = ErrorChannel<2, Scalar>;
+
+        // the rates of Channel::Standard; for a general channel, those of its
+        // assignment[G][B], perception[D][C] and implementation[C][D] entries
+        Scalar assessment_error;
+        Scalar perception_error;
+        Scalar mu_e;
+        std::optional<Channel> general_channel;   // none for the rate constructor
         Norm norm;
         Norm r_norm;
-        double equilibrium_state;
-        double resident_coop;
+        Engine engine;
+        Scalar equilibrium_state;
+        Scalar resident_coop;
+        bool standard_channel;
 
         static constexpr Reputation B = Reputation::B, G = Reputation::G;
         static constexpr Action C = Action::C, D = Action::D;
 
-        Game(double assessment_error, double perception_error, double mu_e, const Norm& norm)
+        BasicGame(Scalar assessment_error, Scalar perception_error, Scalar mu_e, const Norm& norm)
             : assessment_error(assessment_error), perception_error(perception_error), mu_e(mu_e), norm(norm),
-              r_norm(norm.RescaleWithError(assessment_error, perception_error, mu_e)),
-              equilibrium_state(calc_equilibrium_state()),
-              resident_coop(calc_self_coop_resident()) {}
-
+              r_norm(norm.RescaleWithError(ValueOf(assessment_error), ValueOf(perception_error), ValueOf(mu_e))),
+              engine(RescaleAssessment(norm.assessment_rule, assessment_error, perception_error),
+                     ToTable(norm.action_rule, mu_e)),
+              equilibrium_state(engine.h),
+              resident_coop(engine.resident_actions[Engine::C]),
+              standard_channel(true) {}
+
+        // Game under any error channel. The assessment table is the channel's affine map
+        // of the norm's, so it agrees with the constructor above to rounding only.
+        BasicGame(const Channel& channel, const Norm& norm)
+            : assessment_error(channel.assignment[Channel::G][Channel::B]),
+              perception_error(channel.perception[Engine::D][Engine::C]),
+              mu_e(channel.implementation[Engine::C][Engine::D]), general_channel(channel), norm(norm),
+              r_norm(RescaleWithError(channel, norm)),
+              engine(channel.Assessment(ToTable(norm.assessment_rule)), channel.Actions(ToTable(norm.action_rule))),
+              equilibrium_state(engine.h),
+              resident_coop(engine.resident_actions[Engine::C]),
+              standard_channel(false) {}
+
+        // Norm::RescaleWithError for a channel.
+        static Norm RescaleWithError(const Channel& channel, const Norm& norm) {
+            auto r = channel.Assessment(ToTable(norm.assessment_rule));
+            auto s = channel.Actions(ToTable(norm.action_rule));
+            std::array<double, 8> good_probs;
+            std::array<double, 4> coop_probs;
+            for (int i = 0; i < 8; i++) { good_probs[i] = ValueOf(r[i]); }
+            for (int k = 0; k < 4; k++) { coop_probs[k] = ValueOf(s[k][Engine::C]); }
+            return Norm{AssessmentRule(good_probs), ActionRule(coop_probs)};
+        }
 
-        double calc_equilibrium_state() {
-            const AssessmentRule R = r_norm.assessment_rule;
-            const ActionRule S = r_norm.action_rule;
+        static typename Engine::AssessmentTable ToTable(const AssessmentRule& rule) {
+            typename Engine::AssessmentTable r;
+            for (int i = 0; i < 8; i++) { r[i] = rule.good_probs[i]; }
+            return r;
+        }
 
-            double RS_GG = R(G, G, C) * S(G, G) + R(G, G, D) * (1.0 - S(G, G));
-            double RS_GB = R(G, B, C) * S(G, B) + R(G, B, D) * (1.0 - S(G, B));
-            double RS_BG = R(B, G, C) * S(B, G) + R(B, G, D) * (1.0 - S(B, G));
-            double RS_BB = R(B, B, C) * S(B, B) + R(B, B, D) * (1.0 - S(B, B));
-            double c2 = RS_GG - RS_GB - RS_BG + RS_BB;
-            double c1 = RS_GB + RS_BG - 2.0 * RS_BB - 1;
-            double c0 = RS_BB;
-
-            if (std::abs(c2) < 1e-9) {
-                return -c0 / c1;
-            } else {
-                return (-c1 - std::sqrt(c1 * c1 - 4.0 * c2 * c0)) / (2.0 * c2);
+        // AssessmentRule::RescaleWithError in Scalar arithmetic.
+        static typename Engine::AssessmentTable RescaleAssessment(const AssessmentRule& rule, Scalar assessment_error,
+                                                                  Scalar perception_error) {
+            typename Engine::AssessmentTable r;
+            for (size_t i = 0; i < 8; i++) {
+                r[i] = (1.0 - assessment_error) * rule.good_probs[i] + assessment_error * (1.0 - rule.good_probs[i]);
             }
+            for (size_t i = 0; i < 8; i += 2) {
+                r[i] = (1.0 - perception_error) * r[i] + perception_error * r[i + 1];
+            }
+            return r;
         }
 
-        double calc_self_coop_resident () {
-            ActionRule S = r_norm.action_rule;
-            double c1 = equilibrium_state * equilibrium_state * S(G, G);
-            double c2 = equilibrium_state * (1.0 - equilibrium_state) * (S(G, B) + S(B, G));
-            double c3 = (1.0 - equilibrium_state) * (1.0 - equilibrium_state) * S(B, B);
-            return c1 + c2 + c3;
-        };
-
-        std::tuple<double, double, double> calc_invader_stats(const ActionRule& invader_strategy) const {
-            ActionRule S_mut = invader_strategy.RescaleWithError(mu_e);
-            double H = calc_equilibrium_state_mutant(S_mut);
-            double coop_invader_to_resident = 0.0;
-            {
-                double c1 = equilibrium_state * H * S_mut(G, G);
-                double c2 = (1.0 - equilibrium_state) * H * S_mut(G, B);
-                double c3 = equilibrium_state * (1.0 -  H) * S_mut(B, G);
-                double c4 = (1.0 - equilibrium_state) * (1.0 - H) * S_mut(B, B);
-                coop_invader_to_resident = c1 + c2 + c3 + c4;
+        // Action table of `rule` after implementation errors mu_e.
+        static typename Engine::ActionTable ToTable(const ActionRule& rule, Scalar mu_e = 0.0) {
+            typename Engine::ActionTable table;
+            for (int k = 0; k < 4; k++) {
+                Scalar p = rule.coop_probs[k] * (1.0 - mu_e);
+                table[k] = {1.0 - p, p};
             }
-            double coop_resident_to_invader = 0.0;
-            {
-                ActionRule S = r_norm.action_rule;
-                double c1 = equilibrium_state * H * S(G, G);
-                double c2 = equilibrium_state * (1.0 - H) * S(G, B);
-                double c3 = (1.0 - equilibrium_state) * H * S(B, G);
-                double c4 = (1.0 - equilibrium_state) * (1.0 - H) * S(B, B);
-                coop_resident_to_invader = c1 + c2 + c3 + c4;
-            }
-            return std::make_tuple(H, coop_invader_to_resident, coop_resident_to_invader);
+            return table;
         }
 
-        double calc_delta_v(double benefit, double cost) const {
-            AssessmentRule R = r_norm.assessment_rule;
-            ActionRule S = r_norm.action_rule;
+        // The error channel: the one given to the constructor, or Channel::Standard of the
+        // rates, built on each call.
+        Channel channel() const {
+            return general_channel ? *general_channel : Channel::Standard(assessment_error, perception_error, mu_e);
+        }
 
-            double Num1 = benefit * (equilibrium_state * (S(G, G) - S(G, B))
-                                    + (1.0 - equilibrium_state) * (S(B, G) - S(B, B)));
-            double Num2 = cost * (equilibrium_state * (S(G, G) - S(B, G))
-                                + (1.0 - equilibrium_state) * (S(G, B) - S(B, B)));
+        // Action table of `rule` after the implementation errors of the channel; the same
+        // as ToTable(rule, mu_e) for the standard channel, which takes that shorter path.
+        typename Engine::ActionTable Performed(const ActionRule& rule) const {
+            return standard_channel ? ToTable(rule, mu_e) : general_channel->Actions(ToTable(rule));
+        }
 
-            double RS_GG = R(G, G, C) * S(G, G) + R(G, G, D) * (1.0 - S(G, G));
-            double RS_GB = R(G, B, C) * S(G, B) + R(G, B, D) * (1.0 - S(G, B));
-            double RS_BG = R(B, G, C) * S(B, G) + R(B, G, D) * (1.0 - S(B, G));
-            double RS_BB = R(B, B, C) * S(B, B) + R(B, B, D) * (1.0 - S(B, B));
-            double Den = 1.0 - equilibrium_state * (RS_GG - RS_BG) - (1.0 - equilibrium_state) * (RS_GB - RS_BB);
+        Scalar calc_equilibrium_state() const { return Engine::EquilibriumState(engine.RS(engine.S)); }
+
+        Scalar calc_self_coop_resident() const { return engine.ResidentActions()[Engine::C]; }
+
+        std::tuple<Scalar, Scalar, Scalar> calc_invader_stats(const ActionRule& invader_strategy) const {
+            auto st = engine.Invader(Performed(invader_strategy));
+            return std::make_tuple(st.H, st.mut_to_res[Engine::C], st.res_to_mut[Engine::C]);
+        }
+
+        Scalar calc_resident_payoff(Scalar benefit, Scalar cost) const { return (benefit - cost) * resident_coop; }
+
+        Scalar calc_invader_payoff(const ActionRule& invader_strategy, Scalar benefit, Scalar cost) const {
+            auto [H, coop_mut_to_res, coop_res_to_mut] = calc_invader_stats(invader_strategy);
+            return benefit * coop_res_to_mut - cost * coop_mut_to_res;
+        }
+
+        Scalar calc_delta_v(Scalar benefit, Scalar cost) const {
+            auto S = [this](int x, int y) { return engine.S[x * 2 + y][Engine::C]; };
+            const int G = 1, B = 0;
+            const Scalar h = equilibrium_state;
+
+            Scalar Num1 = benefit * (h * (S(G, G) - S(G, B))
+                                    + (1.0 - h) * (S(B, G) - S(B, B)));
+            Scalar Num2 = cost * (h * (S(G, G) - S(B, G))
+                                + (1.0 - h) * (S(G, B) - S(B, B)));
+
+            auto rs = engine.RS(engine.S);
+            Scalar Den = 1.0 - h * (rs[Engine::GG] - rs[Engine::BG])
+                         - (1.0 - h) * (rs[Engine::GB] - rs[Engine::BB]);
 
             return (Num1 - Num2) / Den;
         }
 
+        // Double precision only: rescales the norm itself.
         double calc_delta_v2(double benefit, double cost) const {
-            // conduct rescaling of mu_e against assessment_rule, benefit, and cost
+            // move implementation errors from the action rule into assessment_rule, benefit, and cost
             ActionRule S = norm.action_rule;  // S is not rescaled
             AssessmentRule R = r_norm.assessment_rule;
+            const Channel channel = this->channel();
             {
-                double ggc = (1.0 - mu_e) * R(G, G, C) + mu_e * R(G, G, D);
-                R.Set(G, G, C, ggc);
-                double gbc = (1.0 - mu_e) * R(G, B, C) + mu_e * R(G, B, D);
-                R.Set(G, B, C, gbc);
-                double bgc = (1.0 - mu_e) * R(B, G, C) + mu_e * R(B, G, D);
-                R.Set(B, G, C, bgc);
-                double bbc = (1.0 - mu_e) * R(B, B, C) + mu_e * R(B, B, D);
-                R.Set(B, B, C, bbc);
+                auto intended = channel.Intended(ToTable(R));
+                for (int i = 0; i < 8; i++) { R.good_probs[i] = ValueOf(intended[i]); }
             }
-            double r_benefit = (1.0 - mu_e) * benefit;
-            double r_cost = (1.0 - mu_e) * cost;
+            // a change of the intended cooperation changes the performed one by this factor
+            const double q = ValueOf(channel.implementation[Engine::C][Engine::C] - channel.implementation[Engine::D][Engine::C]);
+            double r_benefit = q * benefit;
+            double r_cost = q * cost;
 
             double RS_GG = R(G, G, C) * S(G, G) + R(G, G, D) * (1.0 - S(G, G));
             double RS_GB = R(G, B, C) * S(G, B) + R(G, B, D) * (1.0 - S(G, B));
@@ -137,42 +183,44 @@ class Game {
             return (Num1 - Num2) / Den;
         }
 
-        bool isESS(double benefit, double cost) const {
-            double self_payoff = (benefit - cost) * resident_coop;
-            for (int i=0; i < 16; i++) {
-                if (norm.action_rule.ID() == i) {
-                    continue; // Skip the resident strategy
-                }
-                // Define Mutant Norm
-                ActionRule invader = ActionRule::MakeDeterministicRule(i);
-
-                // Calculate Payoff
-                auto [H,coop_mut_to_res,coop_res_to_mut] = calc_invader_stats(invader);
-                double invader_payoff = benefit * coop_res_to_mut - cost * coop_mut_to_res;
-
-                // Check Nash Equilibrium
-                if (invader_payoff > self_payoff) {
-                    return false;
-                }
+        // GameEngine::IsESS over the 16 deterministic invaders, stopping at the first that
+        // beats the residents; the rules are built once and their tables on the stack.
+        bool isESS(Scalar benefit, Scalar cost) const {
+            static const std::vector<ActionRule> invaders = [] {
+                std::vector<ActionRule> all;
+                for (int i = 0; i < 16; i++) { all.push_back(ActionRule::MakeDeterministicRule(i)); }
+                return all;
+            }();
+            const typename Engine::ActionVector b{0.0, benefit}, c{0.0, cost};
+            const Scalar self_payoff = engine.ResidentPayoff(b, c);
+            const int skip = norm.action_rule.ID();
+            for (int i = 0; i < 16; i++) {
+                if (i == skip) { continue; }
+                if (Engine::InvaderPayoff(engine.Invader(Performed(invaders[i])), b, c) > self_payoff) { return false; }
             }
             return true;
         }
 
-    private:
-        double calc_equilibrium_state_mutant(const ActionRule& invader_strategy) const {
-            const AssessmentRule R = r_norm.assessment_rule;
-            const ActionRule S = invader_strategy;
-
-            double RS_GG = R(G, G, C) * S(G, G) + R(G, G, D) * (1.0 - S(G, G));
-            double RS_GB = R(G, B, C) * S(G, B) + R(G, B, D) * (1.0 - S(G, B));
-            double RS_BG = R(B, G, C) * S(B, G) + R(B, G, D) * (1.0 - S(B, G));
-            double RS_BB = R(B, B, C) * S(B, B) + R(B, B, D) * (1.0 - S(B, B));
-
-            double num = equilibrium_state * RS_BG + (1.0 - equilibrium_state) * RS_BB;
-            double den = (1.0 - equilibrium_state * RS_GG +  equilibrium_state * RS_BG
-                - (1.0 - equilibrium_state) * RS_GB + (1.0 - equilibrium_state) * RS_BB);
-            return num / den;
+        // self payoff - best invader payoff; non-negative for an ESS. `best` receives the ID of
+        // the invader attaining the maximum, so derivatives of the margin are those of that invader.
+        Scalar calc_ess_margin(Scalar benefit, Scalar cost, int* best = nullptr) const {
+            Scalar self_payoff = calc_resident_payoff(benefit, cost), margin = 0.0;
+            bool first = true;
+            for (int i = 0; i < 16; i++) {
+                if (i == norm.action_rule.ID()) { continue; }
+                Scalar m = self_payoff - calc_invader_payoff(ActionRule::MakeDeterministicRule(i), benefit, cost);
+                if (first || m < margin) {
+                    margin = m;
+                    if (best) { *best = i; }
+                    first = false;
+                }
+            }
+            return margin;
         }
 };
 
-#endif
\ No newline at end of file
+using Game = BasicGame<double>;
+
+}  // namespace two_action
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef GameEngine_H
+#define GameEngine_H
+
+#include <array>
+#include <vector>
+#include <cmath>
+
+
+// Model-independent core of Game.hpp and GameWithPunishment.hpp. A model is a set
+// of NA actions (0 = D, 1 = C, further actions such as punishment after them) and the
+// binary reputations B = 0, G = 1; graded reputations are MultiLevelGame.hpp, whose
+// stationary solve replaces the closed-form equilibrium. Rules are flat tables of
+// compile-time size:
+//     assessment[(donor * 2 + recipient) * NA + action]: probability of a good image
+//     action_rule[donor * 2 + recipient][action]:        probability of the action
+// The assessment layout is that of good_probs in both norm headers.
+//
+// Value of a scalar; Dual.hpp overloads it for dual numbers.
+inline double ValueOf(double x) { return x; }
+
+// Scalar is double, or Dual<N> from Dual.hpp to carry exact derivatives with respect
+// to error rates, benefits and costs through every quantity.
+template <int NA, typename Scalar = double>
+class GameEngine {
+    static_assert(NA >= 2, "GameEngine: need at least defection and cooperation");
+
+    public:
+        static constexpr int NumActions = NA, NumReputations = 2;
+        static constexpr int D = 0, C = 1;
+        static constexpr int BB = 0, BG = 1, GB = 2, GG = 3;   // donor * 2 + recipient
+
+        using ActionVector = std::array<Scalar, NA>;
+        using ActionTable = std::array<ActionVector, 4>;
+        using AssessmentTable = std::array<Scalar, 4 * NA>;
+
+        struct InvaderStats {
+            Scalar H;                 // image of the rare invader
+            ActionVector mut_to_res;  // frequency of each action of the invader towards residents
+            ActionVector res_to_mut;  // and of the residents towards the invader
+        };
+
+        AssessmentTable R;            // with assessment and perception errors
+        ActionTable S;                // with implementation errors
+        Scalar h;
+        ActionVector resident_actions;
+
+        GameEngine(const AssessmentTable& R, const ActionTable& S)
+            : R(R), S(S), h(EquilibriumState(RS(S))), resident_actions(ResidentActions()) {}
+
+        // The same with RS(S) given, e.g. read off a deterministic action table.
+        GameEngine(const AssessmentTable& R, const ActionTable& S, const std::array<Scalar, 4>& rs)
+            : R(R), S(S), h(EquilibriumState(rs)), resident_actions(ResidentActions()) {}
+
+        // Probability of a good image after acting on each (donor, recipient) pair:
+        // RS_XY = sum_a R(X, Y, a) S(X, Y)[a]. Cooperation is added first, then the other
+        // actions and defection last, the order of the original two-action formula.
+        std::array<Scalar, 4> RS(const ActionTable& rule) const {
+            std::array<Scalar, 4> rs{};
+            for (int k = 0; k < 4; k++) {
+                Scalar sum = 0.0;
+                for (int i = 0; i < NA; i++) {
+                    int a = (i + 1) % NA;
+                    sum += R[k * NA + a] * rule[k][a];
+                }
+                rs[k] = sum;
+            }
+            return rs;
+        }
+
+        // Smaller root of c2 h^2 + c1 h + c0 = 0.
+        static Scalar EquilibriumState(const std::array<Scalar, 4>& rs) {
+            using std::abs;
+            using std::sqrt;
+            Scalar c2 = rs[GG] - rs[GB] - rs[BG] + rs[BB];
+            Scalar c1 = rs[GB] + rs[BG] - 2.0 * rs[BB] - 1.0;
+            Scalar c0 = rs[BB];
+
+            if (abs(c2) < 1e-9) {
+                // The root moves with c2 as -c0 / c1 - c2 c0^2 / c1^3; the correction has value
+                // zero but carries the derivative with respect to c2 for dual numbers.
+                Scalar dc2 = c2 - ValueOf(c2);
+                return -c0 / c1 - dc2 * c0 * c0 / (c1 * c1 * c1);
+            } else {
+                return (-c1 - sqrt(c1 * c1 - 4.0 * c2 * c0)) / (2.0 * c2);
+            }
+        }
+
+        // Image of a rare donor using `rule` in the resident population.
+        Scalar MutantState(const ActionTable& rule) const {
+            auto rs = RS(rule);
+            Scalar num = h * rs[BG] + (1.0 - h) * rs[BB];
+            Scalar den = (1.0 - h * rs[GG] + h * rs[BG] - (1.0 - h) * rs[GB] + (1.0 - h) * rs[BB]);
+            return num / den;
+        }
+
+        // Frequency of each action among residents.
+        ActionVector ResidentActions() const {
+            ActionVector f{};
+            for (int a = 0; a < NA; a++) {
+                Scalar c1 = h * h * S[GG][a];
+                Scalar c2 = h * (1.0 - h) * (S[GB][a] + S[BG][a]);
+                Scalar c3 = (1.0 - h) * (1.0 - h) * S[BB][a];
+                f[a] = c1 + c2 + c3;
+            }
+            return f;
+        }
+
+        InvaderStats Invader(const ActionTable& rule) const {
+            InvaderStats st;
+            Scalar H = st.H = MutantState(rule);
+            for (int a = 0; a < NA; a++) {
+                Scalar c1 = h * H * rule[GG][a];
+                Scalar c2 = (1.0 - h) * H * rule[GB][a];
+                Scalar c3 = h * (1.0 - H) * rule[BG][a];
+                Scalar c4 = (1.0 - h) * (1.0 - H) * rule[BB][a];
+                st.mut_to_res[a] = c1 + c2 + c3 + c4;
+            }
+            for (int a = 0; a < NA; a++) {
+                Scalar c1 = h * H * S[GG][a];
+                Scalar c2 = h * (1.0 - H) * S[GB][a];
+                Scalar c3 = (1.0 - h) * H * S[BG][a];
+                Scalar c4 = (1.0 - h) * (1.0 - H) * S[BB][a];
+                st.res_to_mut[a] = c1 + c2 + c3 + c4;
+            }
+            return st;
+        }
+
+        // Payoffs with `benefit[a]` going to the recipient and `cost[a]` paid by the donor
+        // of action a (negative benefits are harms such as punishment).
+        Scalar ResidentPayoff(const ActionVector& benefit, const ActionVector& cost) const {
+            Scalar payoff = 0.0;
+            for (int a = 0; a < NA; a++) { payoff += (benefit[a] - cost[a]) * resident_actions[a]; }
+            return payoff;
+        }
+
+        static Scalar InvaderPayoff(const InvaderStats& st, const ActionVector& benefit, const ActionVector& cost) {
+            Scalar payoff = 0.0;
+            for (int a = 0; a < NA; a++) {
+                payoff += benefit[a] * st.res_to_mut[a];
+                payoff -= cost[a] * st.mut_to_res[a];
+            }
+            return payoff;
+        }
+
+        // True when no invader except the one at index `skip` earns more than the residents.
+        bool IsESS(const std::vector<ActionTable>& invaders, int skip,
+                   const ActionVector& benefit, const ActionVector& cost) const {
+            Scalar self_payoff = ResidentPayoff(benefit, cost);
+            for (int i = 0; i < static_cast<int>(invaders.size()); i++) {
+                if (i == skip) { continue; }
+                if (InvaderPayoff(Invader(invaders[i]), benefit, cost) > self_payoff) { return false; }
+            }
+            return true;
+        }
+};
+
+#endif
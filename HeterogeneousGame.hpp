@@ -0,0 +1,390 @@
+#ifndef HeterogeneousGame_H
+#define HeterogeneousGame_H
+
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "QuasiRandom.hpp"
+
+#include <vector>
+#include <array>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace two_action {
+
+// Game.hpp for populations whose members differ in their error rates. Everybody follows
+// the same norm; each individual's (assessment_error, perception_error, mu_e) is drawn
+// from a distribution. Under public assessment the two roles separate:
+//   - the observer of a donation is a random individual, so images are updated by the
+//     assessment table averaged over the observers' (assessment_error, perception_error);
+//   - a donor's actions, and hence its image h(mu), depend on its own mu_e. As in
+//     PolymorphicGame.hpp the images depend on each other only through the probability g
+//     that a random recipient is good, h(mu) = a / (1 - c + a) with
+//     a = g RS_BG + (1 - g) RS_BB and c = g RS_GG + (1 - g) RS_GB, and g solves
+//     g = E[h(mu)].
+// Only the marginals of the two roles matter, not how an individual's rates correlate.
+// The averaged table is bilinear in (assessment_error, perception_error), so independent
+// observer rates act like their means; spread in mu_e changes the results.
+//
+// The expectations over mu_e are sums over weighted nodes (Gauss rules or Sobol points).
+// Every pass over the nodes (the Newton iterations for g, the resident aggregates and the
+// payoffs of all 16 invaders) is a branch-free loop over arrays that the compiler
+// vectorizes, so a game costs about (nodes / vector width) homogeneous games.
+
+// One error rate across the population as weighted nodes; the weights sum to one.
+struct ErrorMarginal {
+    std::vector<double> nodes;
+    std::vector<double> weights;
+
+    static ErrorMarginal Point(double x) { return ErrorMarginal{{x}, {1.0}}; }
+
+    // n-point Gauss rule of the Beta distribution with this mean and concentration
+    // alpha + beta: exact for polynomials of degree 2n - 1 in the rate. The nodes are the
+    // eigenvalues of the Jacobi matrix of the orthogonal polynomials (Golub-Welsch). A mean
+    // of 0 or 1 is a point mass.
+    static ErrorMarginal Beta(double mean, double concentration, int n) {
+        if (!(mean >= 0.0 && mean <= 1.0) || !(concentration > 0.0) || n < 1) {
+            throw std::runtime_error("ErrorMarginal: need a mean in [0, 1], a positive concentration and n >= 1");
+        }
+        if (mean == 0.0 || mean == 1.0) { return Point(mean); }
+        return Jacobi(mean * concentration, (1.0 - mean) * concentration, n);
+    }
+
+    // n-point Gauss-Legendre rule of the uniform distribution on [lo, hi].
+    static ErrorMarginal Uniform(double lo, double hi, int n) {
+        ErrorMarginal m = Jacobi(1.0, 1.0, n);
+        for (double& x : m.nodes) { x = lo + (hi - lo) * x; }
+        return m;
+    }
+
+    // Distribution with density proportional to `density` on [lo, hi], by the n-point
+    // Gauss-Legendre rule; accurate for smooth densities.
+    template <typename F>
+    static ErrorMarginal Density(double lo, double hi, F&& density, int n) {
+        ErrorMarginal m = Uniform(lo, hi, n);
+        double total = 0.0;
+        for (size_t i = 0; i < m.nodes.size(); i++) { total += m.weights[i] *= density(m.nodes[i]); }
+        if (!(total > 0.0)) { throw std::runtime_error("ErrorMarginal: the density vanishes at all nodes"); }
+        for (double& w : m.weights) { w /= total; }
+        return m;
+    }
+
+    double Mean() const {
+        double mean = 0.0;
+        for (size_t i = 0; i < nodes.size(); i++) { mean += weights[i] * nodes[i]; }
+        return mean;
+    }
+
+    private:
+        // Gauss rule of the density x^(a - 1) (1 - x)^(b - 1) on [0, 1], from the Jacobi
+        // polynomials on [-1, 1] with exponents (b - 1, a - 1).
+        static ErrorMarginal Jacobi(double a, double b, int n) {
+            const double p = b - 1.0, q = a - 1.0, s = p + q;
+            std::vector<double> d(n), e(n, 0.0);
+            for (int k = 0; k < n; k++) {
+                const double t = 2.0 * k + s;
+                d[k] = (k == 0) ? (q - p) / (s + 2.0) : (q * q - p * p) / (t * (t + 2.0));
+                if (k + 1 < n) {
+                    const double m = k + 1.0, u = 2.0 * m + s;
+                    const double beta = (m == 1.0) ? 4.0 * (1.0 + p) * (1.0 + q) / ((2.0 + s) * (2.0 + s) * (3.0 + s))
+                                                   : 4.0 * m * (m + p) * (m + q) * (m + s) / (u * u * (u + 1.0) * (u - 1.0));
+                    e[k] = std::sqrt(beta);
+                }
+            }
+            std::vector<double> z(n, 0.0);
+            z[0] = 1.0;
+            TridiagonalEigen(d, e, z);
+            std::vector<int> order(n);
+            for (int k = 0; k < n; k++) { order[k] = k; }
+            std::sort(order.begin(), order.end(), [&](int i, int j) { return d[i] < d[j]; });
+            ErrorMarginal m;
+            for (int k : order) {
+                m.nodes.push_back(0.5 * (1.0 + d[k]));
+                m.weights.push_back(z[k] * z[k]);
+            }
+            return m;
+        }
+
+        // Eigenvalues of the symmetric tridiagonal matrix with diagonal d and off-diagonal
+        // e[0 .. n-2] by implicit QL; z, the first row of the identity on entry, receives
+        // the first components of the normalized eigenvectors.
+        static void TridiagonalEigen(std::vector<double>& d, std::vector<double>& e, std::vector<double>& z) {
+            const int n = static_cast<int>(d.size());
+            for (int l = 0; l < n; l++) {
+                for (int iter = 0;; iter++) {
+                    int m = l;
+                    for (; m < n - 1; m++) {
+                        const double dd = std::abs(d[m]) + std::abs(d[m + 1]);
+                        if (std::abs(e[m]) <= std::numeric_limits<double>::epsilon() * dd) { break; }
+                    }
+                    if (m == l) { break; }
+                    if (iter == 100) { throw std::runtime_error("ErrorMarginal: no convergence of the quadrature nodes"); }
+                    double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+                    double r = std::hypot(g, 1.0);
+                    g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+                    double s = 1.0, c = 1.0, p = 0.0;
+                    int i = m - 1;
+                    for (; i >= l; i--) {
+                        double f = s * e[i], b = c * e[i];
+                        e[i + 1] = r = std::hypot(f, g);
+                        if (r == 0.0) {
+                            d[i + 1] -= p;
+                            e[m] = 0.0;
+                            break;
+                        }
+                        s = f / r;
+                        c = g / r;
+                        g = d[i + 1] - p;
+                        r = (d[i] - g) * s + 2.0 * c * b;
+                        p = s * r;
+                        d[i + 1] = g + p;
+                        g = c * r - b;
+                        f = z[i + 1];
+                        z[i + 1] = s * z[i] + c * f;
+                        z[i] = c * z[i] - s * f;
+                    }
+                    if (r == 0.0 && i >= l) { continue; }
+                    d[l] -= p;
+                    e[l] = g;
+                    e[m] = 0.0;
+                }
+            }
+        }
+};
+
+// Error rates of a population as weighted nodes of the two roles: the observers' joint
+// (assessment_error, perception_error) and the donors' mu_e.
+struct ErrorDistribution {
+    std::vector<double> observer_weight, assessment_error, perception_error;
+    std::vector<double> donor_weight, mu_e;
+
+    static ErrorDistribution Point(double assessment_error, double perception_error, double mu_e) {
+        return ErrorDistribution{{1.0}, {assessment_error}, {perception_error}, {1.0}, {mu_e}};
+    }
+
+    // Independent rates: the product rule of the first two marginals for the observers.
+    static ErrorDistribution Independent(const ErrorMarginal& assessment_error, const ErrorMarginal& perception_error,
+                                         const ErrorMarginal& mu_e) {
+        ErrorDistribution dist;
+        for (size_t i = 0; i < assessment_error.nodes.size(); i++) {
+            for (size_t j = 0; j < perception_error.nodes.size(); j++) {
+                dist.observer_weight.push_back(assessment_error.weights[i] * perception_error.weights[j]);
+                dist.assessment_error.push_back(assessment_error.nodes[i]);
+                dist.perception_error.push_back(perception_error.nodes[j]);
+            }
+        }
+        dist.donor_weight = mu_e.weights;
+        dist.mu_e = mu_e.nodes;
+        return dist;
+    }
+
+    // Quasi-Monte Carlo: n Sobol points u in [0, 1)^3, each mapped by `transform(u)` to an
+    // individual's (assessment_error, perception_error, mu_e), e.g. by inverse CDFs or a
+    // copula, with weight 1 / n. The points are shifted by half a cell, 1 / (2n) modulo 1,
+    // so that for n a power of two every coordinate takes the midpoints (k + 1/2) / n.
+    template <typename Transform>
+    static ErrorDistribution Sampled(size_t n, Transform&& transform) {
+        if (n == 0) { throw std::runtime_error("ErrorDistribution: need at least one sample"); }
+        SobolSequence sobol(3);
+        ErrorDistribution dist;
+        for (size_t i = 0; i < n; i++) {
+            std::array<double, 3> u;
+            sobol.Point(i, u.data());
+            for (double& x : u) { x = std::fmod(x + 0.5 / n, 1.0); }
+            const std::array<double, 3> x = transform(u);
+            dist.observer_weight.push_back(1.0 / n);
+            dist.assessment_error.push_back(x[0]);
+            dist.perception_error.push_back(x[1]);
+            dist.donor_weight.push_back(1.0 / n);
+            dist.mu_e.push_back(x[2]);
+        }
+        return dist;
+    }
+
+    void Check() const {
+        auto check = [](const std::vector<double>& w, std::initializer_list<const std::vector<double>*> rates) {
+            double total = 0.0;
+            for (double x : w) {
+                if (!(x >= 0.0)) { throw std::runtime_error("ErrorDistribution: weights must be non-negative"); }
+                total += x;
+            }
+            if (w.empty() || std::abs(total - 1.0) > 1e-9) { throw std::runtime_error("ErrorDistribution: weights must sum to one"); }
+            for (const auto* r : rates) {
+                if (r->size() != w.size()) { throw std::runtime_error("ErrorDistribution: one rate per node expected"); }
+                for (double x : *r) {
+                    if (!(x >= 0.0 && x <= 1.0)) { throw std::runtime_error("ErrorDistribution: error rates must lie in [0, 1]"); }
+                }
+            }
+        };
+        check(observer_weight, {&assessment_error, &perception_error});
+        check(donor_weight, {&mu_e});
+    }
+};
+
+class HeterogeneousGame {
+    public:
+        using Engine = GameEngine<2>;
+
+        ErrorDistribution errors;
+        Norm norm;
+        Engine::AssessmentTable R;           // averaged over the observers
+        double equilibrium_state;            // g: probability that a random individual is good
+        std::vector<double> images;          // h(mu) at the donor nodes
+        double resident_coop;
+        int iterations;                      // Newton steps for g
+
+        HeterogeneousGame(const ErrorDistribution& errors, const Norm& norm, double tolerance = 1e-14)
+            : errors(errors), norm(norm), R{}, iterations(0) {
+            errors.Check();
+            for (size_t o = 0; o < errors.observer_weight.size(); o++) {
+                auto r = Game::RescaleAssessment(norm.assessment_rule, errors.assessment_error[o], errors.perception_error[o]);
+                for (int k = 0; k < 8; k++) { R[k] += errors.observer_weight[o] * r[k]; }
+            }
+            const size_t n = errors.mu_e.size();
+            q.resize(n);
+            images.resize(n);
+            double mean_q = 0.0;
+            for (size_t i = 0; i < n; i++) {
+                q[i] = 1.0 - errors.mu_e[i];
+                mean_q += errors.donor_weight[i] * q[i];
+            }
+            const auto& p = norm.action_rule.coop_probs;
+            for (int k = 0; k < 4; k++) {
+                rs_c[k] = R[2 * k + 1] - R[2 * k];
+                rs_d[k] = R[2 * k];
+            }
+            // warm start: the homogeneous game at the mean mu_e, exact for a point mass
+            std::array<double, 4> rs;
+            for (int k = 0; k < 4; k++) { rs[k] = rs_d[k] + rs_c[k] * p[k] * mean_q; }
+            equilibrium_state = Solve(Engine::EquilibriumState(rs), tolerance);
+
+            // resident donors towards a good and a bad recipient
+            const double g = equilibrium_state;
+            double good = 0.0, bad = 0.0;
+            for (size_t i = 0; i < n; i++) {
+                const double h = images[i] = Image(g, q[i], p);
+                good += errors.donor_weight[i] * q[i] * (h * p[Engine::GG] + (1.0 - h) * p[Engine::BG]);
+                bad += errors.donor_weight[i] * q[i] * (h * p[Engine::GB] + (1.0 - h) * p[Engine::BB]);
+            }
+            to_good = good;
+            to_bad = bad;
+            resident_coop = g * to_good + (1.0 - g) * to_bad;
+        }
+
+        double calc_resident_payoff(double benefit, double cost) const { return (benefit - cost) * resident_coop; }
+
+        // Payoff of a rare invader with this action rule and error rates from the same
+        // distribution, averaged over them.
+        double calc_invader_payoff(const ActionRule& invader_strategy, double benefit, double cost) const {
+            return InvaderPayoff(invader_strategy.coop_probs, benefit, cost);
+        }
+
+        // Payoffs of the 16 deterministic invaders.
+        std::array<double, 16> calc_invader_payoffs(double benefit, double cost) const {
+            std::array<double, 16> payoffs;
+            for (int j = 0; j < 16; j++) {
+                payoffs[j] = InvaderPayoff(ActionRule::MakeDeterministicRule(j).coop_probs, benefit, cost);
+            }
+            return payoffs;
+        }
+
+        // As Game::calc_ess_margin.
+        double calc_ess_margin(double benefit, double cost, int* best = nullptr) const {
+            const double self_payoff = calc_resident_payoff(benefit, cost);
+            const auto payoffs = calc_invader_payoffs(benefit, cost);
+            double margin = 0.0;
+            bool first = true;
+            for (int i = 0; i < 16; i++) {
+                if (i == norm.action_rule.ID()) { continue; }
+                const double m = self_payoff - payoffs[i];
+                if (first || m < margin) {
+                    margin = m;
+                    if (best) { *best = i; }
+                    first = false;
+                }
+            }
+            return margin;
+        }
+
+        bool isESS(double benefit, double cost) const {
+            const double self_payoff = calc_resident_payoff(benefit, cost);
+            const auto payoffs = calc_invader_payoffs(benefit, cost);
+            for (int i = 0; i < 16; i++) {
+                if (i != norm.action_rule.ID() && payoffs[i] > self_payoff) { return false; }
+            }
+            return true;
+        }
+
+    private:
+        std::vector<double> q;               // 1 - mu_e at the donor nodes
+        std::array<double, 4> rs_c, rs_d;    // RS_k = rs_d[k] + rs_c[k] * (cooperation probability)
+        double to_good = 0.0, to_bad = 0.0;  // cooperation of residents with a good / bad recipient
+
+        // h(mu) of a donor cooperating with probability p[k] q; den >= a, so the clamp only
+        // turns 0 / 0 into 0, as in PolymorphicGame::calc_type_image.
+        double Image(double g, double q_i, const std::array<double, 4>& p) const {
+            const double bb = rs_d[0] + rs_c[0] * p[0] * q_i, bg = rs_d[1] + rs_c[1] * p[1] * q_i;
+            const double gb = rs_d[2] + rs_c[2] * p[2] * q_i, gg = rs_d[3] + rs_c[3] * p[3] * q_i;
+            const double a = g * bg + (1.0 - g) * bb, c = g * gg + (1.0 - g) * gb;
+            return a / std::max(1.0 - c + a, std::numeric_limits<double>::min());
+        }
+
+        // Root of F(g) = E[h(mu)] - g by Newton steps, safeguarded by bisection within the
+        // bracket [0, 1] (F(0) >= 0 >= F(1)); see PolymorphicGame::calc_equilibrium_state.
+        double Solve(double g, double tolerance) {
+            const auto& p = norm.action_rule.coop_probs;
+            const size_t n = q.size();
+            const double* w = errors.donor_weight.data();
+            double lo = 0.0, hi = 1.0;
+            if (!(g >= 0.0 && g <= 1.0)) { g = 0.5; }
+            for (iterations = 1; iterations <= 100; iterations++) {
+                double f = -g, df = -1.0;
+                for (size_t i = 0; i < n; i++) {
+                    const double bb = rs_d[0] + rs_c[0] * p[0] * q[i], bg = rs_d[1] + rs_c[1] * p[1] * q[i];
+                    const double gb = rs_d[2] + rs_c[2] * p[2] * q[i], gg = rs_d[3] + rs_c[3] * p[3] * q[i];
+                    const double a = g * bg + (1.0 - g) * bb, c = g * gg + (1.0 - g) * gb;
+                    const double den = std::max(1.0 - c + a, std::numeric_limits<double>::min());
+                    f += w[i] * (a / den);
+                    df += w[i] * (((bg - bb) * (1.0 - c) + a * (gg - gb)) / (den * den));
+                }
+                if (f == 0.0) { break; }
+                if (f > 0.0) { lo = g; } else { hi = g; }
+                if (df < 0.0 && std::abs(f / df) < tolerance) {
+                    g = std::min(std::max(g - f / df, 0.0), 1.0);
+                    break;
+                }
+                double next = (df < 0.0) ? g - f / df : -1.0;
+                if (!(next > lo && next < hi)) { next = 0.5 * (lo + hi); }
+                g = next;
+                if (hi - lo < tolerance) { break; }
+            }
+            return g;
+        }
+
+        // E over the donor nodes of b res_to_mut - c mut_to_res for an invader cooperating
+        // with probabilities p (GameEngine::Invader with g as the residents' image).
+        double InvaderPayoff(const std::array<double, 4>& p, double benefit, double cost) const {
+            const double g = equilibrium_state;
+            const size_t n = q.size();
+            const double* w = errors.donor_weight.data();
+            double payoff = 0.0;
+            for (size_t i = 0; i < n; i++) {
+                const double a_bb = p[0] * q[i], a_bg = p[1] * q[i], a_gb = p[2] * q[i], a_gg = p[3] * q[i];
+                const double bb = rs_d[0] + rs_c[0] * a_bb, bg = rs_d[1] + rs_c[1] * a_bg;
+                const double gb = rs_d[2] + rs_c[2] * a_gb, gg = rs_d[3] + rs_c[3] * a_gg;
+                const double a = g * bg + (1.0 - g) * bb, c = g * gg + (1.0 - g) * gb;
+                const double H = a / std::max(1.0 - c + a, std::numeric_limits<double>::min());
+                const double mut_to_res = g * H * a_gg + (1.0 - g) * H * a_gb + g * (1.0 - H) * a_bg
+                                        + (1.0 - g) * (1.0 - H) * a_bb;
+                const double res_to_mut = H * to_good + (1.0 - H) * to_bad;
+                payoff += w[i] * (benefit * res_to_mut - cost * mut_to_res);
+            }
+            return payoff;
+        }
+};
+
+}  // namespace two_action
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef IncrementalEvaluator_H
+#define IncrementalEvaluator_H
+
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "SweepEngine.hpp"
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+
+namespace two_action {
+
+// A set of norms evaluated at one parameter point (assessment_error, perception_error,
+// mu_e, benefit, cost) that is changed one input at a time. Each norm's quantities form
+// a small dependency graph:
+//     Assessment (R)               <- assessment_error, perception_error
+//     Actions (S)                  <- mu_e
+//     State (h, cooperation,
+//            invader statistics)   <- Assessment, Actions
+//     Payoff (margin, verdict)     <- State, benefit, cost
+// A setter marks the nodes downstream of its input stale in every norm, a changed norm
+// marks its own nodes, and Update recomputes the stale nodes only. Moving benefit or
+// cost costs two multiplications per invader; the error rates need the games again.
+// Every quantity is computed as in Game, so the results equal those of Game.
+class IncrementalEvaluator {
+    public:
+        enum Node { Assessment = 0, Actions = 1, State = 2, Payoff = 3, NumNodes = 4 };
+
+        // norms recomputed per node by the last Update
+        using Counts = std::array<size_t, NumNodes>;
+
+        IncrementalEvaluator(double assessment_error, double perception_error, double mu_e, double benefit,
+                             double cost, unsigned num_threads = 0)
+            : assessment_error(assessment_error), perception_error(perception_error), mu_e(mu_e),
+              benefit(benefit), cost(cost), num_threads(num_threads) {}
+
+        IncrementalEvaluator(const std::vector<Norm>& norms, double assessment_error, double perception_error,
+                             double mu_e, double benefit, double cost, unsigned num_threads = 0)
+            : IncrementalEvaluator(assessment_error, perception_error, mu_e, benefit, cost, num_threads) {
+            Reserve(norms.size());
+            for (const auto& norm : norms) { AddNorm(norm); }
+        }
+
+        size_t Size() const { return norms.size(); }
+        const Norm& GetNorm(size_t i) const { return norms.at(i); }
+
+        size_t AddNorm(const Norm& norm) {
+            norms.push_back(norm);
+            R.emplace_back();
+            S.emplace_back();
+            h.push_back(0.0);
+            coop.push_back(0.0);
+            res_to_mut.emplace_back();
+            mut_to_res.emplace_back();
+            margin.push_back(0.0);
+            best.push_back(-1);
+            ess.push_back(0);
+            stale.push_back(All);
+            dirty = true;
+            return norms.size() - 1;
+        }
+
+        void SetNorm(size_t i, const Norm& norm) {
+            norms.at(i) = norm;
+            Invalidate(i, All);
+        }
+
+        // Setting an input to its current value invalidates nothing.
+        void SetAssessmentError(double x) { Set(assessment_error, x, Bit(Assessment) | Bit(State) | Bit(Payoff)); }
+        void SetPerceptionError(double x) { Set(perception_error, x, Bit(Assessment) | Bit(State) | Bit(Payoff)); }
+        void SetMuE(double x) {
+            invaders_stale = invaders_stale || x != mu_e;
+            Set(mu_e, x, Bit(Actions) | Bit(State) | Bit(Payoff));
+        }
+        void SetBenefit(double x) { Set(benefit, x, Bit(Payoff)); }
+        void SetCost(double x) { Set(cost, x, Bit(Payoff)); }
+
+        double GetAssessmentError() const { return assessment_error; }
+        double GetPerceptionError() const { return perception_error; }
+        double GetMuE() const { return mu_e; }
+        double GetBenefit() const { return benefit; }
+        double GetCost() const { return cost; }
+
+        // Recomputes the stale nodes of all norms, in the order of the graph.
+        Counts Update() {
+            Counts counts{};
+            if (!dirty) { return counts; }
+            if (invaders_stale) {
+                // the invaders' action tables are shared by all norms
+                for (int j = 0; j < 16; j++) { invaders[j] = Game::ToTable(ActionRule::MakeDeterministicRule(j), mu_e); }
+                invaders_stale = false;
+            }
+            std::vector<size_t> work;
+            for (size_t i = 0; i < stale.size(); i++) {
+                if (stale[i] == 0) { continue; }
+                work.push_back(i);
+                for (int node = 0; node < NumNodes; node++) { counts[node] += (stale[i] >> node) & 1; }
+            }
+            ParallelFor(work.size(), [&](size_t begin, size_t end, unsigned) {
+                for (size_t k = begin; k < end; k++) { Recompute(work[k]); }
+            }, num_threads);
+            dirty = false;
+            return counts;
+        }
+
+        // The results bring the norms up to date first.
+        double EquilibriumState(size_t i) { Update(); return h.at(i); }
+        double ResidentCoop(size_t i) { Update(); return coop.at(i); }
+        // Game::calc_ess_margin and its best invader, and Game::isESS
+        double EssMargin(size_t i) { Update(); return margin.at(i); }
+        int BestInvader(size_t i) { Update(); return best.at(i); }
+        bool IsESS(size_t i) { Update(); return ess.at(i) != 0; }
+
+        // Game::calc_invader_payoff for the deterministic invader j (0 for the norm's own
+        // action rule, which is not an invader).
+        double InvaderPayoff(size_t i, int j) {
+            Update();
+            return benefit * res_to_mut.at(i).at(j) - cost * mut_to_res.at(i).at(j);
+        }
+
+        std::vector<size_t> ESSNorms() {
+            Update();
+            std::vector<size_t> out;
+            for (size_t i = 0; i < ess.size(); i++) { if (ess[i]) { out.push_back(i); } }
+            return out;
+        }
+
+    private:
+        static constexpr uint8_t All = (1 << NumNodes) - 1;
+        static constexpr uint8_t Bit(Node node) { return static_cast<uint8_t>(1 << node); }
+
+        double assessment_error, perception_error, mu_e, benefit, cost;
+        unsigned num_threads;
+
+        std::vector<Norm> norms;
+        std::vector<Game::Engine::AssessmentTable> R;
+        std::vector<Game::Engine::ActionTable> S;
+        std::vector<double> h, coop;
+        std::vector<std::array<double, 16>> res_to_mut, mut_to_res;
+        std::vector<double> margin;
+        std::vector<int> best;
+        std::vector<uint8_t> ess;
+        std::array<Game::Engine::ActionTable, 16> invaders;   // depend on mu_e only
+        std::vector<uint8_t> stale;   // bit per Node
+        bool dirty = false, invaders_stale = true;
+
+        void Reserve(size_t n) {
+            norms.reserve(n); R.reserve(n); S.reserve(n); h.reserve(n); coop.reserve(n);
+            res_to_mut.reserve(n); mut_to_res.reserve(n);
+            margin.reserve(n); best.reserve(n); ess.reserve(n); stale.reserve(n);
+        }
+
+        void Set(double& input, double x, uint8_t nodes) {
+            if (x == input) { return; }
+            input = x;
+            for (auto& s : stale) { s |= nodes; }
+            dirty = dirty || !stale.empty();
+        }
+
+        void Invalidate(size_t i, uint8_t nodes) {
+            stale.at(i) |= nodes;
+            dirty = true;
+        }
+
+        void Recompute(size_t i) {
+            const uint8_t nodes = stale[i];
+            const Norm& norm = norms[i];
+            const int skip = norm.action_rule.ID();
+            if (nodes & Bit(Assessment)) {
+                R[i] = Game::RescaleAssessment(norm.assessment_rule, assessment_error, perception_error);
+            }
+            if (nodes & Bit(Actions)) { S[i] = Game::ToTable(norm.action_rule, mu_e); }
+            if (nodes & Bit(State)) {
+                // the engine and invader tables of Game, whose statistics do not involve b and c
+                Game::Engine engine(R[i], S[i]);
+                h[i] = engine.h;
+                coop[i] = engine.resident_actions[Game::Engine::C];
+                for (int j = 0; j < 16; j++) {
+                    if (j == skip) { res_to_mut[i][j] = mut_to_res[i][j] = 0.0; continue; }
+                    auto st = engine.Invader(invaders[j]);
+                    res_to_mut[i][j] = st.res_to_mut[Game::Engine::C];
+                    mut_to_res[i][j] = st.mut_to_res[Game::Engine::C];
+                }
+            }
+            if (nodes & Bit(Payoff)) {
+                // Game::calc_ess_margin and Game::isESS over the stored statistics
+                const double self_payoff = (benefit - cost) * coop[i];
+                double m_min = 0.0;
+                int arg = -1;
+                bool is_ess = true;
+                for (int j = 0; j < 16; j++) {
+                    if (j == skip) { continue; }
+                    const double payoff = benefit * res_to_mut[i][j] - cost * mut_to_res[i][j];
+                    const double m = self_payoff - payoff;
+                    if (arg < 0 || m < m_min) { m_min = m; arg = j; }
+                    if (payoff > self_payoff) { is_ess = false; }
+                }
+                margin[i] = m_min;
+                best[i] = arg;
+                ess[i] = is_ess;
+            }
+            stale[i] = 0;
+        }
+};
+
+}  // namespace two_action
+
+#endif
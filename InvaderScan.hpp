@@ -0,0 +1,161 @@
+#ifndef InvaderScan_H
+#define InvaderScan_H
+
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "SweepEngine.hpp"
+#include "QuasiRandom.hpp"
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+
+namespace two_action {
+
+// Payoff landscape of rare stochastic invaders over the cube of action rules
+// (p_BB, p_BG, p_GB, p_GG) in [0, 1]^4. isESS only looks at the 16 corners of the
+// cube; the scan evaluates dense grids or Sobol samples of the whole cube.
+class InvaderScan {
+    public:
+        static constexpr size_t BatchSize = 256;
+
+        struct Result {
+            double max_advantage;     // largest invader payoff minus resident payoff
+            ActionRule argmax;        // invader attaining it
+            long num_points;
+            long num_positive;        // invaders earning more than `tolerance` above the residents
+        };
+
+        // Maximal advantage and number of winning invaders of a set of points.
+        class Sink {
+            public:
+                ExtremumSink advantage;
+                long positive = 0;
+
+                void Merge(const Sink& other) {
+                    advantage.Merge(other.advantage);
+                    positive += other.positive;
+                }
+        };
+
+        InvaderScan(const Game& game, double benefit, double cost)
+            : h(game.equilibrium_state), q(1.0 - game.mu_e), benefit(benefit), cost(cost),
+              self_payoff(game.calc_resident_payoff(benefit, cost)) {
+            const auto& engine = game.engine;
+            for (int k = 0; k < 4; k++) {
+                r_d[k] = engine.R[k * 2 + Game::Engine::D];
+                r_c[k] = engine.R[k * 2 + Game::Engine::C];
+                s[k] = engine.S[k][Game::Engine::C];
+            }
+            // cooperation of the residents towards an invader of image H is a + (b - a) H
+            res_bad = h * s[Game::Engine::GB] + (1.0 - h) * s[Game::Engine::BB];
+            res_good = h * s[Game::Engine::GG] + (1.0 - h) * s[Game::Engine::BG];
+        }
+
+        // Advantage of the invaders (p[0][i], p[1][i], p[2][i], p[3][i]), i < n, in
+        // structure-of-arrays form. The loop has no branches or calls so that the compiler
+        // vectorizes it; it follows GameEngine::Invader up to rounding.
+        void Evaluate(size_t n, const double* const* p, double* advantage) const {
+            const double* __restrict p_bb = p[0];
+            const double* __restrict p_bg = p[1];
+            const double* __restrict p_gb = p[2];
+            const double* __restrict p_gg = p[3];
+            double* __restrict out = advantage;
+            const double hg = h, hb = 1.0 - h;
+            for (size_t i = 0; i < n; i++) {
+                const double a_bb = q * p_bb[i], a_bg = q * p_bg[i], a_gb = q * p_gb[i], a_gg = q * p_gg[i];
+                const double rs_bb = r_c[0] * a_bb + r_d[0] * (1.0 - a_bb);
+                const double rs_bg = r_c[1] * a_bg + r_d[1] * (1.0 - a_bg);
+                const double rs_gb = r_c[2] * a_gb + r_d[2] * (1.0 - a_gb);
+                const double rs_gg = r_c[3] * a_gg + r_d[3] * (1.0 - a_gg);
+                const double H = (hg * rs_bg + hb * rs_bb) / (1.0 - hg * rs_gg + hg * rs_bg - hb * rs_gb + hb * rs_bb);
+                const double mut_to_res = H * (hg * a_gg + hb * a_gb) + (1.0 - H) * (hg * a_bg + hb * a_bb);
+                const double res_to_mut = res_bad + (res_good - res_bad) * H;
+                out[i] = benefit * res_to_mut - cost * mut_to_res - self_payoff;
+            }
+        }
+
+        double Advantage(const ActionRule& invader) const {
+            double x[4][1];
+            for (int k = 0; k < 4; k++) { x[k][0] = invader.coop_probs[k]; }
+            const double* p[4] = {x[0], x[1], x[2], x[3]};
+            double a;
+            Evaluate(1, p, &a);
+            return a;
+        }
+
+        // Regular grid with `per_axis` points on each axis, corners included.
+        Result ScanGrid(size_t per_axis, unsigned num_threads = 0, double tolerance = 1e-12) const {
+            if (per_axis < 2) { throw std::runtime_error("InvaderScan: need at least two grid points per axis"); }
+            const uint64_t total = static_cast<uint64_t>(per_axis) * per_axis * per_axis * per_axis;
+            auto point = [per_axis](uint64_t index, double* x) {
+                for (int k = 0; k < 4; k++) {
+                    x[k] = static_cast<double>(index % per_axis) / (per_axis - 1);
+                    index /= per_axis;
+                }
+            };
+            return Scan(total, [&](uint64_t first, size_t count, double* const* out) {
+                double x[4];
+                for (size_t i = 0; i < count; i++) {
+                    point(first + i, x);
+                    for (int k = 0; k < 4; k++) { out[k][i] = x[k]; }
+                }
+            }, point, num_threads, tolerance);
+        }
+
+        // The first `num_points` (at most 2^32) points of the four-dimensional Sobol sequence.
+        Result ScanSobol(uint64_t num_points, unsigned num_threads = 0, double tolerance = 1e-12) const {
+            if (num_points > SobolSequence::MaxPoints) {
+                throw std::runtime_error("InvaderScan: the Sobol sequence has at most 2^32 points");
+            }
+            SobolSequence sobol(4);
+            return Scan(num_points, [&](uint64_t first, size_t count, double* const* out) {
+                sobol.Fill(first, count, out);
+            }, [&](uint64_t index, double* x) { sobol.Point(index, x); }, num_threads, tolerance);
+        }
+
+    private:
+        double h, q, benefit, cost, self_payoff;
+        std::array<double, 4> r_d, r_c, s;
+        double res_bad, res_good;
+
+        // fill(first, count, out) writes points [first, first + count) in structure-of-arrays
+        // form and point(index, x) a single one to recover the argmax. Batches are
+        // distributed over threads by ParallelReduce.
+        template <typename Fill, typename Point>
+        Result Scan(uint64_t total, Fill&& fill, Point&& point, unsigned num_threads, double tolerance) const {
+            if (total == 0) { throw std::runtime_error("InvaderScan: need at least one point"); }
+            const size_t num_batches = (total + BatchSize - 1) / BatchSize;
+            Sink sink = ParallelReduce(num_batches, Sink(), [&](size_t b, Sink& partial) {
+                alignas(64) double buffer[4][BatchSize];
+                alignas(64) double advantage[BatchSize];
+                double* const p[4] = {buffer[0], buffer[1], buffer[2], buffer[3]};
+                const uint64_t first = static_cast<uint64_t>(b) * BatchSize;
+                const size_t count = static_cast<size_t>(std::min<uint64_t>(BatchSize, total - first));
+                if (count == 0) { return; }
+                fill(first, count, p);
+                Evaluate(count, p, advantage);
+                size_t best = 0;
+                double best_advantage = advantage[0];
+                for (size_t i = 0; i < count; i++) {
+                    if (advantage[i] > best_advantage) { best = i; best_advantage = advantage[i]; }
+                    partial.positive += advantage[i] > tolerance;
+                }
+                // the batch maximum stands for the batch; the count is that of the points
+                partial.advantage.Add(best_advantage, static_cast<long>(first + best));
+                partial.advantage.count += count - 1;
+            }, num_threads);
+
+            Result result{sink.advantage.max, ActionRule({0.0, 0.0, 0.0, 0.0}), sink.advantage.count, sink.positive};
+            double x[4];
+            point(static_cast<uint64_t>(sink.advantage.argmax), x);
+            result.argmax = ActionRule({x[0], x[1], x[2], x[3]});
+            return result;
+        }
+};
+
+}  // namespace two_action
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef InvasionGraph_H
+#define InvasionGraph_H
+
+#include "SweepEngine.hpp"
+#include "InvasionMatrix.hpp"
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+#include <cstdint>
+
+
+// Directed "can invade" graph over deterministic norms in CSR form. There is an
+// edge r -> v when norm v earns more than the resident r in a population of r,
+// so sink components of the condensation are the sets of norms that no outside
+// norm can invade.
+class InvasionGraph {
+    public:
+        // trimming stops once a round removes less than 1/MinTrimShare of the remaining nodes
+        static constexpr size_t MinTrimShare = 20;
+
+        std::vector<int64_t> node_ids;    // norm ID of each node
+        std::vector<uint64_t> offsets;    // size num_nodes + 1
+        std::vector<uint32_t> targets;    // node indices
+
+        size_t NumNodes() const { return node_ids.size(); }
+        size_t NumEdges() const { return targets.size(); }
+        size_t OutDegree(size_t v) const { return offsets[v + 1] - offsets[v]; }
+
+        // Builds the graph from an invasion matrix. With action-rule columns the invader of
+        // resident r is the norm with r's assessment rule and the column's action rule.
+        static InvasionGraph FromMatrix(const InvasionMatrix& m, double threshold = 0.0, unsigned num_threads = 0) {
+            InvasionGraph g;
+            const size_t rows = m.Rows(), cols = m.Cols();
+            g.node_ids.resize(rows);
+            // norm IDs are below 2^20, so a dense table maps them to node indices
+            int64_t max_id = 0;
+            for (size_t r = 0; r < rows; r++) { max_id = std::max(max_id, m.RowID(r)); }
+            for (size_t c = 0; c < cols; c++) { max_id = std::max(max_id, m.ColID(c)); }
+            std::vector<int64_t> index(max_id + 1, -1);
+            for (size_t r = 0; r < rows; r++) {
+                g.node_ids[r] = m.RowID(r);
+                index[m.RowID(r)] = static_cast<int64_t>(r);
+            }
+
+            const bool full_norm = m.Header().full_norm_invaders;
+            const int action_bits = (m.Header().num_actions == 2) ? 4 : 7;
+            // target node of column c for resident r, or -1 when the invader is not a node
+            auto target = [&](size_t r, size_t c) -> int64_t {
+                int64_t id = full_norm ? m.ColID(c)
+                                       : ((m.RowID(r) >> action_bits) << action_bits) | m.ColID(c);
+                int64_t t = (id <= max_id) ? index[id] : -1;
+                return (t == static_cast<int64_t>(r)) ? -1 : t;
+            };
+
+            // count, prefix sum, fill: both passes run over independent rows
+            std::vector<uint64_t> degree(rows, 0);
+            ParallelFor(rows, [&](size_t begin, size_t end, unsigned) {
+                for (size_t r = begin; r < end; r++) {
+                    const double* row = m.Row(r);
+                    uint64_t d = 0;
+                    for (size_t c = 0; c < cols; c++) {
+                        if (row[c] > threshold && target(r, c) >= 0) { d++; }
+                    }
+                    degree[r] = d;
+                }
+            }, num_threads);
+            g.offsets.assign(rows + 1, 0);
+            for (size_t r = 0; r < rows; r++) { g.offsets[r + 1] = g.offsets[r] + degree[r]; }
+            g.targets.resize(g.offsets[rows]);
+            ParallelFor(rows, [&](size_t begin, size_t end, unsigned) {
+                for (size_t r = begin; r < end; r++) {
+                    const double* row = m.Row(r);
+                    uint64_t k = g.offsets[r];
+                    for (size_t c = 0; c < cols; c++) {
+                        if (row[c] <= threshold) { continue; }
+                        int64_t t = target(r, c);
+                        if (t >= 0) { g.targets[k++] = static_cast<uint32_t>(t); }
+                    }
+                }
+            }, num_threads);
+            return g;
+        }
+
+        static InvasionGraph FromEdges(const std::vector<int64_t>& node_ids,
+                                       const std::vector<std::pair<uint32_t, uint32_t>>& edges) {
+            InvasionGraph g;
+            g.node_ids = node_ids;
+            g.offsets.assign(node_ids.size() + 1, 0);
+            for (const auto& e : edges) { g.offsets[e.first + 1]++; }
+            for (size_t v = 0; v < node_ids.size(); v++) { g.offsets[v + 1] += g.offsets[v]; }
+            g.targets.resize(edges.size());
+            std::vector<uint64_t> fill(g.offsets.begin(), g.offsets.end() - 1);
+            for (const auto& e : edges) { g.targets[fill[e.first]++] = e.second; }
+            return g;
+        }
+
+        // Component index of every node. Nodes without incoming or outgoing edges among
+        // the remaining nodes are peeled off in parallel rounds first (trimming) as long as a
+        // round removes a sizeable share of them; the rest is decomposed with an iterative
+        // Tarjan search.
+        std::vector<uint32_t> StronglyConnectedComponents(unsigned num_threads = 0) const {
+            const size_t n = NumNodes();
+            const uint32_t unassigned = UINT32_MAX;
+            std::vector<uint32_t> component(n, unassigned);
+
+            // trimming
+            std::vector<uint8_t> alive(n, 1);
+            std::vector<uint32_t> trimmed_order;
+            std::vector<std::atomic<uint32_t>> in_degree(n);
+            std::vector<uint32_t> out_degree(n);
+            while (true) {
+                for (auto& d : in_degree) { d.store(0, std::memory_order_relaxed); }
+                ParallelFor(n, [&](size_t begin, size_t end, unsigned) {
+                    for (size_t v = begin; v < end; v++) {
+                        out_degree[v] = 0;
+                        if (!alive[v]) { continue; }
+                        for (uint64_t k = offsets[v]; k < offsets[v + 1]; k++) {
+                            uint32_t w = targets[k];
+                            if (alive[w] && w != v) {
+                                out_degree[v]++;
+                                in_degree[w].fetch_add(1, std::memory_order_relaxed);
+                            }
+                        }
+                    }
+                }, num_threads);
+                size_t before = trimmed_order.size();
+                for (size_t v = 0; v < n; v++) {
+                    if (alive[v] && (out_degree[v] == 0 || in_degree[v].load(std::memory_order_relaxed) == 0)) {
+                        trimmed_order.push_back(static_cast<uint32_t>(v));
+                    }
+                }
+                for (size_t i = before; i < trimmed_order.size(); i++) { alive[trimmed_order[i]] = 0; }
+                size_t removed = trimmed_order.size() - before;
+                if (removed == 0 || removed * MinTrimShare < n - before) { break; }
+            }
+
+            // Tarjan on the remaining nodes
+            uint32_t next_component = 0;
+            std::vector<uint32_t> index(n, unassigned), lowlink(n, 0);
+            std::vector<uint8_t> on_stack(n, 0);
+            std::vector<uint32_t> stack;
+            std::vector<std::pair<uint32_t, uint64_t>> call_stack;   // (node, next edge)
+            uint32_t next_index = 0;
+            std::vector<uint32_t> tarjan_component(n, unassigned);
+            for (uint32_t root = 0; root < n; root++) {
+                if (!alive[root] || index[root] != unassigned) { continue; }
+                call_stack.push_back({root, offsets[root]});
+                index[root] = lowlink[root] = next_index++;
+                stack.push_back(root);
+                on_stack[root] = 1;
+                while (!call_stack.empty()) {
+                    auto& [v, k] = call_stack.back();
+                    if (k < offsets[v + 1]) {
+                        uint32_t w = targets[k++];
+                        if (!alive[w]) { continue; }
+                        if (index[w] == unassigned) {
+                            index[w] = lowlink[w] = next_index++;
+                            stack.push_back(w);
+                            on_stack[w] = 1;
+                            call_stack.push_back({w, offsets[w]});
+                        } else if (on_stack[w]) {
+                            lowlink[v] = std::min(lowlink[v], index[w]);
+                        }
+                        continue;
+                    }
+                    uint32_t done = v;
+                    call_stack.pop_back();
+                    if (!call_stack.empty()) {
+                        uint32_t parent = call_stack.back().first;
+                        lowlink[parent] = std::min(lowlink[parent], lowlink[done]);
+                    }
+                    if (lowlink[done] == index[done]) {
+                        uint32_t w;
+                        do {
+                            w = stack.back();
+                            stack.pop_back();
+                            on_stack[w] = 0;
+                            tarjan_component[w] = next_component;
+                        } while (w != done);
+                        next_component++;
+                    }
+                }
+            }
+
+            // trimmed nodes are singletons, numbered before the Tarjan components
+            uint32_t c = 0;
+            for (uint32_t v : trimmed_order) { component[v] = c++; }
+            for (size_t v = 0; v < n; v++) {
+                if (tarjan_component[v] != unassigned) { component[v] = c + tarjan_component[v]; }
+            }
+            return component;
+        }
+
+        // Per component: number of members and whether any edge leaves it. Components
+        // without leaving edges are absorbing: no outside norm can invade them.
+        void SummarizeComponents(const std::vector<uint32_t>& component,
+                                 std::vector<uint64_t>& sizes, std::vector<uint8_t>& absorbing) const {
+            uint32_t n_components = 0;
+            for (uint32_t c : component) { n_components = std::max(n_components, c + 1); }
+            sizes.assign(n_components, 0);
+            absorbing.assign(n_components, 1);
+            for (size_t v = 0; v < NumNodes(); v++) {
+                sizes[component[v]]++;
+                for (uint64_t k = offsets[v]; k < offsets[v + 1]; k++) {
+                    if (component[targets[k]] != component[v]) { absorbing[component[v]] = 0; }
+                }
+            }
+        }
+
+        // Writes offsets, targets and node IDs as raw little-endian arrays preceded by their sizes.
+        void WriteCSR(const std::string& filename) const {
+            std::ofstream file(filename, std::ios::binary);
+            if (!file.is_open()) { throw std::runtime_error("InvasionGraph: cannot open " + filename); }
+            uint64_t n = NumNodes(), m = NumEdges();
+            file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+            file.write(reinterpret_cast<const char*>(&m), sizeof(m));
+            file.write(reinterpret_cast<const char*>(node_ids.data()), n * sizeof(int64_t));
+            file.write(reinterpret_cast<const char*>(offsets.data()), (n + 1) * sizeof(uint64_t));
+            file.write(reinterpret_cast<const char*>(targets.data()), m * sizeof(uint32_t));
+        }
+
+};
+
+#endif
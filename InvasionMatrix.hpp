@@ -0,0 +1,173 @@
+#ifndef InvasionMatrix_H
+#define InvasionMatrix_H
+
+#include "SweepEngine.hpp"
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+// On-disk resident x invader matrix of invasion fitness, i.e. the invader's payoff
+// minus the resident's payoff. The file is a fixed header followed by the row
+// (resident norm) IDs, the column (invader) IDs, the resident payoffs and the
+// row-major matrix, each section aligned to 64 bytes so it can be mmap-ed and
+// read in place.
+struct InvasionMatrixHeader {
+    char magic[8] = {'I', 'N', 'V', 'M', 'A', 'T', 'X', '\0'};
+    uint32_t version = 1;
+    uint32_t num_actions = 2;        // 2 for Norms.hpp, 3 for NormsWithPunishment.hpp
+    uint32_t full_norm_invaders = 0; // 0: columns are action-rule IDs, 1: columns are norm IDs
+    uint32_t reserved = 0;
+    uint64_t rows = 0;
+    uint64_t cols = 0;
+    double assessment_error = 0.0;
+    double perception_error = 0.0;
+    double mu_e = 0.0;
+    double benefit = 0.0;
+    double cost = 0.0;
+    double punishment = 0.0;
+    double punishment_cost = 0.0;
+};
+
+namespace invasion_matrix_detail {
+    inline uint64_t Align(uint64_t offset) { return (offset + 63) / 64 * 64; }
+
+    struct Layout {
+        uint64_t row_ids, col_ids, resident_payoffs, data, size;
+
+        explicit Layout(const InvasionMatrixHeader& h) {
+            row_ids = Align(sizeof(InvasionMatrixHeader));
+            col_ids = Align(row_ids + h.rows * sizeof(int64_t));
+            resident_payoffs = Align(col_ids + h.cols * sizeof(int64_t));
+            data = Align(resident_payoffs + h.rows * sizeof(double));
+            size = data + h.rows * h.cols * sizeof(double);
+        }
+    };
+}
+
+// Read-only view of an invasion matrix file.
+class InvasionMatrix {
+    public:
+        explicit InvasionMatrix(const std::string& filename) {
+            int fd = open(filename.c_str(), O_RDONLY);
+            if (fd < 0) { throw std::runtime_error("InvasionMatrix: cannot open " + filename); }
+            struct stat st;
+            fstat(fd, &st);
+            size = static_cast<size_t>(st.st_size);
+            if (size < sizeof(InvasionMatrixHeader)) {
+                close(fd);
+                throw std::runtime_error("InvasionMatrix: " + filename + " is too small");
+            }
+            void* p = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if (p == MAP_FAILED) { throw std::runtime_error("InvasionMatrix: cannot map " + filename); }
+            base = static_cast<const char*>(p);
+            std::memcpy(&header, base, sizeof(header));
+            InvasionMatrixHeader expected;
+            invasion_matrix_detail::Layout layout(header);
+            if (std::memcmp(header.magic, expected.magic, sizeof(expected.magic)) != 0 ||
+                header.version != expected.version || layout.size != size) {
+                munmap(const_cast<char*>(base), size);
+                throw std::runtime_error("InvasionMatrix: " + filename + " is not a valid invasion matrix");
+            }
+            row_ids = reinterpret_cast<const int64_t*>(base + layout.row_ids);
+            col_ids = reinterpret_cast<const int64_t*>(base + layout.col_ids);
+            resident_payoffs = reinterpret_cast<const double*>(base + layout.resident_payoffs);
+            data = reinterpret_cast<const double*>(base + layout.data);
+        }
+
+        InvasionMatrix(const InvasionMatrix&) = delete;
+        InvasionMatrix& operator=(const InvasionMatrix&) = delete;
+
+        ~InvasionMatrix() { munmap(const_cast<char*>(base), size); }
+
+        const InvasionMatrixHeader& Header() const { return header; }
+        size_t Rows() const { return header.rows; }
+        size_t Cols() const { return header.cols; }
+        int64_t RowID(size_t r) const { return row_ids[r]; }
+        int64_t ColID(size_t c) const { return col_ids[c]; }
+        double ResidentPayoff(size_t r) const { return resident_payoffs[r]; }
+
+        // Invader payoff minus resident payoff; positive means the invader can invade.
+        double Delta(size_t r, size_t c) const { return data[r * header.cols + c]; }
+        const double* Row(size_t r) const { return data + r * header.cols; }
+
+    private:
+        InvasionMatrixHeader header;
+        const char* base = nullptr;
+        size_t size = 0;
+        const int64_t* row_ids = nullptr;
+        const int64_t* col_ids = nullptr;
+        const double* resident_payoffs = nullptr;
+        const double* data = nullptr;
+};
+
+// Writes an invasion matrix file. prepare(r) returns the resident payoff of row r
+// and whatever per-resident data `entry` needs; entry(row_data, c) returns the
+// matrix element of column c. Rows are processed in blocks of tile_rows so the
+// per-resident data stays in cache while the columns are swept in tiles of tile_cols.
+template <typename PrepareRow, typename Entry>
+void BuildInvasionMatrix(const std::string& filename, InvasionMatrixHeader header,
+                         const std::vector<int64_t>& row_ids, const std::vector<int64_t>& col_ids,
+                         PrepareRow prepare, Entry entry,
+                         size_t tile_rows = 64, size_t tile_cols = 1024, unsigned num_threads = 0) {
+    header.rows = row_ids.size();
+    header.cols = col_ids.size();
+    invasion_matrix_detail::Layout layout(header);
+
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) { throw std::runtime_error("BuildInvasionMatrix: cannot open " + filename); }
+    if (ftruncate(fd, static_cast<off_t>(layout.size)) != 0) {
+        close(fd);
+        throw std::runtime_error("BuildInvasionMatrix: cannot resize " + filename);
+    }
+    void* p = mmap(nullptr, layout.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) { throw std::runtime_error("BuildInvasionMatrix: cannot map " + filename); }
+    char* base = static_cast<char*>(p);
+
+    std::memcpy(base, &header, sizeof(header));
+    std::memcpy(base + layout.row_ids, row_ids.data(), row_ids.size() * sizeof(int64_t));
+    std::memcpy(base + layout.col_ids, col_ids.data(), col_ids.size() * sizeof(int64_t));
+    double* resident_payoffs = reinterpret_cast<double*>(base + layout.resident_payoffs);
+    double* data = reinterpret_cast<double*>(base + layout.data);
+
+    const size_t rows = header.rows, cols = header.cols;
+    const size_t n_blocks = (rows + tile_rows - 1) / tile_rows;
+    ParallelFor(n_blocks, [&](size_t block_begin, size_t block_end, unsigned) {
+        using RowData = decltype(prepare(size_t(0)).second);
+        std::vector<RowData> block;
+        for (size_t b = block_begin; b < block_end; b++) {
+            size_t r0 = b * tile_rows, r1 = std::min(rows, r0 + tile_rows);
+            block.clear();
+            for (size_t r = r0; r < r1; r++) {
+                auto [payoff, row_data] = prepare(r);
+                resident_payoffs[r] = payoff;
+                block.push_back(std::move(row_data));
+            }
+            for (size_t c0 = 0; c0 < cols; c0 += tile_cols) {
+                size_t c1 = std::min(cols, c0 + tile_cols);
+                for (size_t r = r0; r < r1; r++) {
+                    double* out = data + r * cols;
+                    const RowData& row_data = block[r - r0];
+                    for (size_t c = c0; c < c1; c++) {
+                        out[c] = entry(row_data, c);
+                    }
+                }
+            }
+        }
+    }, num_threads);
+
+    msync(base, layout.size, MS_SYNC);
+    munmap(base, layout.size);
+}
+
+#endif
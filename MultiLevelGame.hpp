@@ -0,0 +1,533 @@
+#ifndef MultiLevelGame_H
+#define MultiLevelGame_H
+
+#include "Norms.hpp"
+#include "GameEngine.hpp"
+#include "SweepEngine.hpp"
+
+#include <vector>
+#include <array>
+#include <tuple>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+
+namespace two_action {
+
+// Two-action donation game with M graded reputations 0 (worst) ... M - 1 (best).
+// A norm gives the cooperation probability for each (donor level, recipient level)
+// and, for each (donor level, recipient level, action), a distribution over the level
+// the donor is assigned. With M = 2 this is the model of Game.hpp (0 = B, 1 = G).
+//
+// Errors follow Norms.hpp. With probability assessment_error the assigned level is
+// replaced by one of the other M - 1 levels at random, a defection is perceived as
+// cooperation with probability perception_error, and cooperation fails with
+// probability mu_e.
+template <int M>
+class MultiLevelNorm {
+    static_assert(M >= 2 && M <= 5, "MultiLevelNorm: between 2 and 5 reputation levels");
+
+    public:
+        static constexpr int NumLevels = M;
+        static constexpr int D = 0, C = 1;
+
+        std::array<double, M * M> coop_probs;            // [donor * M + recipient]
+        std::array<double, M * M * 2 * M> level_probs;   // [((donor * M + recipient) * 2 + action) * M + level]
+
+        MultiLevelNorm() : coop_probs{}, level_probs{} {}
+
+        double Coop(int donor, int recipient) const { return coop_probs[donor * M + recipient]; }
+        double Level(int donor, int recipient, int action, int level) const {
+            return level_probs[((donor * M + recipient) * 2 + action) * M + level];
+        }
+        void SetLevel(int donor, int recipient, int action, int level) {
+            for (int l = 0; l < M; l++) { level_probs[((donor * M + recipient) * 2 + action) * M + l] = (l == level); }
+        }
+
+        MultiLevelNorm RescaleWithError(double assessment_error, double perception_error, double mu_e) const {
+            MultiLevelNorm r = *this;
+            for (auto& p : r.coop_probs) { p *= (1.0 - mu_e); }
+            for (auto& p : r.level_probs) { p = (1.0 - assessment_error) * p + assessment_error * (1.0 - p) / (M - 1); }
+            for (int k = 0; k < M * M; k++) {
+                for (int l = 0; l < M; l++) {
+                    double& defect = r.level_probs[(k * 2 + D) * M + l];
+                    defect = (1.0 - perception_error) * defect + perception_error * r.level_probs[(k * 2 + C) * M + l];
+                }
+            }
+            return r;
+        }
+
+        // Levels in the upper half count as good when a binary rule is applied.
+        static bool IsGood(int level) { return level >= M / 2; }
+
+        // Graded version of a binary norm: the donor acts as the binary action rule
+        // prescribes for the good/bad classes of the two levels, and moves one level up
+        // after an action the binary assessment rule judges good and one level down
+        // otherwise. For M = 2 this is the binary norm itself.
+        static MultiLevelNorm Graded(const Norm& norm) {
+            MultiLevelNorm n;
+            for (int x = 0; x < M; x++) {
+                for (int y = 0; y < M; y++) {
+                    Reputation gx = IsGood(x) ? Reputation::G : Reputation::B;
+                    Reputation gy = IsGood(y) ? Reputation::G : Reputation::B;
+                    n.coop_probs[x * M + y] = norm.action_rule(gx, gy);
+                    for (int a = 0; a < 2; a++) {
+                        double good = norm.assessment_rule(gx, gy, a == C ? Action::C : Action::D);
+                        for (int l = 0; l < M; l++) {
+                            n.level_probs[((x * M + y) * 2 + a) * M + l] =
+                                good * (l == std::min(x + 1, M - 1)) + (1.0 - good) * (l == std::max(x - 1, 0));
+                        }
+                    }
+                }
+            }
+            return n;
+        }
+
+        // Action rule that depends only on the good/bad classes, from a binary ActionRule.
+        static std::array<double, M * M> GradedActionRule(const ActionRule& rule) {
+            std::array<double, M * M> coop;
+            for (int x = 0; x < M; x++) {
+                for (int y = 0; y < M; y++) {
+                    coop[x * M + y] = rule(IsGood(x) ? Reputation::G : Reputation::B, IsGood(y) ? Reputation::G : Reputation::B);
+                }
+            }
+            return coop;
+        }
+};
+
+template <int M>
+class MultiLevelGame {
+    public:
+        using LevelNorm = MultiLevelNorm<M>;
+        using Distribution = std::array<double, M>;
+        using Matrix = std::array<std::array<double, M>, M>;
+        using Kernel = std::array<Distribution, M * M>;
+        using ActionRuleTable = std::array<double, M * M>;
+
+        // Outcome of the stationary solve.
+        struct Solution {
+            Distribution state;
+            int iterations = 0;
+            double residual = 0.0;   // L1 norm of the last fixed-point residual
+        };
+
+        double assessment_error;
+        double perception_error;
+        double mu_e;
+        LevelNorm norm;
+        LevelNorm r_norm;
+        Solution solution;
+        Distribution equilibrium_state;   // share of residents at each level
+        double resident_coop;
+
+        MultiLevelGame(double assessment_error, double perception_error, double mu_e, const LevelNorm& norm,
+                       const Distribution& initial_guess = UniformDistribution(), double tol = 1e-14)
+            : assessment_error(assessment_error), perception_error(perception_error), mu_e(mu_e), norm(norm),
+              r_norm(norm.RescaleWithError(assessment_error, perception_error, mu_e)),
+              solution(Solve(r_norm, initial_guess, tol)),
+              equilibrium_state(solution.state),
+              resident_coop(calc_self_coop_resident()) {}
+
+        static Distribution UniformDistribution() {
+            Distribution d;
+            d.fill(1.0 / M);
+            return d;
+        }
+
+        // Mean level scaled to [0, 1]; the share of good residents for M = 2.
+        static double MeanImage(const Distribution& d) {
+            double mean = 0.0;
+            for (int l = 0; l < M; l++) { mean += l * d[l]; }
+            return mean / (M - 1);
+        }
+
+        // Level distribution after one action of a donor following `coop`, by the levels of
+        // donor and recipient: K[x * M + y][l] = sum_a S(x, y)[a] R(x, y, a)[l].
+        static Kernel Mix(const LevelNorm& r_norm, const ActionRuleTable& coop) {
+            Kernel K;
+            for (int k = 0; k < M * M; k++) {
+                const double s = coop[k];
+                const double* rc = &r_norm.level_probs[(k * 2 + LevelNorm::C) * M];
+                const double* rd = &r_norm.level_probs[(k * 2 + LevelNorm::D) * M];
+                for (int l = 0; l < M; l++) { K[k][l] = s * rc[l] + (1.0 - s) * rd[l]; }
+            }
+            return K;
+        }
+
+        // Level transitions of a donor who meets recipients drawn from d:
+        //     P[x][l] = sum_y d_y K[x * M + y][l]
+        static Matrix Transition(const Kernel& K, const Distribution& d) {
+            Matrix P{};
+            for (int x = 0; x < M; x++) {
+                for (int y = 0; y < M; y++) {
+                    for (int l = 0; l < M; l++) { P[x][l] += d[y] * K[x * M + y][l]; }
+                }
+            }
+            return P;
+        }
+
+        static Matrix Transition(const LevelNorm& r_norm, const ActionRuleTable& coop, const Distribution& d) {
+            return Transition(Mix(r_norm, coop), d);
+        }
+
+        // Stationary distribution of the row-stochastic P by GTH elimination, which only
+        // adds and divides positive numbers. Returns false, leaving pi unchanged, when a
+        // level cannot be left towards the lower ones (a reducible chain).
+        static bool Stationary(Matrix P, Distribution& pi) {
+            for (int k = M - 1; k > 0; k--) {
+                double s = 0.0;
+                for (int j = 0; j < k; j++) { s += P[k][j]; }
+                if (!(s > 0.0)) { return false; }
+                for (int i = 0; i < k; i++) { P[i][k] /= s; }
+                for (int i = 0; i < k; i++) {
+                    for (int j = 0; j < k; j++) { P[i][j] += P[i][k] * P[k][j]; }
+                }
+            }
+            Distribution x;
+            x[0] = 1.0;
+            double total = 1.0;
+            for (int k = 1; k < M; k++) {
+                x[k] = 0.0;
+                for (int i = 0; i < k; i++) { x[k] += x[i] * P[i][k]; }
+                total += x[k];
+            }
+            for (int k = 0; k < M; k++) { pi[k] = x[k] / total; }
+            return true;
+        }
+
+        // The resident distribution d is a fixed point of one round of interactions,
+        // d = d P(d). With more than two levels there can be several, so the solve follows
+        // the population dynamics from `initial_guess`: relaxed rounds d += relaxation
+        // (d P(d) - d), which unlike full synchronous rounds do not oscillate, until the L1
+        // residual drops below anderson_start inside the basin of the attractor, then
+        // Anderson acceleration over the last `memory` (at most MaxMemory) residuals. It
+        // stops when |d P(d) - d|_1 < tol and otherwise reports the residual after
+        // max_iterations. Two levels have a single fixed point, the root of Game's quadratic.
+        static Solution Solve(const LevelNorm& r_norm, const Distribution& initial_guess, double tol = 1e-14,
+                              int max_iterations = 2000, int memory = M - 1, double anderson_start = 1e-4,
+                              double relaxation = 0.5) {
+            Solution sol;
+            if constexpr (M == 2) {
+                std::array<double, 4> rs;
+                for (int k = 0; k < 4; k++) {
+                    double s = r_norm.coop_probs[k];
+                    rs[k] = s * r_norm.level_probs[(k * 2 + LevelNorm::C) * 2 + 1]
+                          + (1.0 - s) * r_norm.level_probs[(k * 2 + LevelNorm::D) * 2 + 1];
+                }
+                double h = GameEngine<2>::EquilibriumState(rs);
+                sol.state = {1.0 - h, h};
+                sol.iterations = 1;
+                Distribution g = Step(Mix(r_norm, r_norm.coop_probs), sol.state);
+                sol.residual = std::abs(g[0] - sol.state[0]) + std::abs(g[1] - sol.state[1]);
+                return sol;
+            }
+            CheckMemory(memory);
+            const Kernel K = Mix(r_norm, r_norm.coop_probs);
+            Distribution x = initial_guess;
+            for (int it = 1; it <= max_iterations; it++) {
+                Distribution g = Step(K, x), f;
+                sol.iterations = it;
+                sol.residual = Relax(x, g, f, relaxation);
+                if (sol.residual < tol) { sol.state = x; return sol; }
+                if (sol.residual < anderson_start) {
+                    return Accelerate(K, sol, f, g, tol, max_iterations, memory, relaxation);
+                }
+                x = g;
+            }
+            sol.state = x;
+            return sol;
+        }
+
+        // One round of interactions: every resident acts once, g = d P(d), renormalised
+        // since the total mass t would otherwise drift as t^2.
+        static Distribution Step(const Kernel& K, const Distribution& d) {
+            Matrix P = Transition(K, d);
+            Distribution g{};
+            double total = 0.0;
+            for (int x = 0; x < M; x++) {
+                for (int l = 0; l < M; l++) { g[l] += d[x] * P[x][l]; }
+            }
+            for (int l = 0; l < M; l++) { total += g[l]; }
+            for (int l = 0; l < M; l++) { g[l] /= total; }
+            return g;
+        }
+
+        // Solves many norms in parallel, each from the uniform distribution. With more than
+        // two levels a norm can have several stable distributions, so warm-starting one norm
+        // from another's solution could change which one is found. The relaxed rounds, most
+        // of the iterations, step BlockSize norms at a time laid out lane by lane, which GCC
+        // vectorizes across norms at -O3; a norm leaves its lane for its own Anderson phase
+        // and the lane takes the next norm. The results equal those of Solve.
+        static std::vector<Solution> calc_equilibrium_states(const std::vector<LevelNorm>& norms, double assessment_error,
+                                                             double perception_error, double mu_e,
+                                                             unsigned num_threads = 0, double tol = 1e-14) {
+            std::vector<Solution> sols(norms.size());
+            ParallelFor(norms.size(), [&](size_t begin, size_t end, unsigned) {
+                std::vector<LevelNorm> r_norms;
+                for (size_t n = begin; n < end; n++) {
+                    r_norms.push_back(norms[n].RescaleWithError(assessment_error, perception_error, mu_e));
+                }
+                if constexpr (M == 2) {
+                    for (size_t n = begin; n < end; n++) { sols[n] = Solve(r_norms[n - begin], UniformDistribution(), tol); }
+                } else {
+                    SolveLanes(r_norms.data(), r_norms.size(), &sols[begin], tol);
+                }
+            }, num_threads);
+            return sols;
+        }
+
+        double calc_self_coop_resident() const {
+            double coop = 0.0;
+            for (int x = 0; x < M; x++) {
+                for (int y = 0; y < M; y++) {
+                    coop += equilibrium_state[x] * equilibrium_state[y] * r_norm.coop_probs[x * M + y];
+                }
+            }
+            return coop;
+        }
+
+        // Level distribution of a rare donor following `invader` in the resident population.
+        // Throws when the invader's chain is reducible and has no unique distribution.
+        Distribution calc_equilibrium_state_mutant(const ActionRuleTable& r_invader) const {
+            Distribution H;
+            if (!Stationary(Transition(r_norm, r_invader, equilibrium_state), H)) {
+                throw std::runtime_error("MultiLevelGame: the invader's level chain is reducible");
+            }
+            return H;
+        }
+
+        // (level distribution of the invader, cooperation of the invader towards residents,
+        //  cooperation of residents towards the invader); `invader` is rescaled with mu_e.
+        std::tuple<Distribution, double, double> calc_invader_stats(const ActionRuleTable& invader) const {
+            ActionRuleTable r_invader;
+            for (int k = 0; k < M * M; k++) { r_invader[k] = invader[k] * (1.0 - mu_e); }
+            Distribution H = calc_equilibrium_state_mutant(r_invader);
+            double coop_mut_to_res = 0.0, coop_res_to_mut = 0.0;
+            for (int x = 0; x < M; x++) {
+                for (int y = 0; y < M; y++) {
+                    coop_mut_to_res += H[x] * equilibrium_state[y] * r_invader[x * M + y];
+                    coop_res_to_mut += equilibrium_state[x] * H[y] * r_norm.coop_probs[x * M + y];
+                }
+            }
+            return std::make_tuple(H, coop_mut_to_res, coop_res_to_mut);
+        }
+
+        // True when none of `invaders` other than the resident's own action rule earns more.
+        bool isESS(const std::vector<ActionRuleTable>& invaders, double benefit, double cost) const {
+            double self_payoff = (benefit - cost) * resident_coop;
+            for (const auto& invader : invaders) {
+                if (invader == norm.coop_probs) { continue; }
+                auto [H, coop_mut_to_res, coop_res_to_mut] = calc_invader_stats(invader);
+                if (benefit * coop_res_to_mut - cost * coop_mut_to_res > self_payoff) { return false; }
+            }
+            return true;
+        }
+
+        static constexpr int MaxMemory = 8;
+        static constexpr size_t BlockSize = 16;
+
+    private:
+        using History = std::array<Distribution, MaxMemory + 1>;
+
+        static void CheckMemory(int memory) {
+            if (memory < 0 || memory > MaxMemory) {
+                throw std::runtime_error("MultiLevelGame: Anderson memory must be between 0 and 8");
+            }
+        }
+
+        // One relaxed round from x given g = x P(x): f = relaxation (g - x), g = x + f.
+        // Returns the L1 residual |g - x|_1 of the full round.
+        static double Relax(const Distribution& x, Distribution& g, Distribution& f, double relaxation) {
+            double res = 0.0;
+            for (int l = 0; l < M; l++) {
+                res += std::abs(g[l] - x[l]);
+                f[l] = relaxation * (g[l] - x[l]);
+                g[l] = x[l] + f[l];
+            }
+            return res;
+        }
+
+        // Anderson phase of Solve, entered after the relaxed round that first fell below
+        // anderson_start; sol holds that round's count and residual, f_prev and g_prev its
+        // f and g, and g_prev is the next iterate.
+        static Solution Accelerate(const Kernel& K, Solution sol, Distribution f_prev, Distribution g_prev,
+                                   double tol, int max_iterations, int memory, double relaxation) {
+            Distribution x = g_prev, g, f;
+            History dF, dG;
+            int size = 0;
+            for (int it = sol.iterations + 1; it <= max_iterations; it++) {
+                sol.iterations = it;
+                g = Step(K, x);
+                double res = Relax(x, g, f, relaxation);
+                if (res > 10.0 * sol.residual) { size = 0; }   // extrapolation overshot: restart the history
+                sol.residual = res;
+                if (res < tol) { break; }
+
+                for (int l = 0; l < M; l++) { dF[size][l] = f[l] - f_prev[l]; dG[size][l] = g[l] - g_prev[l]; }
+                if (++size > memory) {
+                    std::rotate(dF.begin(), dF.begin() + 1, dF.begin() + size);
+                    std::rotate(dG.begin(), dG.begin() + 1, dG.begin() + size);
+                    size--;
+                }
+                f_prev = f;
+                g_prev = g;
+
+                Distribution next = g;
+                std::array<double, MaxMemory> gamma;
+                if (size > 0 && LeastSquares(dF, size, f, gamma)) {
+                    for (int j = 0; j < size; j++) {
+                        for (int l = 0; l < M; l++) { next[l] -= gamma[j] * dG[j][l]; }
+                    }
+                    if (!ProjectToSimplex(next)) {   // extrapolation failed: take the plain step
+                        next = g;
+                        size = 0;
+                    }
+                }
+                x = next;
+            }
+            sol.state = x;
+            return sol;
+        }
+
+        // Relaxed rounds of Solve for `count` norms from the uniform distribution, BlockSize
+        // at a time in lockstep: array[k][i] is entry k of lane i, and all lanes are stepped
+        // with the operations of Step and Relax in the same order. A lane whose residual
+        // falls below tol is done, one below anderson_start goes on to Accelerate, and
+        // either way the lane takes the next norm.
+        static void SolveLanes(const LevelNorm* r_norms, size_t count, Solution* sols, double tol,
+                               int max_iterations = 2000, int memory = M - 1, double anderson_start = 1e-4,
+                               double relaxation = 0.5) {
+            CheckMemory(memory);
+            constexpr size_t B = BlockSize;
+            alignas(64) double K[M * M][M][B];
+            alignas(64) double x[M][B], g[M][B], f[M][B], total[B], res[B];
+            std::array<size_t, B> lane_norm;
+            std::array<int, B> lane_iterations;
+            std::array<bool, B> active{};
+            size_t next = 0, num_active = 0;
+            std::array<Kernel, B> kernels;
+            auto load = [&](size_t i, size_t n) {
+                kernels[i] = Mix(r_norms[n], r_norms[n].coop_probs);
+                for (int k = 0; k < M * M; k++) {
+                    for (int l = 0; l < M; l++) { K[k][l][i] = kernels[i][k][l]; }
+                }
+                for (int l = 0; l < M; l++) { x[l][i] = 1.0 / M; }
+                lane_norm[i] = n;
+                lane_iterations[i] = 0;
+            };
+            auto refill = [&](size_t i) {
+                if (next < count) {
+                    load(i, next++);
+                } else {
+                    active[i] = false;
+                    num_active--;
+                }
+            };
+            // idle lanes keep stepping their last norm and are never read
+            for (size_t i = 0; i < B; i++) {
+                load(i, i < count ? i : 0);
+                active[i] = i < count;
+            }
+            next = std::min(count, B);
+            num_active = next;
+
+            while (num_active > 0) {
+                // Step(K, x) and Relax with their operations in the same order, across lanes:
+                // P[a][l] = sum_y x_y K[a * M + y][l], g = x P / |x P|_1
+                for (size_t i = 0; i < B; i++) { total[i] = 0.0; }
+                for (int l = 0; l < M; l++) {
+                    for (size_t i = 0; i < B; i++) { g[l][i] = 0.0; }
+                    for (int a = 0; a < M; a++) {
+                        for (size_t i = 0; i < B; i++) {
+                            double p = 0.0;
+                            for (int y = 0; y < M; y++) { p += x[y][i] * K[a * M + y][l][i]; }
+                            g[l][i] += x[a][i] * p;
+                        }
+                    }
+                    for (size_t i = 0; i < B; i++) { total[i] += g[l][i]; }
+                }
+                for (size_t i = 0; i < B; i++) { res[i] = 0.0; }
+                for (int l = 0; l < M; l++) {
+                    for (size_t i = 0; i < B; i++) {
+                        g[l][i] /= total[i];
+                        res[i] += std::abs(g[l][i] - x[l][i]);
+                        f[l][i] = relaxation * (g[l][i] - x[l][i]);
+                        g[l][i] = x[l][i] + f[l][i];
+                    }
+                }
+
+                for (size_t i = 0; i < B; i++) {
+                    if (!active[i]) { continue; }
+                    Solution& sol = sols[lane_norm[i]];
+                    sol.iterations = ++lane_iterations[i];
+                    sol.residual = res[i];
+                    if (res[i] < tol) {
+                        for (int l = 0; l < M; l++) { sol.state[l] = x[l][i]; }
+                        refill(i);
+                    } else if (res[i] < anderson_start) {
+                        Distribution fi, gi;
+                        for (int l = 0; l < M; l++) { fi[l] = f[l][i]; gi[l] = g[l][i]; }
+                        sol = Accelerate(kernels[i], sol, fi, gi, tol, max_iterations, memory, relaxation);
+                        refill(i);
+                    } else if (sol.iterations == max_iterations) {
+                        for (int l = 0; l < M; l++) { sol.state[l] = g[l][i]; }
+                        refill(i);
+                    } else {
+                        for (int l = 0; l < M; l++) { x[l][i] = g[l][i]; }
+                    }
+                }
+            }
+        }
+
+        // gamma minimising |f - sum_j gamma_j dF_j|_2 over the first m differences from the
+        // normal equations with a small ridge, by Gaussian elimination with partial pivoting.
+        static bool LeastSquares(const History& dF, int m, const Distribution& f, std::array<double, MaxMemory>& gamma) {
+            std::array<double, MaxMemory * (MaxMemory + 1)> A{};
+            double trace = 0.0;
+            for (int i = 0; i < m; i++) {
+                for (int j = 0; j < m; j++) {
+                    for (int l = 0; l < M; l++) { A[i * (m + 1) + j] += dF[i][l] * dF[j][l]; }
+                }
+                for (int l = 0; l < M; l++) { A[i * (m + 1) + m] += dF[i][l] * f[l]; }
+                trace += A[i * (m + 1) + i];
+            }
+            if (!(trace > 0.0)) { return false; }
+            for (int i = 0; i < m; i++) { A[i * (m + 1) + i] += 1e-12 * trace; }
+            for (int c = 0; c < m; c++) {
+                int pivot = c;
+                for (int r = c + 1; r < m; r++) {
+                    if (std::abs(A[r * (m + 1) + c]) > std::abs(A[pivot * (m + 1) + c])) { pivot = r; }
+                }
+                if (A[pivot * (m + 1) + c] == 0.0) { return false; }
+                for (int j = 0; j <= m; j++) { std::swap(A[c * (m + 1) + j], A[pivot * (m + 1) + j]); }
+                for (int r = c + 1; r < m; r++) {
+                    double factor = A[r * (m + 1) + c] / A[c * (m + 1) + c];
+                    for (int j = c; j <= m; j++) { A[r * (m + 1) + j] -= factor * A[c * (m + 1) + j]; }
+                }
+            }
+            for (int i = m - 1; i >= 0; i--) {
+                double sum = A[i * (m + 1) + m];
+                for (int j = i + 1; j < m; j++) { sum -= A[i * (m + 1) + j] * gamma[j]; }
+                gamma[i] = sum / A[i * (m + 1) + i];
+            }
+            return true;
+        }
+
+        static bool ProjectToSimplex(Distribution& d) {
+            double total = 0.0;
+            for (auto& p : d) {
+                if (!std::isfinite(p)) { return false; }
+                p = std::max(p, 0.0);
+                total += p;
+            }
+            if (!(total > 0.0)) { return false; }
+            for (auto& p : d) { p /= total; }
+            return true;
+        }
+};
+
+}  // namespace two_action
+
+#endif
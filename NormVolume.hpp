@@ -0,0 +1,192 @@
+#ifndef NormVolume_H
+#define NormVolume_H
+
+#include "Norms.hpp"
+#include "SweepEngine.hpp"
+#include "AgentSimulator.hpp"
+#include "QuasiRandom.hpp"
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+
+namespace two_action {
+
+// Fraction of the space of stochastic norms that is ESS, and ESS and cooperative, at
+// fixed errors. A norm is a point of [0, 1]^12: the eight good_probs of the assessment
+// rule followed by the four coop_probs of the action rule. Against a stochastic action
+// rule some deterministic invader always does at least as well (the invader payoff is
+// monotone along each coordinate of the rule), so the ESS set of the full space has
+// measure zero; fixing a deterministic action rule leaves the 8-dimensional space of
+// stochastic assessment rules, where the volume is not trivial. The volume is estimated
+// by randomized quasi-Monte Carlo: independent digital shifts of the same Sobol sequence
+// give unbiased replicate estimates whose spread provides the error bar.
+class NormVolume {
+    public:
+        static constexpr size_t BatchSize = 256;
+
+        struct Progress {
+            uint64_t points_per_replicate;
+            Estimate ess;                // fraction of ESS norms
+            Estimate ess_cooperative;    // fraction of ESS norms with cooperation >= coop_threshold
+            bool converged;
+        };
+
+        // action_rule_id is the ID of the fixed deterministic action rule, or -1 to sample
+        // stochastic action rules as well.
+        NormVolume(double assessment_error, double perception_error, double mu_e, double benefit, double cost,
+                   double coop_threshold = 0.9, int action_rule_id = -1)
+            : assessment_error(assessment_error), perception_error(perception_error), mu_e(mu_e),
+              benefit(benefit), cost(cost), coop_threshold(coop_threshold), action_rule_id(action_rule_id) {
+            if (action_rule_id < -1 || action_rule_id > 15) {
+                throw std::runtime_error("NormVolume: action_rule_id must be between -1 and 15");
+            }
+            if (action_rule_id >= 0) { fixed_action = ActionRule::MakeDeterministicRule(action_rule_id).coop_probs; }
+        }
+
+        int Dimension() const { return action_rule_id < 0 ? 12 : 8; }
+
+        // Game(...).isESS(benefit, cost) and resident_coop of the norms x[0..Dimension()-1][i],
+        // i < n, in structure-of-arrays form. The loop is branch-free so that the compiler
+        // vectorizes it; it follows GameEngine up to rounding. As in isESS, the invader equal
+        // to a deterministic resident action rule is skipped.
+        void Evaluate(size_t n, const double* const* x, uint8_t* ess, double* coop) const {
+            const double ae = assessment_error, pe = perception_error, q = 1.0 - mu_e;
+            const bool sampled_action = action_rule_id < 0;
+            for (size_t i = 0; i < n; i++) {
+                double r[8];
+                for (int k = 0; k < 8; k++) { r[k] = (1.0 - ae) * x[k][i] + ae * (1.0 - x[k][i]); }
+                for (int k = 0; k < 8; k += 2) { r[k] = (1.0 - pe) * r[k] + pe * r[k + 1]; }
+                double s[4], rs[4];
+                for (int k = 0; k < 4; k++) {
+                    s[k] = (sampled_action ? x[8 + k][i] : fixed_action[k]) * q;
+                    rs[k] = r[2 * k + 1] * s[k] + r[2 * k] * (1.0 - s[k]);
+                }
+                // GameEngine::EquilibriumState with both branches evaluated
+                const double c2 = rs[3] - rs[2] - rs[1] + rs[0];
+                const double c1 = rs[2] + rs[1] - 2.0 * rs[0] - 1.0;
+                const double c0 = rs[0];
+                const bool linear = std::abs(c2) < 1e-9;
+                const double disc = std::max(c1 * c1 - 4.0 * c2 * c0, 0.0);
+                const double h_quadratic = (-c1 - std::sqrt(disc)) / (2.0 * (linear ? 1.0 : c2));
+                const double h = linear ? -c0 / c1 : h_quadratic;
+                const double hg = h, hb = 1.0 - h;
+
+                const double resident_coop = h * h * s[3] + h * (1.0 - h) * (s[2] + s[1]) + (1.0 - h) * (1.0 - h) * s[0];
+                const double self_payoff = (benefit - cost) * resident_coop;
+                const double res_bad = hg * s[2] + hb * s[0], res_good = hg * s[3] + hb * s[1];
+
+                // rare deterministic invaders: a_k is 0 or q
+                bool stable = true;
+                for (int id = 0; id < 16; id++) {
+                    const double a_bb = (id & 1) ? q : 0.0, a_bg = (id & 2) ? q : 0.0;
+                    const double a_gb = (id & 4) ? q : 0.0, a_gg = (id & 8) ? q : 0.0;
+                    const double rs_bb = r[1] * a_bb + r[0] * (1.0 - a_bb);
+                    const double rs_bg = r[3] * a_bg + r[2] * (1.0 - a_bg);
+                    const double rs_gb = r[5] * a_gb + r[4] * (1.0 - a_gb);
+                    const double rs_gg = r[7] * a_gg + r[6] * (1.0 - a_gg);
+                    const double H = (hg * rs_bg + hb * rs_bb) / (1.0 - hg * rs_gg + hg * rs_bg - hb * rs_gb + hb * rs_bb);
+                    const double mut_to_res = H * (hg * a_gg + hb * a_gb) + (1.0 - H) * (hg * a_bg + hb * a_bb);
+                    const double res_to_mut = res_bad + (res_good - res_bad) * H;
+                    stable = stable && (id == action_rule_id || !(benefit * res_to_mut - cost * mut_to_res > self_payoff));
+                }
+                ess[i] = stable;
+                coop[i] = resident_coop;
+            }
+        }
+
+        // Counts of ESS and of cooperative ESS norms among points [first, first + count) of
+        // the Sobol sequence shifted by `shift`.
+        void CountBlock(const SobolSequence& sobol, const uint32_t* shift, uint64_t first, size_t count,
+                        long& num_ess, long& num_cooperative) const {
+            alignas(64) double buffer[12][BatchSize];
+            alignas(64) double coop[BatchSize];
+            uint8_t ess[BatchSize];
+            double* x[12];
+            for (int j = 0; j < 12; j++) { x[j] = buffer[j]; }
+            for (size_t done = 0; done < count; done += BatchSize) {
+                const size_t m = std::min(BatchSize, count - done);
+                sobol.Fill(first + done, m, x, shift);
+                Evaluate(m, x, ess, coop);
+                for (size_t i = 0; i < m; i++) {
+                    num_ess += ess[i];
+                    num_cooperative += ess[i] && coop[i] >= coop_threshold;
+                }
+            }
+        }
+
+        // Streams the sequence in rounds that double the number of points per replicate,
+        // starting from `initial_points`, so that every estimate uses a power-of-two prefix
+        // (a full net) of each replicate. Stops once both 95% half widths are at most
+        // `target_half_width` and enough points were drawn to resolve it, or after `max_points` per replicate. `report` is called after
+        // every round with the running estimates.
+        Progress Run(int replicates, double target_half_width, uint64_t max_points, uint64_t seed,
+                     unsigned num_threads = 0, const std::function<void(const Progress&)>& report = nullptr,
+                     uint64_t initial_points = 4096) const {
+            if (replicates < 2) { throw std::runtime_error("NormVolume: need at least two replicates for an error bar"); }
+            if (initial_points == 0 || (initial_points & (initial_points - 1))) {
+                throw std::runtime_error("NormVolume: initial_points must be a power of two");
+            }
+            if (max_points > SobolSequence::MaxPoints) {
+                throw std::runtime_error("NormVolume: max_points must be at most 2^32, the length of the Sobol sequence");
+            }
+            SobolSequence sobol(Dimension());
+            std::vector<std::array<uint32_t, 12>> shifts(replicates);
+            for (int r = 0; r < replicates; r++) {
+                CounterRNG rng(seed, r);
+                for (auto& s : shifts[r]) { s = static_cast<uint32_t>(rng.Next() >> 32); }
+            }
+
+            // per replicate: ESS count (class 2r) and cooperative ESS count (class 2r + 1)
+            CountSink counts(2 * replicates);
+            Progress progress{0, {}, {}, false};
+            uint64_t done = 0, next = std::min(initial_points, max_points);
+            const uint64_t chunk = 64 * BatchSize;
+            while (done < next) {
+                const uint64_t chunks = (next - done + chunk - 1) / chunk;
+                CountSink round = ParallelReduce(replicates * chunks, CountSink(2 * replicates), [&](size_t task, CountSink& sink) {
+                    const int r = static_cast<int>(task / chunks);
+                    const uint64_t first = done + (task % chunks) * chunk;
+                    const size_t count = static_cast<size_t>(std::min(chunk, next - first));
+                    long num_ess = 0, num_cooperative = 0;
+                    CountBlock(sobol, shifts[r].data(), first, count, num_ess, num_cooperative);
+                    sink.Add(2 * r, num_ess);
+                    sink.Add(2 * r + 1, num_cooperative);
+                }, num_threads);
+                counts.Merge(round);
+                done = next;
+
+                std::vector<double> ess(replicates), cooperative(replicates);
+                for (int r = 0; r < replicates; r++) {
+                    ess[r] = static_cast<double>(counts.counts[2 * r]) / done;
+                    cooperative[r] = static_cast<double>(counts.counts[2 * r + 1]) / done;
+                }
+                progress.points_per_replicate = done;
+                progress.ess = Estimate::FromBatches(ess);
+                progress.ess_cooperative = Estimate::FromBatches(cooperative);
+                // an empty region has zero spread, so also require the resolution 3 / N at which
+                // no hit among N points bounds the volume at 95%
+                const double resolution = 3.0 / (static_cast<double>(done) * replicates);
+                progress.converged = progress.ess.half_width <= target_half_width
+                                     && progress.ess_cooperative.half_width <= target_half_width
+                                     && resolution <= target_half_width;
+                if (report) { report(progress); }
+                if (progress.converged) { break; }
+                next = std::min(2 * done, max_points);
+            }
+            return progress;
+        }
+
+    private:
+        double assessment_error, perception_error, mu_e, benefit, cost, coop_threshold;
+        int action_rule_id;
+        std::array<double, 4> fixed_action{};
+};
+
+}  // namespace two_action
+
+#endif
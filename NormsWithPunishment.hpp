@@ -7,6 +7,11 @@
 #include <iostream>
 #include <sstream>
 #include <cassert>
+#include <cmath>
+
+#include "AssessmentRule.hpp"
+
+namespace with_punishment {
 
 enum class Action {
     D = 0,
@@ -19,7 +24,7 @@ enum class Reputation {
     G = 1
   };
 
-std::string ReputationToString(Reputation rep) {
+inline std::string ReputationToString(Reputation rep) {
     switch (rep) {
         case Reputation::B: return "B";
         case Reputation::G: return "G";
@@ -27,7 +32,7 @@ std::string ReputationToString(Reputation rep) {
     }
 };
 
-std::string ActionToString(Action act) {
+inline std::string ActionToString(Action act) {
     switch (act) {
         case Action::D: return "D";
         case Action::C: return "C";
@@ -36,7 +41,7 @@ std::string ActionToString(Action act) {
     }
 };
 
-Action IntToAction(int value) {
+inline Action IntToAction(int value) {
     switch (value) {
         case 0: return Action::D;
         case 1: return Action::C;
@@ -124,164 +129,16 @@ class ActionRule {
         }
 };
 
-bool operator==(const ActionRule& t1, const ActionRule& t2) {
+inline bool operator==(const ActionRule& t1, const ActionRule& t2) {
     return t1.actions_vector[0] == t2.actions_vector[0] &&
            t1.actions_vector[1] == t2.actions_vector[1] &&
            t1.actions_vector[2] == t2.actions_vector[2] &&
            t1.actions_vector[3] == t2.actions_vector[3];}
 
-bool operator!=(const ActionRule& t1, const ActionRule& t2) { return !(t1 == t2);}
-
-class AssessmentRule {
-    public:
-        std::array<double, 12> good_probs;
+inline bool operator!=(const ActionRule& t1, const ActionRule& t2) { return !(t1 == t2);}
 
-        // Constructor using std::array
-        explicit AssessmentRule(const std::array<double, 12>& g_probs) {
-            for (size_t i = 0; i < good_probs.size(); ++i) {
-                good_probs[i] = g_probs[i];
-            }
-        }
-
-        AssessmentRule RescaleWithError(double assignment_error = 0, double perception_error = 0) const {
-            std::array<double,12> rescaled = {0.0};
-            for (size_t i = 0; i < 12; i++) {
-                rescaled[i] = (1 - assignment_error) * good_probs[i] + assignment_error * (1 - good_probs[i]);
-            }
-            for (size_t i = 0; i < 12; i += 3) {
-                rescaled[i] = (1 - perception_error) * rescaled[i] + perception_error * rescaled[i + 1];
-              }
-            return AssessmentRule{rescaled};
-          }
-
-        // Constructor using std::map
-        explicit AssessmentRule(const std::map<std::tuple<Reputation, Reputation, Action>, double>& g_probs) {
-            if (g_probs.size() != 12) {
-                throw std::runtime_error("AssessmentRule: g_probs must have 12 elements");
-            }
-            good_probs[0] = g_probs.at({Reputation::B, Reputation::B, Action::D});
-            good_probs[1] = g_probs.at({Reputation::B, Reputation::B, Action::C});
-            good_probs[2] = g_probs.at({Reputation::B, Reputation::B, Action::P});
-            good_probs[3] = g_probs.at({Reputation::B, Reputation::G, Action::D});
-            good_probs[4] = g_probs.at({Reputation::B, Reputation::G, Action::C});
-            good_probs[5] = g_probs.at({Reputation::B, Reputation::G, Action::P});
-            good_probs[6] = g_probs.at({Reputation::G, Reputation::B, Action::D});
-            good_probs[7] = g_probs.at({Reputation::G, Reputation::B, Action::C});
-            good_probs[8] = g_probs.at({Reputation::G, Reputation::B, Action::P});
-            good_probs[9] = g_probs.at({Reputation::G, Reputation::G, Action::D});
-            good_probs[10] = g_probs.at({Reputation::G, Reputation::G, Action::C});
-            good_probs[11] = g_probs.at({Reputation::G, Reputation::G, Action::P});
-        }
-
-        double operator()(Reputation r1, Reputation r2, Action a) const {
-            int index;
-
-            if (r1 == Reputation::B && r2 == Reputation::B && a == Action::D) index = 0;
-            else if (r1 == Reputation::B && r2 == Reputation::B && a == Action::C) index = 1;
-            else if (r1 == Reputation::B && r2 == Reputation::B && a == Action::P) index = 2;
-            else if (r1 == Reputation::B && r2 == Reputation::G && a == Action::D) index = 3;
-            else if (r1 == Reputation::B && r2 == Reputation::G && a == Action::C) index = 4;
-            else if (r1 == Reputation::B && r2 == Reputation::G && a == Action::P) index = 5;
-            else if (r1 == Reputation::G && r2 == Reputation::B && a == Action::D) index = 6;
-            else if (r1 == Reputation::G && r2 == Reputation::B && a == Action::C) index = 7;
-            else if (r1 == Reputation::G && r2 == Reputation::B && a == Action::P) index = 8;
-            else if (r1 == Reputation::G && r2 == Reputation::G && a == Action::D) index = 9;
-            else if (r1 == Reputation::G && r2 == Reputation::G && a == Action::C) index = 10;
-            else if (r1 == Reputation::G && r2 == Reputation::G && a == Action::P) index = 11;
-            else throw std::runtime_error("Invalid reputation-action combination");
-
-            return good_probs[index];
-        }
-
-        void Set(Reputation r1, Reputation r2, Action a, double p) {
-            int index;
-            if (r1 == Reputation::B && r2 == Reputation::B && a == Action::D) index = 0;
-            else if (r1 == Reputation::B && r2 == Reputation::B && a == Action::C) index = 1;
-            else if (r1 == Reputation::B && r2 == Reputation::B && a == Action::P) index = 2;
-            else if (r1 == Reputation::B && r2 == Reputation::G && a == Action::D) index = 3;
-            else if (r1 == Reputation::B && r2 == Reputation::G && a == Action::C) index = 4;
-            else if (r1 == Reputation::B && r2 == Reputation::G && a == Action::P) index = 5;
-            else if (r1 == Reputation::G && r2 == Reputation::B && a == Action::D) index = 6;
-            else if (r1 == Reputation::G && r2 == Reputation::B && a == Action::C) index = 7;
-            else if (r1 == Reputation::G && r2 == Reputation::B && a == Action::P) index = 8;
-            else if (r1 == Reputation::G && r2 == Reputation::G && a == Action::D) index = 9;
-            else if (r1 == Reputation::G && r2 == Reputation::G && a == Action::C) index = 10;
-            else if (r1 == Reputation::G && r2 == Reputation::G && a == Action::P) index = 11;
-            else throw std::runtime_error("Invalid reputation-action combination");
-
-            good_probs[index] = p;
-        }
-
-        int ID() const {
-            int id = 0;
-            for (size_t i = 0; i < 12; i++) {
-                if (good_probs[i] == 1.0) {
-                    id += 1 << i;
-                }
-            }
-            return id;
-        }
-
-        static AssessmentRule MakeDeterministicRule(int id) {
-            if (id < 0 || id >= 4096) {
-                throw std::runtime_error("AssessmentRuleDet: id must be between 0 and 4095");
-            }
-
-            std::array<double, 12> good_probs{};
-            for (size_t i = 0; i < good_probs.size(); i++) {
-                good_probs[i] = (id >> i) & 1;
-            }
-
-            return AssessmentRule(good_probs);
-        }
-
-        static AssessmentRule AllGood() {
-            return AssessmentRule::MakeDeterministicRule(0b111111111111);
-        }
-        static AssessmentRule AllBad() {
-            return AssessmentRule::MakeDeterministicRule(0b000000000000);
-        }
-        static AssessmentRule ImageScoring() {
-            return AssessmentRule{{0.0,1.0,0.0,0.0,1.0,0.0,0.0,1.0,0.0,0.0,1.0,0.0}};
-        }
-        std::string Inspect() const {
-            std::stringstream ss;
-            ss << "AssessmentRule: " << ID() << std::endl;
-            ss << "===================" << std::endl;
-
-            for (size_t i = 0; i < 12; i++) {
-                Reputation donor_rep = static_cast<Reputation>((i / 6) % 2);
-                Reputation recip_rep = static_cast<Reputation>((i / 3) % 2);
-                Action action = static_cast<Action>((i / 1) % 3);
-
-                ss << "("
-                << "Donor: " << ReputationToString(donor_rep) << ", "
-                << "Recipient: " << ReputationToString(recip_rep) << ", "
-                << "Action: " << ActionToString(action) << ") : "
-                << good_probs[i] << "\n";
-            }
-
-            return ss.str();
-        }
-};
-
-bool operator==(const AssessmentRule& t1, const AssessmentRule& t2) {
-    return t1.good_probs[0] == t2.good_probs[0] &&
-           t1.good_probs[1] == t2.good_probs[1] &&
-           t1.good_probs[2] == t2.good_probs[2] &&
-           t1.good_probs[3] == t2.good_probs[3] &&
-           t1.good_probs[4] == t2.good_probs[4] &&
-           t1.good_probs[5] == t2.good_probs[5] &&
-           t1.good_probs[6] == t2.good_probs[6] &&
-           t1.good_probs[7] == t2.good_probs[7] &&
-           t1.good_probs[8] == t2.good_probs[8] &&
-           t1.good_probs[9] == t2.good_probs[9] &&
-           t1.good_probs[10] == t2.good_probs[10] &&
-           t1.good_probs[11] == t2.good_probs[11];
-}
-bool operator!=(const AssessmentRule& t1, const AssessmentRule& t2) {
-    return !(t1 == t2);
-};
+// AssessmentRule.hpp, on good_probs[(donor * 2 + recipient) * 3 + action]
+using AssessmentRule = BasicAssessmentRule<3, Reputation, Action>;
 
 class Norm {
     public:
@@ -292,6 +149,7 @@ class Norm {
             : assessment_rule(as_rule), action_rule(a_rule) {}
 
     int ID() const {
+        if (!assessment_rule.IsDeterministic()) { return -1; }
         int id = 0;
         id += assessment_rule.ID() << 7;
         id += action_rule.ID();
@@ -314,4 +172,7 @@ class Norm {
         return Norm{assessment_rule.RescaleWithError(assignment_error, perception_error), action_rule};
     }
 };
-#endif
\ No newline at end of file
+
+}  // namespace with_punishment
+
+#endif
@@ -0,0 +1,281 @@
+#ifndef PolymorphicGame_H
+#define PolymorphicGame_H
+
+#include "Norms.hpp"
+#include "SweepEngine.hpp"
+
+#include <vector>
+#include <array>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace two_action {
+
+// Game.hpp extended to populations in which k action rules coexist at shares x
+// under one assessment rule. Type i is good with probability h_i, so a random
+// recipient is good with probability g = sum_j x_j h_j and the image of type i
+// solves the same balance as calc_equilibrium_state_mutant with g in place of h:
+//     h_i(g) = a_i / (1 - c_i + a_i),  c_i = g RS_GG + (1 - g) RS_GB,
+//                                      a_i = g RS_BG + (1 - g) RS_BB.
+// The population image g is the root of F(g) = sum_j x_j h_j(g) - g on [0, 1];
+// F(0) >= 0 >= F(1), so a root is always bracketed. For a monomorphic population
+// this is the quadratic of Game::calc_equilibrium_state, which has a single root there.
+
+// Direction of selection on the edge between a resident and an invader action rule.
+enum class EdgeDynamics {
+    ResidentDominates,
+    InvaderDominates,
+    Coexistence,    // both invade each other: stable mixed rest point
+    Bistability,    // neither invades: unstable mixed rest point
+    Neutral
+};
+
+inline std::string EdgeDynamicsToString(EdgeDynamics e) {
+    switch (e) {
+        case EdgeDynamics::ResidentDominates: return "resident";
+        case EdgeDynamics::InvaderDominates: return "invader";
+        case EdgeDynamics::Coexistence: return "coexistence";
+        case EdgeDynamics::Bistability: return "bistability";
+        case EdgeDynamics::Neutral: return "neutral";
+        default: return "Unknown";
+    }
+}
+
+class PolymorphicGame {
+    public:
+        double assessment_error;
+        double perception_error;
+        double mu_e;
+        AssessmentRule assessment_rule;
+        std::vector<ActionRule> action_rules;
+        AssessmentRule r_assessment_rule;
+        std::vector<ActionRule> r_action_rules;
+
+        static constexpr Reputation B = Reputation::B, G = Reputation::G;
+        static constexpr Action C = Action::C, D = Action::D;
+
+        PolymorphicGame(double assessment_error, double perception_error, double mu_e,
+                        const AssessmentRule& assessment_rule, const std::vector<ActionRule>& action_rules)
+            : assessment_error(assessment_error), perception_error(perception_error), mu_e(mu_e),
+              assessment_rule(assessment_rule), action_rules(action_rules),
+              r_assessment_rule(assessment_rule.RescaleWithError(assessment_error, perception_error)) {
+            if (action_rules.empty()) { throw std::runtime_error("PolymorphicGame: need at least one action rule"); }
+            const AssessmentRule& R = r_assessment_rule;
+            for (const auto& rule : action_rules) {
+                ActionRule S = rule.RescaleWithError(mu_e);
+                r_action_rules.push_back(S);
+                rs.push_back({R(B, B, C) * S(B, B) + R(B, B, D) * (1.0 - S(B, B)),
+                              R(B, G, C) * S(B, G) + R(B, G, D) * (1.0 - S(B, G)),
+                              R(G, B, C) * S(G, B) + R(G, B, D) * (1.0 - S(G, B)),
+                              R(G, G, C) * S(G, G) + R(G, G, D) * (1.0 - S(G, G))});
+            }
+        }
+
+        // All 16 deterministic action rules under one assessment rule.
+        static PolymorphicGame AllActionRules(double assessment_error, double perception_error, double mu_e,
+                                              const AssessmentRule& assessment_rule) {
+            std::vector<ActionRule> rules;
+            for (int i = 0; i < 16; i++) { rules.push_back(ActionRule::MakeDeterministicRule(i)); }
+            return PolymorphicGame(assessment_error, perception_error, mu_e, assessment_rule, rules);
+        }
+
+        size_t NumTypes() const { return action_rules.size(); }
+
+        // Image of type i when a random recipient is good with probability g.
+        double calc_type_image(size_t i, double g) const {
+            const auto& t = rs[i];
+            double a = g * t[1] + (1.0 - g) * t[0];
+            double c = g * t[3] + (1.0 - g) * t[2];
+            double den = 1.0 - c + a;
+            return den > 0.0 ? a / den : 0.0;
+        }
+
+        // dh_i/dg: with a' = RS_BG - RS_BB and c' = RS_GG - RS_GB,
+        // h_i' = (a' (1 - c) + a c') / (1 - c + a)^2.
+        double calc_type_image_derivative(size_t i, double g) const {
+            const auto& t = rs[i];
+            double a = g * t[1] + (1.0 - g) * t[0];
+            double c = g * t[3] + (1.0 - g) * t[2];
+            double den = 1.0 - c + a;
+            return den > 0.0 ? ((t[1] - t[0]) * (1.0 - c) + a * (t[3] - t[2])) / (den * den) : 0.0;
+        }
+
+        // Population image g for shares x. The k image equations depend on the other
+        // images only through g, so Newton on the full system reduces to Newton on the
+        // scalar F(g) with F'(g) = sum_j x_j h_j'(g) - 1. Steps that leave the current
+        // bracket of the root fall back to bisection. A warm start in [0, 1], e.g. the
+        // solution at neighbouring shares, follows that branch if there are several roots.
+        double calc_equilibrium_state(const std::vector<double>& x, double initial_guess = -1.0,
+                                      double tolerance = 1e-14, int* iterations = nullptr) const {
+            double lo = 0.0, hi = 1.0;
+            double g = (initial_guess >= 0.0 && initial_guess <= 1.0) ? initial_guess : 0.5;
+            int it = 0;
+            for (; it < 100; it++) {
+                double f = -g, df = -1.0;
+                for (size_t j = 0; j < NumTypes(); j++) {
+                    if (x[j] == 0.0) { continue; }
+                    f += x[j] * calc_type_image(j, g);
+                    df += x[j] * calc_type_image_derivative(j, g);
+                }
+                if (f == 0.0) { break; }
+                if (f > 0.0) { lo = g; } else { hi = g; }
+                if (df < 0.0 && std::abs(f / df) < tolerance) {
+                    g = std::min(std::max(g - f / df, 0.0), 1.0);
+                    break;
+                }
+                double next = (df < 0.0) ? g - f / df : -1.0;
+                if (!(next > lo && next < hi)) { next = 0.5 * (lo + hi); }
+                g = next;
+                if (hi - lo < tolerance) { break; }
+            }
+            if (iterations) { *iterations = it + 1; }
+            return g;
+        }
+
+        // Solves a batch of share vectors in parallel. Within each thread's block every solve
+        // is warm-started from the previous one, so ordering neighbouring points consecutively
+        // (e.g. along a grid line) keeps the iteration counts low.
+        std::vector<double> calc_equilibrium_states(const std::vector<std::vector<double>>& xs,
+                                                    unsigned num_threads = 0) const {
+            std::vector<double> gs(xs.size());
+            ParallelFor(xs.size(), [&](size_t begin, size_t end, unsigned) {
+                double g = -1.0;
+                for (size_t n = begin; n < end; n++) { g = gs[n] = calc_equilibrium_state(xs[n], g); }
+            }, num_threads);
+            return gs;
+        }
+
+        std::vector<double> calc_images(double g) const {
+            std::vector<double> h(NumTypes());
+            for (size_t i = 0; i < NumTypes(); i++) { h[i] = calc_type_image(i, g); }
+            return h;
+        }
+
+        // coop[j * k + i]: probability that a donor of type j cooperates with a recipient of type i.
+        std::vector<double> calc_coop_matrix(const std::vector<double>& h) const {
+            const size_t k = NumTypes();
+            std::vector<double> coop(k * k);
+            for (size_t j = 0; j < k; j++) {
+                auto [to_good, to_bad] = DonorCoop(j, h[j]);
+                for (size_t i = 0; i < k; i++) { coop[j * k + i] = h[i] * to_good + (1.0 - h[i]) * to_bad; }
+            }
+            return coop;
+        }
+
+        // Payoff of each type: b * sum_j x_j coop(j -> i) - c * sum_j x_j coop(i -> j).
+        // Reduces to Game's resident payoff and invader payoff at the monomorphic limits.
+        std::vector<double> calc_payoffs(const std::vector<double>& x, double benefit, double cost) const {
+            double g = calc_equilibrium_state(x);
+            return calc_payoffs(x, calc_images(g), benefit, cost);
+        }
+
+        // Same with `g` as warm start; g is updated to the solution.
+        std::vector<double> calc_payoffs(const std::vector<double>& x, double benefit, double cost, double& g) const {
+            g = calc_equilibrium_state(x, g);
+            return calc_payoffs(x, calc_images(g), benefit, cost);
+        }
+
+        std::vector<double> calc_payoffs(const std::vector<double>& x, const std::vector<double>& h,
+                                         double benefit, double cost) const {
+            const size_t k = NumTypes();
+            // coop(j -> i) = h_i u_j(G) + (1 - h_i) u_j(B), so both sums only need the
+            // share-weighted totals of u(G), u(B) and of the images
+            std::vector<std::pair<double, double>> u(k);
+            double to_good = 0.0, to_bad = 0.0, g = 0.0;
+            for (size_t j = 0; j < k; j++) {
+                u[j] = DonorCoop(j, h[j]);
+                to_good += x[j] * u[j].first;
+                to_bad += x[j] * u[j].second;
+                g += x[j] * h[j];
+            }
+            std::vector<double> payoffs(k);
+            for (size_t i = 0; i < k; i++) {
+                double received = h[i] * to_good + (1.0 - h[i]) * to_bad;
+                double given = g * u[i].first + (1.0 - g) * u[i].second;
+                payoffs[i] = benefit * received - cost * given;
+            }
+            return payoffs;
+        }
+
+        struct InvasionPoint {
+            double share;   // of the invader
+            double g;
+            double resident_payoff;
+            double invader_payoff;
+        };
+
+        struct EdgeAnalysis {
+            EdgeDynamics dynamics;
+            std::vector<double> rest_points;   // invader shares strictly inside (0, 1)
+            std::vector<InvasionPoint> curve;
+        };
+
+        // Payoffs of the two types as the invader share goes from 0 to 1 in `points` steps,
+        // each image solve warm-started from the previous share.
+        std::vector<InvasionPoint> calc_invasion_curve(size_t resident, size_t invader, double benefit, double cost,
+                                                       size_t points = 101) const {
+            std::vector<InvasionPoint> curve;
+            double g = -1.0;
+            for (size_t n = 0; n < points; n++) {
+                double share = (points > 1) ? static_cast<double>(n) / (points - 1) : 0.0;
+                curve.push_back(calc_edge_point(resident, invader, share, benefit, cost, g));
+            }
+            return curve;
+        }
+
+        // Classifies the edge by the payoff difference at its ends and locates the mixed rest
+        // points, i.e. the sign changes of invader minus resident payoff along the curve,
+        // refined by bisection.
+        EdgeAnalysis calc_edge(size_t resident, size_t invader, double benefit, double cost,
+                               size_t points = 101, double tolerance = 1e-12) const {
+            EdgeAnalysis edge;
+            edge.curve = calc_invasion_curve(resident, invader, benefit, cost, std::max<size_t>(points, 2));
+            auto diff = [](const InvasionPoint& p) { return p.invader_payoff - p.resident_payoff; };
+            auto sign = [tolerance](double d) { return (d > tolerance) - (d < -tolerance); };
+            int at_resident = sign(diff(edge.curve.front())), at_invader = sign(diff(edge.curve.back()));
+            if (at_resident > 0 && at_invader < 0) { edge.dynamics = EdgeDynamics::Coexistence; }
+            else if (at_resident < 0 && at_invader > 0) { edge.dynamics = EdgeDynamics::Bistability; }
+            else if (at_resident + at_invader > 0) { edge.dynamics = EdgeDynamics::InvaderDominates; }
+            else if (at_resident + at_invader < 0) { edge.dynamics = EdgeDynamics::ResidentDominates; }
+            else { edge.dynamics = EdgeDynamics::Neutral; }
+
+            for (size_t n = 0; n + 1 < edge.curve.size(); n++) {
+                const auto& p = edge.curve[n];
+                const auto& q = edge.curve[n + 1];
+                if (sign(diff(p)) * sign(diff(q)) >= 0) { continue; }
+                double lo = p.share, hi = q.share, g = p.g;
+                bool lo_positive = diff(p) > 0.0;
+                for (int it = 0; it < 60 && hi - lo > 1e-14; it++) {
+                    double mid = 0.5 * (lo + hi);
+                    bool positive = diff(calc_edge_point(resident, invader, mid, benefit, cost, g)) > 0.0;
+                    if (positive == lo_positive) { lo = mid; } else { hi = mid; }
+                }
+                edge.rest_points.push_back(0.5 * (lo + hi));
+            }
+            return edge;
+        }
+
+    private:
+        std::vector<std::array<double, 4>> rs;   // RS_BB, RS_BG, RS_GB, RS_GG of each type
+
+        InvasionPoint calc_edge_point(size_t resident, size_t invader, double share, double benefit, double cost,
+                                      double& g) const {
+            std::vector<double> x(NumTypes(), 0.0);
+            x[resident] = 1.0 - share;
+            x[invader] = share;
+            auto pi = calc_payoffs(x, benefit, cost, g);
+            return {share, g, pi[resident], pi[invader]};
+        }
+
+        // Cooperation of a type-j donor with image h_j towards a good and a bad recipient.
+        std::pair<double, double> DonorCoop(size_t j, double h_j) const {
+            const ActionRule& S = r_action_rules[j];
+            return {h_j * S(G, G) + (1.0 - h_j) * S(B, G), h_j * S(G, B) + (1.0 - h_j) * S(B, B)};
+        }
+};
+
+}  // namespace two_action
+
+#endif
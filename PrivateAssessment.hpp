@@ -0,0 +1,271 @@
+#ifndef PrivateAssessment_H
+#define PrivateAssessment_H
+
+#include "CounterRNG.hpp"
+#include "SweepEngine.hpp"
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+
+
+// Private assessment: every observer keeps its own image of everyone. The N x N
+// image matrix is stored as packed bits with one row per assessed agent, bit o of
+// row t being observer o's image of t, so a single interaction updates the donor's
+// row for all observers with word-wide bit operations.
+//
+// The simulator only uses deterministic rules through their IDs and does not
+// include the norm headers, so it serves both the two-action (Norms.hpp) and the
+// three-action (NormsWithPunishment.hpp) model. Actions are numbered D = 0, C = 1,
+// P = 2 and the bit (x * 2 + y) * num_actions + a of an assessment rule ID is the
+// image of a donor judged x who takes action a towards a recipient judged y.
+namespace private_assessment {
+
+    inline int RuleBit(int num_actions, int assessment_id, int x, int y, int a) {
+        return (assessment_id >> ((x * 2 + y) * num_actions + a)) & 1;
+    }
+
+    // Actions at (donor image * 2 + recipient image) of a deterministic action rule ID:
+    // bits of a two-action ID, base-3 digits of a three-action ID.
+    inline std::array<uint8_t, 4> ActionsFromID(int num_actions, int id) {
+        std::array<uint8_t, 4> actions{};
+        for (int i = 0; i < 4; i++) {
+            actions[i] = (num_actions == 2) ? (id >> i) & 1 : id % 3;
+            if (num_actions == 3) { id /= 3; }
+        }
+        return actions;
+    }
+
+    // Fills `mask` with independent bits that are set with probability p. For p below
+    // one half the set bits are placed by geometric skips, otherwise the complement is.
+    inline void BernoulliMask(CounterRNG& rng, double p, size_t num_bits, uint64_t* mask) {
+        const size_t words = (num_bits + 63) / 64;
+        bool complement = p > 0.5;
+        double q = complement ? 1.0 - p : p;
+        std::memset(mask, 0, words * sizeof(uint64_t));
+        if (q > 0.0) {
+            const double log_q = std::log1p(-q);
+            size_t pos = 0;
+            while (true) {
+                double u = 1.0 - rng.Uniform();   // in (0, 1]
+                double gap = std::floor(std::log(u) / log_q);
+                if (gap >= static_cast<double>(num_bits - pos)) { break; }
+                pos += static_cast<size_t>(gap);
+                mask[pos >> 6] |= uint64_t(1) << (pos & 63);
+                if (++pos >= num_bits) { break; }
+            }
+        }
+        if (complement) {
+            for (size_t w = 0; w < words; w++) { mask[w] = ~mask[w]; }
+            if (num_bits % 64) { mask[words - 1] &= (uint64_t(1) << (num_bits % 64)) - 1; }
+        }
+    }
+
+    // Per (x * 2 + y): bit 0 is the image after the action as it happened, bit 1 after
+    // the action as seen by an observer who mistakes a defection for cooperation.
+    inline std::array<uint8_t, 4> ImageTable(int num_actions, int assessment_id, int action) {
+        const int misperceived = (action == 0) ? 1 : action;
+        std::array<uint8_t, 4> table{};
+        for (int k = 0; k < 4; k++) {
+            table[k] = RuleBit(num_actions, assessment_id, k / 2, k % 2, action)
+                     | (RuleBit(num_actions, assessment_id, k / 2, k % 2, misperceived) << 1);
+        }
+        return table;
+    }
+
+    // new = OR over (x, y) of [x][y] & image, where image is taken from the table per
+    // observer according to the misperception mask; then assignment errors flip bits and
+    // observers in `hidden` keep their old image.
+    inline void UpdateRow(const std::array<uint8_t, 4>& table, uint64_t* donor_row, const uint64_t* recipient_row,
+                          const uint64_t* misperceived, const uint64_t* flipped, const uint64_t* hidden, size_t words) {
+        uint64_t sel0[4], sel1[4];
+        for (int k = 0; k < 4; k++) {
+            sel0[k] = (table[k] & 1) ? ~uint64_t(0) : 0;
+            sel1[k] = (table[k] & 2) ? ~uint64_t(0) : 0;
+        }
+        for (size_t w = 0; w < words; w++) {
+            const uint64_t x = donor_row[w], y = recipient_row[w], e = misperceived[w];
+            uint64_t image = (~x & ~y & ((sel0[0] & ~e) | (sel1[0] & e)))
+                           | (~x &  y & ((sel0[1] & ~e) | (sel1[1] & e)))
+                           | ( x & ~y & ((sel0[2] & ~e) | (sel1[2] & e)))
+                           | ( x &  y & ((sel0[3] & ~e) | (sel1[3] & e)));
+            image ^= flipped[w];
+            donor_row[w] = (hidden[w] & x) | (~hidden[w] & image);
+        }
+    }
+}
+
+class PrivateAssessmentSimulator {
+    public:
+        static constexpr size_t MaxTypes = 256;
+
+        int num_actions;
+        int assessment_id;
+        double assessment_error;
+        double perception_error;
+        double mu_e;                     // implementation error, two-action model only
+        double observation_probability;  // chance that an observer witnesses an interaction
+        size_t population_size;
+        size_t words;                    // 64-bit words per image row
+
+        // Structure of arrays over agents
+        std::vector<uint8_t> type;       // index into type_actions, so at most MaxTypes types
+        std::vector<uint64_t> images;    // population_size rows of `words` words
+
+        std::vector<std::array<uint8_t, 4>> type_actions;
+        std::vector<size_t> type_counts;
+
+        struct Stats {
+            size_t num_types = 0, num_actions = 0;
+            std::vector<uint64_t> actions;   // [donor type][recipient type][action]
+            std::vector<double> good;        // per assessed type: share of good images
+            double agreement = 0.0;          // probability that two observers agree on an image
+            double samples = 0.0;
+            uint64_t interactions = 0;
+
+            uint64_t Count(size_t donor, size_t recipient, size_t action) const {
+                return actions[(donor * num_types + recipient) * num_actions + action];
+            }
+            // Share of action `action` in interactions from donor type to recipient type.
+            double Rate(size_t donor, size_t recipient, size_t action) const {
+                uint64_t n = 0;
+                for (size_t a = 0; a < num_actions; a++) { n += Count(donor, recipient, a); }
+                return n > 0 ? static_cast<double>(Count(donor, recipient, action)) / n : 0.0;
+            }
+            double Good(size_t t) const { return samples > 0.0 ? good[t] / samples : 0.0; }
+            double Agreement() const { return samples > 0.0 ? agreement / samples : 0.0; }
+
+            void Merge(const Stats& other) {
+                for (size_t i = 0; i < actions.size(); i++) { actions[i] += other.actions[i]; }
+                for (size_t i = 0; i < good.size(); i++) { good[i] += other.good[i]; }
+                agreement += other.agreement;
+                samples += other.samples;
+                interactions += other.interactions;
+            }
+        };
+
+        // type_action_ids[t] is the action rule ID of type t and type_counts[t] its number of agents.
+        PrivateAssessmentSimulator(int num_actions, int assessment_id, const std::vector<int>& type_action_ids,
+                                   const std::vector<size_t>& type_counts, double assessment_error,
+                                   double perception_error, double mu_e = 0.0, double observation_probability = 1.0)
+            : num_actions(num_actions), assessment_id(assessment_id), assessment_error(assessment_error),
+              perception_error(perception_error), mu_e(mu_e), observation_probability(observation_probability),
+              type_counts(type_counts) {
+            if (num_actions != 2 && num_actions != 3) {
+                throw std::runtime_error("PrivateAssessmentSimulator: num_actions must be 2 or 3");
+            }
+            if (type_action_ids.size() != type_counts.size() || type_counts.empty()) {
+                throw std::runtime_error("PrivateAssessmentSimulator: one count per type is required");
+            }
+            if (type_counts.size() > MaxTypes) {
+                throw std::runtime_error("PrivateAssessmentSimulator: at most 256 types");
+            }
+            population_size = 0;
+            for (size_t t = 0; t < type_counts.size(); t++) {
+                type_actions.push_back(private_assessment::ActionsFromID(num_actions, type_action_ids[t]));
+                type.insert(type.end(), type_counts[t], static_cast<uint8_t>(t));
+                population_size += type_counts[t];
+            }
+            if (population_size < 2) { throw std::runtime_error("PrivateAssessmentSimulator: need at least two agents"); }
+            words = (population_size + 63) / 64;
+            images.assign(population_size * words, 0);
+            for (int a = 0; a < num_actions; a++) {
+                tables[a] = private_assessment::ImageTable(num_actions, assessment_id, a);
+            }
+            misperceived.resize(words);
+            flipped.resize(words);
+            hidden.resize(words);
+        }
+
+        size_t NumTypes() const { return type_actions.size(); }
+        uint64_t* Row(size_t target) { return images.data() + target * words; }
+        const uint64_t* Row(size_t target) const { return images.data() + target * words; }
+
+        int Image(size_t observer, size_t target) const { return (Row(target)[observer >> 6] >> (observer & 63)) & 1; }
+        void SetImage(size_t observer, size_t target, int good) {
+            uint64_t bit = uint64_t(1) << (observer & 63);
+            if (good) { Row(target)[observer >> 6] |= bit; } else { Row(target)[observer >> 6] &= ~bit; }
+        }
+
+        // Every image is good with probability p_good, independently.
+        void Initialize(CounterRNG& rng, double p_good) {
+            for (size_t t = 0; t < population_size; t++) {
+                private_assessment::BernoulliMask(rng, p_good, population_size, Row(t));
+            }
+        }
+
+        // The donor acts on its own images of itself and the recipient; the action is
+        // returned after implementation errors.
+        int Interact(CounterRNG& rng, size_t donor, size_t recipient) {
+            int own = Image(donor, donor), other = Image(donor, recipient);
+            int action = type_actions[type[donor]][own * 2 + other];
+            if (action == 1 && mu_e > 0.0 && rng.Uniform() < mu_e) { action = 0; }
+            using private_assessment::BernoulliMask;
+            if (action == 0) { BernoulliMask(rng, perception_error, population_size, misperceived.data()); }
+            else { std::fill(misperceived.begin(), misperceived.end(), 0); }
+            BernoulliMask(rng, assessment_error, population_size, flipped.data());
+            BernoulliMask(rng, 1.0 - observation_probability, population_size, hidden.data());
+            private_assessment::UpdateRow(tables[action], Row(donor), Row(recipient),
+                                          misperceived.data(), flipped.data(), hidden.data(), words);
+            if (population_size % 64) { Row(donor)[words - 1] &= (uint64_t(1) << (population_size % 64)) - 1; }
+            return action;
+        }
+
+        // Runs burn_in + rounds rounds of population_size random interactions each and
+        // records actions and image statistics over the last `rounds`.
+        Stats Run(CounterRNG& rng, size_t burn_in, size_t rounds) {
+            Stats stats = EmptyStats();
+            for (size_t round = 0; round < burn_in + rounds; round++) {
+                const bool record = round >= burn_in;
+                for (size_t k = 0; k < population_size; k++) {
+                    size_t donor = rng.Index(population_size);
+                    size_t recipient = rng.Index(population_size - 1);
+                    recipient += (recipient >= donor);
+                    int action = Interact(rng, donor, recipient);
+                    if (record) {
+                        stats.actions[(type[donor] * NumTypes() + type[recipient]) * num_actions + action]++;
+                        stats.interactions++;
+                    }
+                }
+                if (record) { Sample(stats); }
+            }
+            return stats;
+        }
+
+        Stats EmptyStats() const {
+            Stats stats;
+            stats.num_types = NumTypes();
+            stats.num_actions = num_actions;
+            stats.actions.assign(NumTypes() * NumTypes() * num_actions, 0);
+            stats.good.assign(NumTypes(), 0.0);
+            return stats;
+        }
+
+        // Adds the current share of good images per assessed type and the observer agreement.
+        void Sample(Stats& stats) const {
+            std::vector<uint64_t> good_bits(NumTypes(), 0);
+            double agreeing = 0.0;
+            const double n = static_cast<double>(population_size);
+            for (size_t t = 0; t < population_size; t++) {
+                const uint64_t* row = Row(t);
+                uint64_t k = 0;
+                for (size_t w = 0; w < words; w++) { k += __builtin_popcountll(row[w]); }
+                good_bits[type[t]] += k;
+                agreeing += (k * (k - 1.0) + (n - k) * (n - k - 1.0)) / (n * (n - 1.0));
+            }
+            for (size_t i = 0; i < NumTypes(); i++) {
+                stats.good[i] += type_counts[i] > 0 ? good_bits[i] / (n * type_counts[i]) : 0.0;
+            }
+            stats.agreement += agreeing / n;
+            stats.samples += 1.0;
+        }
+
+    private:
+        std::array<std::array<uint8_t, 4>, 3> tables{};
+        std::vector<uint64_t> misperceived, flipped, hidden;   // per-observer masks of one interaction
+};
+
+#endif
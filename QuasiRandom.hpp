@@ -0,0 +1,95 @@
+#ifndef QuasiRandom_H
+#define QuasiRandom_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+
+// Sobol low-discrepancy sequence in up to 16 dimensions with the Joe-Kuo direction
+// numbers, in Gray-code order with 32-bit resolution. Point n is the XOR of the
+// direction numbers selected by the bits of n ^ (n >> 1), so consecutive points differ
+// by one direction number and any block of the sequence can be generated on its own.
+// With 32 direction numbers per dimension the sequence has 2^32 points.
+class SobolSequence {
+    public:
+        static constexpr int MaxDimension = 16;
+        static constexpr int Bits = 32;
+        static constexpr uint64_t MaxPoints = uint64_t(1) << Bits;
+
+        explicit SobolSequence(int dimension) : dimension(dimension) {
+            if (dimension < 1 || dimension > MaxDimension) {
+                throw std::runtime_error("SobolSequence: dimension must be between 1 and 16");
+            }
+            // degree s, coefficients a and initial m_1 ... m_s of the primitive polynomials
+            static const int degree[MaxDimension] = {0, 1, 2, 3, 3, 4, 4, 5, 5, 5, 5, 5, 5, 6, 6, 6};
+            static const uint32_t coeff[MaxDimension] = {0, 0, 1, 1, 2, 1, 4, 2, 4, 7, 11, 13, 14, 1, 13, 16};
+            static const uint32_t initial[MaxDimension][6] = {
+                {}, {1}, {1, 3}, {1, 3, 1}, {1, 1, 1}, {1, 1, 3, 3}, {1, 3, 5, 13}, {1, 1, 5, 5, 17},
+                {1, 1, 5, 5, 5}, {1, 1, 7, 11, 19}, {1, 1, 5, 1, 1}, {1, 1, 1, 3, 11}, {1, 3, 5, 5, 31},
+                {1, 3, 3, 9, 7, 49}, {1, 1, 1, 15, 21, 21}, {1, 3, 1, 13, 27, 49}};
+            for (int j = 0; j < dimension; j++) {
+                auto& v = direction[j];
+                if (j == 0) {
+                    for (int k = 0; k < Bits; k++) { v[k] = uint32_t(1) << (Bits - 1 - k); }
+                    continue;
+                }
+                const int s = degree[j];
+                for (int k = 0; k < s; k++) { v[k] = initial[j][k] << (Bits - 1 - k); }
+                for (int k = s; k < Bits; k++) {
+                    v[k] = v[k - s] ^ (v[k - s] >> s);
+                    for (int i = 1; i < s; i++) {
+                        if ((coeff[j] >> (s - 1 - i)) & 1) { v[k] ^= v[k - i]; }
+                    }
+                }
+            }
+        }
+
+        int Dimension() const { return dimension; }
+
+        // Integer coordinates of point n.
+        void PointBits(uint64_t n, uint32_t* x) const {
+            if (n >= MaxPoints) { throw std::runtime_error("SobolSequence: point index beyond 2^32"); }
+            const uint64_t gray = n ^ (n >> 1);
+            for (int j = 0; j < dimension; j++) {
+                uint32_t value = 0;
+                for (int k = 0; k < Bits; k++) {
+                    if ((gray >> k) & 1) { value ^= direction[j][k]; }
+                }
+                x[j] = value;
+            }
+        }
+
+        void Point(uint64_t n, double* x) const {
+            uint32_t bits[MaxDimension];
+            PointBits(n, bits);
+            for (int j = 0; j < dimension; j++) { x[j] = bits[j] * 0x1.0p-32; }
+        }
+
+        // Points first ... first + count - 1 in structure-of-arrays form: out[j][i] is
+        // coordinate j of point first + i. The first point is computed directly and the
+        // rest by Gray-code updates. A digital shift XORs shift[j] into coordinate j, which
+        // randomizes the sequence while keeping its stratification.
+        void Fill(uint64_t first, size_t count, double* const* out, const uint32_t* shift = nullptr) const {
+            if (count == 0) { return; }
+            if (first >= MaxPoints || count > MaxPoints - first) {
+                throw std::runtime_error("SobolSequence: point index beyond 2^32");
+            }
+            uint32_t x[MaxDimension];
+            PointBits(first, x);
+            for (size_t i = 0; i < count; i++) {
+                if (i > 0) {
+                    const int c = __builtin_ctzll(first + i);
+                    for (int j = 0; j < dimension; j++) { x[j] ^= direction[j][c]; }
+                }
+                for (int j = 0; j < dimension; j++) { out[j][i] = (shift ? x[j] ^ shift[j] : x[j]) * 0x1.0p-32; }
+            }
+        }
+
+    private:
+        int dimension;
+        std::array<std::array<uint32_t, Bits>, MaxDimension> direction{};
+};
+
+#endif
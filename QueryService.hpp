@@ -0,0 +1,279 @@
+#ifndef QueryService_H
+#define QueryService_H
+
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "SweepEngine.hpp"
+#include "ESSBitmap.hpp"
+#include "ResultCache.hpp"
+#include "BatchRunner.hpp"
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <exception>
+#include <sstream>
+#include <iomanip>
+
+
+namespace two_action {
+
+// Answers text queries about two-action norms, one request per line:
+//
+//     ess <norm> <ae> <pe> <mu_e> <b> <c>       verdict, margin, best invader, h, ... of one game
+//     range <norms> <ae> <pe> <mu_e> <b> <c>    the same over grids, streamed as CSV rows
+//     ess_set <ae> <pe> <mu_e> <b> <c>          all ESS norms
+//     stats                                     where the answers came from
+//
+// Norms are IDs (decimal or 0x...), and for range also the norm sets and value grids of
+// BatchRunner manifests. A range reply is a "columns" line, the rows and "end <rows>";
+// every other reply is one line starting with "ok" or "error".
+//
+// Games are looked up in the result cache first; computed ones are added to it, or kept in
+// memory when the cache is read-only, up to `max_memory_entries` with the oldest dropped first. A read-only cache is remapped, if its writer has
+// replaced the file, once per request and per range chunk. ess_set is read from a loaded
+// bitmap store when the point is on its grid.
+class QueryService {
+    public:
+        static constexpr size_t RangeChunk = 4096;
+        static constexpr size_t MaxRangePoints = size_t(1) << 32;
+        static constexpr size_t DefaultMemoryEntries = size_t(1) << 18;   // about 50 MB
+
+        // `cache` may be null; the service adds to it only if it is writable.
+        explicit QueryService(ResultCache* cache = nullptr, unsigned num_threads = 0,
+                              size_t max_memory_entries = DefaultMemoryEntries)
+            : cache(cache), num_threads(num_threads), max_memory_entries(max_memory_entries) {}
+
+        void AddBitmaps(ESSBitmapStore store) {
+            if (store.num_actions != 2) { throw std::runtime_error("QueryService: bitmaps of the two-action model expected"); }
+            bitmaps.push_back(std::move(store));
+        }
+
+        // Writes the reply to `line`; false when the client asked to close ("quit").
+        bool Handle(const std::string& line, std::ostream& out) {
+            std::istringstream in(line);
+            std::vector<std::string> words;
+            for (std::string w; in >> w;) { words.push_back(w); }
+            if (words.empty()) { return true; }
+            out << std::setprecision(12);
+            try {
+                const std::string& command = words[0];
+                if (command == "quit") { return false; }
+                if (command == "ess" || command == "range" || command == "ess_set") { RefreshCache(); }
+                if (command == "ess") { Ess(words, out); }
+                else if (command == "range") { Range(words, out); }
+                else if (command == "ess_set") { EssSet(words, out); }
+                else if (command == "stats") {
+                    out << "ok cached=" << from_cache << " computed=" << computed << " bitmap=" << from_bitmap
+                        << " cache_entries=" << CacheSize() << " memory_entries=" << MemorySize() << "\n";
+                } else {
+                    out << "error unknown command " << command << "\n";
+                }
+            } catch (const std::exception& e) {
+                out << "error " << e.what() << "\n";
+            }
+            out.flush();
+            return true;
+        }
+
+        // Entry of one game: from the cache, from memory or computed. A read-only cache is
+        // not remapped here but once per request by Handle.
+        ResultCache::Entry Evaluate(int norm_id, const ResultCache::Params& p) {
+            ResultCache::Entry entry;
+            {
+                std::shared_lock<std::shared_mutex> lock(mutex);
+                if (Find(norm_id, p, entry)) { return entry; }
+            }
+            Game game(p[0], p[1], p[2], Norm::ConstructFromID(norm_id));
+            entry = ResultCache::Compute(game, p[3], p[4]);
+            computed++;
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            if (!(cache && cache->Writable() && cache->Insert(norm_id, p, entry))) { Remember(norm_id, p, entry); }
+            return entry;
+        }
+
+    private:
+        ResultCache* cache;
+        unsigned num_threads;
+        size_t max_memory_entries;
+        std::vector<ESSBitmapStore> bitmaps;
+        std::map<std::pair<int, ResultCache::Params>, ResultCache::Entry> memory;
+        std::deque<std::pair<int, ResultCache::Params>> memory_order;   // keys of `memory`, oldest first
+        std::shared_mutex mutex;     // cache inserts may remap the file
+        std::atomic<long> from_cache{0}, from_bitmap{0}, computed{0};
+
+        // The writer of a read-only cache may have grown the file since it was mapped.
+        void RefreshCache() {
+            if (!cache || cache->Writable()) { return; }
+            std::unique_lock<std::shared_mutex> lock(mutex);
+            cache->Refresh();
+        }
+
+        // ParallelFor over [0, n) whose workers keep their first exception, which would
+        // otherwise terminate the process; the one of the lowest thread is rethrown here.
+        template <typename Func>
+        void ParallelEvaluate(size_t n, Func&& body) {
+            std::vector<std::exception_ptr> errors(NumWorkerThreads(num_threads));
+            ParallelFor(n, [&](size_t begin, size_t end, unsigned t) {
+                try {
+                    body(begin, end);
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            }, num_threads);
+            for (const auto& e : errors) {
+                if (e) { std::rethrow_exception(e); }
+            }
+        }
+
+        // with `mutex` held
+        bool Find(int norm_id, const ResultCache::Params& p, ResultCache::Entry& entry) {
+            if (cache && cache->Lookup(norm_id, p, entry)) {
+                from_cache++;
+                return true;
+            }
+            auto it = memory.find({norm_id, p});
+            if (it == memory.end()) { return false; }
+            entry = it->second;
+            from_cache++;
+            return true;
+        }
+
+        // with `mutex` held exclusively
+        void Remember(int norm_id, const ResultCache::Params& p, const ResultCache::Entry& entry) {
+            if (max_memory_entries == 0 || !memory.emplace(std::make_pair(norm_id, p), entry).second) { return; }
+            memory_order.emplace_back(norm_id, p);
+            if (memory.size() > max_memory_entries) {
+                memory.erase(memory_order.front());
+                memory_order.pop_front();
+            }
+        }
+
+        size_t MemorySize() {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            return memory.size();
+        }
+
+        // Refresh and Insert may remap the file.
+        size_t CacheSize() {
+            if (!cache) { return 0; }
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            return cache->Size();
+        }
+
+        static int ParseNorm(const std::string& s) {
+            auto ids = batch::detail::ParseNorms(s, batch::Model::TwoAction);
+            if (ids.size() != 1) { throw std::runtime_error("expected a single norm, got " + s); }
+            return ids[0];
+        }
+
+        static ResultCache::Params ParseParams(const std::vector<std::string>& words, size_t first) {
+            if (words.size() != first + 5) { throw std::runtime_error("expected <ae> <pe> <mu_e> <b> <c>"); }
+            ResultCache::Params p;
+            for (int k = 0; k < 5; k++) { p[k] = batch::detail::ToDouble(words[first + k]); }
+            for (int k = 0; k < 3; k++) {
+                if (!(p[k] >= 0.0 && p[k] <= 1.0)) { throw std::runtime_error("error rates must lie in [0, 1]"); }
+            }
+            return p;
+        }
+
+        static void WriteEntry(std::ostream& out, const ResultCache::Entry& e, char sep) {
+            out << e.is_ess << sep << e.ess_margin << sep << e.best_invader << sep << e.h << sep << e.cooperation
+                << sep << e.delta_v;
+        }
+
+        void Ess(const std::vector<std::string>& words, std::ostream& out) {
+            if (words.size() != 7) { throw std::runtime_error("usage: ess <norm> <ae> <pe> <mu_e> <b> <c>"); }
+            const int norm_id = ParseNorm(words[1]);
+            const auto e = Evaluate(norm_id, ParseParams(words, 2));
+            out << "ok norm=" << norm_id << " ess=" << e.is_ess << " margin=" << e.ess_margin << " best_invader="
+                << e.best_invader << " h=" << e.h << " cooperation=" << e.cooperation << " delta_v=" << e.delta_v << "\n";
+        }
+
+        void Range(const std::vector<std::string>& words, std::ostream& out) {
+            if (words.size() != 7) { throw std::runtime_error("usage: range <norms> <ae> <pe> <mu_e> <b> <c>"); }
+            const auto norms = batch::detail::ParseNorms(words[1], batch::Model::TwoAction);
+            std::vector<std::vector<double>> axes;
+            size_t total = norms.size();
+            for (size_t k = 2; k < 7; k++) {
+                axes.push_back(batch::detail::ParseValues(words[k]));
+                total *= axes.back().size();
+                if (total > MaxRangePoints) { throw std::runtime_error("range too large"); }
+            }
+            for (size_t k = 0; k < 3; k++) {
+                for (double x : axes[k]) {
+                    if (!(x >= 0.0 && x <= 1.0)) { throw std::runtime_error("error rates must lie in [0, 1]"); }
+                }
+            }
+            auto point = [&](size_t i, ResultCache::Params& p) {
+                for (size_t k = 5; k-- > 0;) {
+                    p[k] = axes[k][i % axes[k].size()];
+                    i /= axes[k].size();
+                }
+                return norms[i];
+            };
+
+            out << "columns norm,assessment_error,perception_error,mu_e,benefit,cost,"
+                << "is_ess,ess_margin,best_invader,h,cooperation,delta_v\n";
+            std::vector<ResultCache::Entry> chunk(RangeChunk);
+            for (size_t first = 0; first < total; first += RangeChunk) {
+                const size_t n = std::min(RangeChunk, total - first);
+                if (first > 0) { RefreshCache(); }
+                ParallelEvaluate(n, [&](size_t begin, size_t end) {
+                    ResultCache::Params p;
+                    for (size_t i = begin; i < end; i++) {
+                        int id = point(first + i, p);
+                        chunk[i] = Evaluate(id, p);
+                    }
+                });
+                ResultCache::Params p;
+                for (size_t i = 0; i < n; i++) {
+                    out << point(first + i, p);
+                    for (double x : p) { out << "," << x; }
+                    out << ",";
+                    WriteEntry(out, chunk[i], ',');
+                    out << "\n";
+                }
+                out.flush();
+                if (!out) { return; }   // the client went away
+            }
+            out << "end " << total << "\n";
+        }
+
+        void EssSet(const std::vector<std::string>& words, std::ostream& out) {
+            const auto p = ParseParams(words, 1);
+            std::vector<uint32_t> ids;
+            const char* source = "computed";
+            const ESSBitmapStore::Entry* hit = nullptr;
+            for (const auto& store : bitmaps) {
+                for (const auto& e : store.entries) {
+                    const auto& g = e.point;
+                    const double q[5] = {g.assessment_error, g.perception_error, g.mu_e, g.benefit, g.cost};
+                    bool same = true;
+                    for (int k = 0; k < 5; k++) { same = same && std::abs(q[k] - p[k]) < 1e-12; }
+                    if (same) { hit = &e; break; }
+                }
+                if (hit) { break; }
+            }
+            if (hit) {
+                ids = hit->ess.ToVector();
+                source = "bitmap";
+                from_bitmap++;
+            } else {
+                std::vector<uint8_t> ess(4096);
+                ParallelEvaluate(4096, [&](size_t begin, size_t end) {
+                    for (size_t id = begin; id < end; id++) { ess[id] = Evaluate(static_cast<int>(id), p).is_ess; }
+                });
+                for (uint32_t id = 0; id < 4096; id++) { if (ess[id]) { ids.push_back(id); } }
+            }
+            out << "ok source=" << source << " count=" << ids.size() << " ids=";
+            for (size_t i = 0; i < ids.size(); i++) { out << (i ? "," : "") << ids[i]; }
+            out << "\n";
+        }
+};
+
+}  // namespace two_action
+
+#endif
@@ -0,0 +1,326 @@
+#ifndef ResultCache_H
+#define ResultCache_H
+
+#include "Norms.hpp"
+#include "Game.hpp"
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+namespace two_action {
+
+// On-disk table of evaluated games, shared across runs through mmap. Keys are a norm ID
+// and the parameters (assessment_error, perception_error, mu_e, benefit, cost) rounded to
+// multiples of Quantum; values are h, cooperation, the ESS margin, delta_v, the ESS
+// verdict and the best invader of the unrounded parameters.
+//
+// The file is an open-addressing table with linear probing. Any number of processes may
+// read it while a single writer (guarded by an flock on <path>.lock) appends: a slot is
+// filled first and published by its state word last, and is never changed afterwards.
+// When the table is half full the writer rehashes into a new file and renames it over
+// the old one; readers keep their old mapping until Refresh. The header records
+// ModelVersion and a fingerprint of the model code (ModelFingerprint); a file written by
+// other code is ignored by readers and cleared by the writer.
+class ResultCache {
+    public:
+        static constexpr double Quantum = 1e-7;
+        static constexpr uint32_t FormatVersion = 3;
+        // Bump with every change of the results of Game or Compute. The fingerprint below
+        // only samples the model and is a safeguard for a forgotten bump.
+        static constexpr uint32_t ModelVersion = 1;
+
+        struct Entry {
+            double h, cooperation, ess_margin, delta_v;
+            bool is_ess;
+            int best_invader = -1;   // deterministic action rule attaining the margin
+        };
+
+        using Params = std::array<double, 5>;
+
+        // Entry of `game` at (benefit, cost).
+        static Entry Compute(const Game& game, double benefit, double cost) {
+            int best = -1;
+            double margin = game.calc_ess_margin(benefit, cost, &best);
+            return {game.equilibrium_state, game.resident_coop, margin, game.calc_delta_v(benefit, cost),
+                    game.isESS(benefit, cost), best};
+        }
+
+        // Hash of the results of reference games. Besides an interior point of every reference
+        // norm, the probes cover the edges of the formulas: no errors (mu_e = 0), c2 = 0 in
+        // the equilibrium state (image scoring with ALLC) and invaders tying with the
+        // residents (all-bad assessment with DISC, where ALLD earns the residents' zero).
+        static uint64_t ModelFingerprint() {
+            static const uint64_t fingerprint = [] {
+                uint64_t hash = 0xcbf29ce484222325ULL ^ FormatVersion;
+                auto mix = [&hash](double x) {
+                    uint64_t bits;
+                    std::memcpy(&bits, &x, sizeof(bits));
+                    for (int i = 0; i < 8; i++) { hash = (hash ^ ((bits >> (8 * i)) & 0xFF)) * 0x100000001b3ULL; }
+                };
+                const Norm norms[] = {Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(), Norm::L5(), Norm::L6(),
+                                      Norm::L7(), Norm::L8(), Norm::ConstructFromID(765), Norm::ConstructFromID(3598),
+                                      Norm::ConstructFromID(2735), Norm::ConstructFromID(10)};
+                const Params points[] = {{0.02, 0.03, 0.05, 1.0, 0.3}, {0.0, 0.0, 0.0, 1.0, 0.3}};
+                for (const auto& norm : norms) {
+                    for (const auto& p : points) {
+                        Game game(p[0], p[1], p[2], norm);
+                        Entry e = Compute(game, p[3], p[4]);
+                        for (double x : {e.h, e.cooperation, e.ess_margin, e.delta_v, e.is_ess ? 1.0 : 0.0,
+                                         static_cast<double>(e.best_invader)}) { mix(x); }
+                    }
+                }
+                return hash;
+            }();
+            return fingerprint;
+        }
+
+        // Opens `path` for reading, or for reading and appending when `writable`; a missing
+        // file is empty for readers and created by the writer.
+        explicit ResultCache(const std::string& path, bool writable = false, uint64_t initial_capacity = 1 << 16)
+            : path(path), writable(writable) {
+            if (writable) {
+                lock_fd = ::open((path + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+                if (lock_fd < 0 || ::flock(lock_fd, LOCK_EX | LOCK_NB) != 0) {
+                    if (lock_fd >= 0) { ::close(lock_fd); }
+                    throw std::runtime_error("ResultCache: " + path + " is locked by another writer");
+                }
+                capacity = 16;
+                while (capacity < initial_capacity) { capacity *= 2; }
+            }
+            Map();
+        }
+
+        ~ResultCache() {
+            Unmap();
+            if (lock_fd >= 0) { ::close(lock_fd); }
+        }
+
+        ResultCache(const ResultCache&) = delete;
+        ResultCache& operator=(const ResultCache&) = delete;
+
+        bool Writable() const { return writable; }
+        uint64_t Size() const { return header ? header->count : 0; }
+        uint64_t Capacity() const { return header ? header->capacity : 0; }
+
+        bool Lookup(int norm_id, const Params& params, Entry& entry) const {
+            Key key;
+            if (!header || !MakeKey(norm_id, params, key)) { return false; }
+            const uint64_t mask = header->capacity - 1;
+            for (uint64_t i = Hash(key) & mask;; i = (i + 1) & mask) {
+                const Slot& slot = slots[i];
+                if (__atomic_load_n(&slot.state, __ATOMIC_ACQUIRE) == 0) { return false; }
+                if (slot.norm_id == key.norm_id && std::memcmp(slot.q, key.q, sizeof(key.q)) == 0) {
+                    entry = {slot.h, slot.cooperation, slot.ess_margin, slot.delta_v, slot.is_ess != 0, slot.best_invader};
+                    return true;
+                }
+            }
+        }
+
+        // Adds an entry unless its key is present; false when the parameters cannot be keyed.
+        bool Insert(int norm_id, const Params& params, const Entry& entry) {
+            if (!writable) { throw std::runtime_error("ResultCache: " + path + " is opened read-only"); }
+            Key key;
+            if (!MakeKey(norm_id, params, key)) { return false; }
+            if (2 * (header->count + 1) > header->capacity) { Grow(); }
+            Slot* slot = Probe(slots, header->capacity, key);
+            if (slot->state != 0) { return true; }
+            Fill(*slot, key, entry);
+            header->count++;
+            return true;
+        }
+
+        // Remaps the file if the writer has replaced it since it was opened.
+        void Refresh() {
+            struct stat st;
+            if (::stat(path.c_str(), &st) == 0 && (!header || st.st_ino != inode)) {
+                Unmap();
+                Map();
+            }
+        }
+
+    private:
+        struct Header {
+            char magic[8];
+            uint32_t format;
+            uint32_t slot_size;
+            uint64_t fingerprint;
+            uint64_t capacity;
+            uint64_t count;
+            uint32_t model_version;
+            char reserved[20];
+        };
+
+        struct Slot {
+            uint32_t state;            // 0 empty, 1 published
+            int32_t norm_id;
+            int32_t q[5];
+            uint16_t is_ess;
+            int16_t best_invader;
+            double h, cooperation, ess_margin, delta_v;
+        };
+        static_assert(sizeof(Header) == 64 && sizeof(Slot) == 64, "ResultCache: unexpected layout");
+
+        struct Key {
+            int32_t norm_id;
+            int32_t q[5];
+        };
+
+        std::string path;
+        bool writable;
+        int lock_fd = -1;
+        uint64_t capacity = 0;         // of a new file
+        Header* header = nullptr;
+        Slot* slots = nullptr;
+        size_t mapped_size = 0;
+        ino_t inode = 0;
+
+        static bool MakeKey(int norm_id, const Params& params, Key& key) {
+            key.norm_id = norm_id;
+            for (int k = 0; k < 5; k++) {
+                double q = std::round(params[k] / Quantum);
+                if (!(std::abs(q) < 2147483647.0)) { return false; }
+                key.q[k] = static_cast<int32_t>(q);
+            }
+            return true;
+        }
+
+        static uint64_t Hash(const Key& key) {
+            uint64_t h = static_cast<uint32_t>(key.norm_id) * 0x9e3779b97f4a7c15ULL;
+            for (int32_t q : key.q) {
+                h = (h ^ static_cast<uint32_t>(q)) * 0xbf58476d1ce4e5b9ULL;
+                h ^= h >> 29;
+            }
+            return h;
+        }
+
+        static Slot* Probe(Slot* table, uint64_t table_capacity, const Key& key) {
+            const uint64_t mask = table_capacity - 1;
+            for (uint64_t i = Hash(key) & mask;; i = (i + 1) & mask) {
+                Slot& slot = table[i];
+                if (slot.state == 0 || (slot.norm_id == key.norm_id && std::memcmp(slot.q, key.q, sizeof(key.q)) == 0)) {
+                    return &slot;
+                }
+            }
+        }
+
+        static void Fill(Slot& slot, const Key& key, const Entry& entry) {
+            slot.norm_id = key.norm_id;
+            std::memcpy(slot.q, key.q, sizeof(key.q));
+            slot.is_ess = entry.is_ess;
+            slot.best_invader = static_cast<int16_t>(entry.best_invader);
+            slot.h = entry.h;
+            slot.cooperation = entry.cooperation;
+            slot.ess_margin = entry.ess_margin;
+            slot.delta_v = entry.delta_v;
+            __atomic_store_n(&slot.state, 1u, __ATOMIC_RELEASE);
+        }
+
+        static bool Valid(const Header* h, size_t size) {
+            return size >= sizeof(Header) && std::memcmp(h->magic, "IRCACHE", 8) == 0 && h->format == FormatVersion
+                && h->slot_size == sizeof(Slot) && h->model_version == ModelVersion && h->fingerprint == ModelFingerprint()
+                && h->capacity > 0 && (h->capacity & (h->capacity - 1)) == 0
+                && size == sizeof(Header) + h->capacity * sizeof(Slot);
+        }
+
+        // Creates an empty table of `table_capacity` slots at `file`.
+        static void Create(const std::string& file, uint64_t table_capacity) {
+            int fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) { throw std::runtime_error("ResultCache: cannot create " + file); }
+            Header h{};
+            std::memcpy(h.magic, "IRCACHE", 8);
+            h.format = FormatVersion;
+            h.slot_size = sizeof(Slot);
+            h.fingerprint = ModelFingerprint();
+            h.model_version = ModelVersion;
+            h.capacity = table_capacity;
+            bool ok = ::ftruncate(fd, sizeof(Header) + table_capacity * sizeof(Slot)) == 0
+                   && ::pwrite(fd, &h, sizeof(h), 0) == static_cast<ssize_t>(sizeof(h));
+            ::close(fd);
+            if (!ok) { throw std::runtime_error("ResultCache: cannot write " + file); }
+        }
+
+        // Maps `file` if it holds a valid table.
+        static bool MapFile(const std::string& file, bool writable, Header*& h, size_t& size, ino_t& ino) {
+            int fd = ::open(file.c_str(), writable ? O_RDWR : O_RDONLY);
+            if (fd < 0) { return false; }
+            struct stat st;
+            void* p = MAP_FAILED;
+            if (::fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(Header))) {
+                p = ::mmap(nullptr, st.st_size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+            }
+            ::close(fd);
+            if (p == MAP_FAILED) { return false; }
+            if (!Valid(static_cast<Header*>(p), st.st_size)) {
+                ::munmap(p, st.st_size);
+                return false;
+            }
+            h = static_cast<Header*>(p);
+            size = st.st_size;
+            ino = st.st_ino;
+            return true;
+        }
+
+        void Map() {
+            if (!MapFile(path, writable, header, mapped_size, inode)) {
+                if (!writable) { return; }
+                // missing, damaged or written by other model code: start over
+                Create(path + ".tmp", capacity);
+                if (::rename((path + ".tmp").c_str(), path.c_str()) != 0 || !MapFile(path, true, header, mapped_size, inode)) {
+                    throw std::runtime_error("ResultCache: cannot replace " + path);
+                }
+            }
+            slots = reinterpret_cast<Slot*>(header + 1);
+        }
+
+        void Unmap() {
+            if (header) { ::munmap(header, mapped_size); }
+            header = nullptr;
+            slots = nullptr;
+            mapped_size = 0;
+        }
+
+        // Rehashes into a table of twice the capacity and renames it over the old file.
+        void Grow() {
+            const std::string next = path + ".tmp";
+            Create(next, 2 * header->capacity);
+            Header* grown;
+            size_t grown_size;
+            ino_t grown_inode;
+            if (!MapFile(next, true, grown, grown_size, grown_inode)) {
+                throw std::runtime_error("ResultCache: cannot map " + next);
+            }
+            Slot* grown_slots = reinterpret_cast<Slot*>(grown + 1);
+            for (uint64_t i = 0; i < header->capacity; i++) {
+                const Slot& slot = slots[i];
+                if (slot.state == 0) { continue; }
+                Key key;
+                key.norm_id = slot.norm_id;
+                std::memcpy(key.q, slot.q, sizeof(key.q));
+                Fill(*Probe(grown_slots, grown->capacity, key), key,
+                     {slot.h, slot.cooperation, slot.ess_margin, slot.delta_v, slot.is_ess != 0, slot.best_invader});
+                grown->count++;
+            }
+            ::munmap(grown, grown_size);
+            if (::rename(next.c_str(), path.c_str()) != 0) {
+                throw std::runtime_error("ResultCache: cannot replace " + path);
+            }
+            Unmap();
+            Map();
+        }
+};
+
+}  // namespace two_action
+
+#endif
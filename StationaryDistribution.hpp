@@ -0,0 +1,147 @@
+#ifndef StationaryDistribution_H
+#define StationaryDistribution_H
+
+#include "SweepEngine.hpp"
+
+#include <vector>
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+
+// Fixation probability of a single mutant in a resident population of size N under
+// pairwise-comparison (Fermi) imitation with selection strength s. The payoffs at
+// intermediate frequencies are interpolated linearly between the four monomorphic
+// limits: p_rr (resident among residents), p_rm (resident as a rare invader of the
+// mutant population), p_mr (mutant as a rare invader of the residents) and p_mm
+// (mutant among mutants).
+//
+// With k mutants the payoff difference is linear in k, d(k) = u + v k, so the
+// product of transition ratios is exp(E(i)) with E quadratic in i and
+//     rho = 1 / sum_{i=0}^{N-1} exp(E(i)),   E(i) = -s (u i + v i (i + 1) / 2).
+// The sum is evaluated around its largest term with the ratio recursion
+// exp(E(i+1) - E(i)) = exp(-s (u + v (i + 1))), so each pair needs a handful of exps.
+inline double FixationProbability(double p_rr, double p_rm, double p_mr, double p_mm, int N, double s) {
+    const double n1 = N - 1.0;
+    const double u = (N * p_mr - p_mm - n1 * p_rr) / n1;
+    const double v = (p_mm - p_mr - p_rm + p_rr) / n1;
+    auto E = [&](double i) { return -s * (u * i + v * i * (i + 1.0) / 2.0); };
+
+    // index of the largest term: the integer points around the vertex and the ends
+    int top = 0;
+    double e_top = 0.0;
+    auto consider = [&](double x) {
+        int i = static_cast<int>(std::min(std::max(std::round(x), 0.0), n1));
+        double e = E(i);
+        if (e > e_top) { e_top = e; top = i; }
+    };
+    consider(n1);
+    if (s * v != 0.0) { consider(-u / v - 0.5); }
+
+    // sum of exp(E(i) - E(top)) walking up and down from top; the ratio of consecutive
+    // terms changes by exp(-s v) per step in both directions
+    const double step = std::exp(-s * v);
+    auto walk = [&](int dir, int last) {
+        double partial = 0.0, term = 1.0;
+        double ratio = (dir > 0) ? std::exp(-s * (u + v * (top + 1))) : std::exp(s * (u + v * top));
+        for (int i = top + dir; dir * (last - i) >= 0; i += dir) {
+            if (term > 1e-250 && std::isfinite(ratio)) { term *= ratio; }
+            else { term = std::exp(E(i) - e_top); }   // recursion under- or overflowed
+            ratio *= step;
+            partial += term;
+        }
+        return partial;
+    };
+    double sum = 1.0 + walk(+1, N - 1) + walk(-1, 0);
+    return std::exp(-e_top) / sum;
+}
+
+// Embedded Markov chain of the small-mutation limit: a mutant of a uniformly chosen
+// other type appears and either fixes or goes extinct before the next mutation.
+class MoranChain {
+    public:
+        size_t n;
+        std::vector<double> transition;   // row-major n x n, rows sum to one
+
+        // payoffs(i, j) returns the payoff of type j as a rare invader of a population of
+        // type i; payoffs(i, i) is the resident payoff of type i.
+        template <typename Payoffs>
+        MoranChain(size_t n, Payoffs payoffs, int population_size, double selection_strength,
+                   unsigned num_threads = 0) : n(n), transition(n * n, 0.0) {
+            if (n < 2) { throw std::runtime_error("MoranChain: need at least two types"); }
+            std::vector<double> self(n);
+            for (size_t i = 0; i < n; i++) { self[i] = payoffs(i, i); }
+            ParallelFor(n, [&](size_t begin, size_t end, unsigned) {
+                for (size_t i = begin; i < end; i++) {
+                    double* row = transition.data() + i * n;
+                    double stay = 1.0;
+                    for (size_t j = 0; j < n; j++) {
+                        if (j == i) { continue; }
+                        double rho = FixationProbability(self[i], payoffs(j, i), payoffs(i, j), self[j],
+                                                         population_size, selection_strength);
+                        row[j] = rho / (n - 1.0);
+                        stay -= row[j];
+                    }
+                    row[i] = stay;
+                }
+            }, num_threads);
+        }
+
+        // Stationary distribution by the Grassmann-Taksar-Heyman elimination, which only uses
+        // off-diagonal entries and no subtractions, so it stays accurate when selection makes
+        // the transition probabilities span many orders of magnitude. O(n^3), parallel over rows.
+        std::vector<double> StationaryGTH(unsigned num_threads = 0) const {
+            std::vector<double> p = transition;
+            for (size_t k = n - 1; k >= 1; k--) {
+                double* row_k = p.data() + k * n;
+                double s = 0.0;
+                for (size_t j = 0; j < k; j++) { s += row_k[j]; }
+                ParallelFor(k, [&](size_t begin, size_t end, unsigned) {
+                    for (size_t i = begin; i < end; i++) {
+                        double* row_i = p.data() + i * n;
+                        double f = row_i[k] / s;
+                        row_i[k] = f;
+                        for (size_t j = 0; j < k; j++) { row_i[j] += f * row_k[j]; }
+                    }
+                }, num_threads);
+            }
+            std::vector<double> pi(n, 0.0);
+            pi[0] = 1.0;
+            double total = 1.0;
+            for (size_t k = 1; k < n; k++) {
+                double x = 0.0;
+                for (size_t i = 0; i < k; i++) { x += pi[i] * p[i * n + k]; }
+                pi[k] = x;
+                total += x;
+            }
+            for (double& x : pi) { x /= total; }
+            return pi;
+        }
+
+        // Stationary distribution by power iteration pi <- pi T, starting from the uniform
+        // distribution, until the L1 change drops below `tolerance`.
+        std::vector<double> StationaryPowerIteration(double tolerance = 1e-12, size_t max_iterations = 100000,
+                                                     unsigned num_threads = 0) const {
+            std::vector<double> pi(n, 1.0 / n), next(n);
+            for (size_t it = 0; it < max_iterations; it++) {
+                ParallelFor(n, [&](size_t begin, size_t end, unsigned) {
+                    for (size_t j = begin; j < end; j++) { next[j] = 0.0; }
+                    for (size_t i = 0; i < n; i++) {
+                        const double* row = transition.data() + i * n;
+                        for (size_t j = begin; j < end; j++) { next[j] += pi[i] * row[j]; }
+                    }
+                }, num_threads);
+                double change = 0.0, total = 0.0;
+                for (size_t j = 0; j < n; j++) { total += next[j]; }
+                for (size_t j = 0; j < n; j++) {
+                    next[j] /= total;
+                    change += std::abs(next[j] - pi[j]);
+                }
+                pi.swap(next);
+                if (change < tolerance) { break; }
+            }
+            return pi;
+        }
+};
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef SweepEngine_H
+#define SweepEngine_H
+
+#include <vector>
+#include <thread>
+#include <limits>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+
+inline unsigned NumWorkerThreads(unsigned requested = 0) {
+    if (requested > 0) { return requested; }
+    unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+// Calls body(begin, end, thread_id) on contiguous blocks of [0, n), one block per thread.
+template <typename Func>
+void ParallelFor(size_t n, Func&& body, unsigned num_threads = 0) {
+    unsigned n_threads = std::min<size_t>(NumWorkerThreads(num_threads), std::max<size_t>(n, 1));
+    if (n_threads == 1) {
+        body(size_t(0), n, 0u);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < n_threads; t++) {
+        size_t begin = n * t / n_threads;
+        size_t end = n * (t + 1) / n_threads;
+        workers.emplace_back([&body, begin, end, t]() { body(begin, end, t); });
+    }
+    for (auto& worker : workers) { worker.join(); }
+}
+
+// Evaluates body(i, sink) for every i in [0, n) into per-thread copies of `prototype`
+// and merges the partials in thread order, so the result does not depend on timing.
+template <typename Sink, typename Func>
+Sink ParallelReduce(size_t n, const Sink& prototype, Func&& body, unsigned num_threads = 0) {
+    unsigned n_threads = std::min<size_t>(NumWorkerThreads(num_threads), std::max<size_t>(n, 1));
+    std::vector<Sink> partials(n_threads, prototype);
+    ParallelFor(n, [&](size_t begin, size_t end, unsigned t) {
+        for (size_t i = begin; i < end; i++) {
+            body(i, partials[t]);
+        }
+    }, n_threads);
+    Sink result = prototype;
+    for (const auto& partial : partials) {
+        result.Merge(partial);
+    }
+    return result;
+}
+
+
+// Number of points per class, e.g. the classes of JudgeClass.
+class CountSink {
+    public:
+        std::vector<long> counts;
+
+        explicit CountSink(size_t num_classes) : counts(num_classes, 0) {}
+
+        void Add(size_t cls, long n = 1) { counts.at(cls) += n; }
+
+        void Merge(const CountSink& other) {
+            for (size_t i = 0; i < counts.size(); i++) { counts[i] += other.counts[i]; }
+        }
+
+        void Write(std::ostream& os) const {
+            os << "class,count\n";
+            for (size_t i = 0; i < counts.size(); i++) { os << i << "," << counts[i] << "\n"; }
+        }
+};
+
+// Fixed-width histogram on [lower, upper); values outside are counted separately.
+class HistogramSink {
+    public:
+        double lower, upper;
+        std::vector<long> counts;
+        long underflow = 0, overflow = 0;
+
+        HistogramSink(double lower, double upper, size_t bins) : lower(lower), upper(upper), counts(bins, 0) {
+            if (bins == 0 || !(upper > lower)) {
+                throw std::runtime_error("HistogramSink: need at least one bin and upper > lower");
+            }
+        }
+
+        void Add(double x) {
+            if (x < lower) { underflow++; return; }
+            if (x >= upper) { overflow++; return; }
+            size_t bin = static_cast<size_t>((x - lower) / (upper - lower) * counts.size());
+            counts[std::min(bin, counts.size() - 1)]++;
+        }
+
+        void Merge(const HistogramSink& other) {
+            for (size_t i = 0; i < counts.size(); i++) { counts[i] += other.counts[i]; }
+            underflow += other.underflow;
+            overflow += other.overflow;
+        }
+
+        void Write(std::ostream& os) const {
+            os << "bin_lower,bin_upper,count\n";
+            double width = (upper - lower) / counts.size();
+            for (size_t i = 0; i < counts.size(); i++) {
+                os << lower + i * width << "," << lower + (i + 1) * width << "," << counts[i] << "\n";
+            }
+        }
+};
+
+// Minimum and maximum of a value together with the index of the point attaining it.
+// Ties are resolved towards the smaller index.
+class ExtremumSink {
+    public:
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        long argmin = -1, argmax = -1;
+        long count = 0;
+
+        void Add(double value, long index) {
+            if (value < min || (value == min && index < argmin)) { min = value; argmin = index; }
+            if (value > max || (value == max && index < argmax)) { max = value; argmax = index; }
+            count++;
+        }
+
+        void Merge(const ExtremumSink& other) {
+            if (other.count == 0) { return; }
+            if (other.min < min || (other.min == min && other.argmin < argmin)) { min = other.min; argmin = other.argmin; }
+            if (other.max > max || (other.max == max && other.argmax < argmax)) { max = other.max; argmax = other.argmax; }
+            count += other.count;
+        }
+};
+
+// Mean of a value over the points falling in each cell of an nx x ny raster,
+// e.g. the ESS fraction over (perception_error, mu_e) cells.
+class GridSink {
+    public:
+        size_t nx, ny;
+        double x_lower, x_upper, y_lower, y_upper;
+        std::vector<double> sums;
+        std::vector<long> counts;
+
+        GridSink(size_t nx, double x_lower, double x_upper, size_t ny, double y_lower, double y_upper)
+            : nx(nx), ny(ny), x_lower(x_lower), x_upper(x_upper), y_lower(y_lower), y_upper(y_upper),
+              sums(nx * ny, 0.0), counts(nx * ny, 0) {
+            if (nx == 0 || ny == 0 || !(x_upper > x_lower) || !(y_upper > y_lower)) {
+                throw std::runtime_error("GridSink: invalid raster");
+            }
+        }
+
+        // Points on the upper edge fall into the last cell; points outside are ignored.
+        void Add(double x, double y, double value) {
+            if (x < x_lower || x > x_upper || y < y_lower || y > y_upper) { return; }
+            size_t ix = std::min(static_cast<size_t>((x - x_lower) / (x_upper - x_lower) * nx), nx - 1);
+            size_t iy = std::min(static_cast<size_t>((y - y_lower) / (y_upper - y_lower) * ny), ny - 1);
+            sums[iy * nx + ix] += value;
+            counts[iy * nx + ix]++;
+        }
+
+        double Mean(size_t ix, size_t iy) const {
+            size_t k = iy * nx + ix;
+            return counts[k] > 0 ? sums[k] / counts[k] : std::nan("");
+        }
+
+        void Merge(const GridSink& other) {
+            for (size_t k = 0; k < sums.size(); k++) {
+                sums[k] += other.sums[k];
+                counts[k] += other.counts[k];
+            }
+        }
+
+        // Rows are "<prefix>x,y,count,mean" with the lower cell corner; empty cells are skipped.
+        void Write(std::ostream& os, const std::string& prefix = "") const {
+            double dx = (x_upper - x_lower) / nx, dy = (y_upper - y_lower) / ny;
+            for (size_t iy = 0; iy < ny; iy++) {
+                for (size_t ix = 0; ix < nx; ix++) {
+                    if (counts[iy * nx + ix] == 0) { continue; }
+                    os << prefix << x_lower + ix * dx << "," << y_lower + iy * dy << ","
+                       << counts[iy * nx + ix] << "," << Mean(ix, iy) << "\n";
+                }
+            }
+        }
+};
+
+// One GridSink per key, e.g. a raster over (perception_error, mu_e) per assessment_error.
+class KeyedGridSink {
+    public:
+        std::vector<GridSink> keys;
+
+        KeyedGridSink(size_t num_keys, const GridSink& prototype) : keys(num_keys, prototype) {}
+
+        void Add(size_t key, double x, double y, double value) { keys.at(key).Add(x, y, value); }
+
+        void Merge(const KeyedGridSink& other) {
+            for (size_t i = 0; i < keys.size(); i++) { keys[i].Merge(other.keys[i]); }
+        }
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "AgentSimulator.hpp"
+
+#include <chrono>
+#include <iomanip>
+
+using namespace two_action;
+
+
+// Compares the agent-based simulation of a resident norm and a rare invader
+// against the analytic values of Game.
+int main(int argc, char* argv[]) {
+    if (argc < 8 || argc > 12) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <norm ID> <invader action rule ID> <assessment_error> <perception_error> <mu_e> <benefit> <cost>"
+                  << " [population_size=1000] [rounds=20000] [replicates=8] [seed=1]" << std::endl;
+        return 1;
+    }
+    Norm norm = Norm::ConstructFromID(std::stoi(argv[1]));
+    ActionRule invader = ActionRule::MakeDeterministicRule(std::stoi(argv[2]));
+    double assessment_error = std::stod(argv[3]);
+    double perception_error = std::stod(argv[4]);
+    double mu_e = std::stod(argv[5]);
+    double benefit = std::stod(argv[6]);
+    double cost = std::stod(argv[7]);
+    size_t population_size = (argc > 8) ? std::stoul(argv[8]) : 1000;
+    size_t rounds = (argc > 9) ? std::stoul(argv[9]) : 20000;
+    size_t replicates = (argc > 10) ? std::stoul(argv[10]) : 8;
+    uint64_t seed = (argc > 11) ? std::stoull(argv[11]) : 1;
+
+    Game game(assessment_error, perception_error, mu_e, norm);
+    auto [H, coop_mut_to_res, coop_res_to_mut] = game.calc_invader_stats(invader);
+
+    AgentSimulator sim(assessment_error, perception_error, mu_e, norm, invader, population_size, population_size / 10);
+    auto start = std::chrono::steady_clock::now();
+    auto result = sim.Run(benefit, cost, rounds / 10, rounds, replicates, 20, seed);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::setw(18) << "quantity" << std::setw(12) << "analytic"
+              << std::setw(12) << "simulated" << std::setw(12) << "+/- 95%" << std::endl;
+    auto print = [](const std::string& name, double analytic, const Estimate& e) {
+        std::cout << std::setw(18) << name << std::setw(12) << analytic << std::setw(12) << e.mean
+                  << std::setw(12) << e.half_width << (e.Contains(analytic) ? "" : "  *") << std::endl;
+    };
+    print("h", game.equilibrium_state, result.h);
+    print("resident_coop", game.resident_coop, result.resident_coop);
+    print("resident_payoff", (benefit - cost) * game.resident_coop, result.resident_payoff);
+    print("invader_h", H, result.invader_h);
+    print("coop_mut_to_res", coop_mut_to_res, result.coop_mut_to_res);
+    print("coop_res_to_mut", coop_res_to_mut, result.coop_res_to_mut);
+    print("invader_payoff", benefit * coop_res_to_mut - cost * coop_mut_to_res, result.invader_payoff);
+    std::cout << result.interactions << " interactions in " << seconds << " s ("
+              << result.interactions / seconds / result.threads << " per second per thread, "
+              << result.threads << " threads)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "BatchRunner.hpp"
+
+#include <fstream>
+#include <chrono>
+
+using namespace two_action;
+
+
+// Runs every job of a manifest (see BatchRunner.hpp and figures.manifest) in one pass:
+// each distinct game is built once and shared by all the jobs that need it. Outputs are
+// written to the files named by the jobs, relative to the output directory. With a cache
+// file (ResultCache.hpp), two-action results of earlier runs are reused and new ones added.
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 5) {
+        std::cerr << "Usage: " << argv[0] << " <manifest> [output directory=.] [threads=0] [cache file]" << std::endl;
+        return 1;
+    }
+    std::string base = (argc >= 3) ? std::string(argv[2]) + "/" : "";
+    unsigned num_threads = (argc >= 4) ? std::stoul(argv[3]) : 0;
+
+    std::ifstream manifest(argv[1]);
+    if (!manifest.is_open()) {
+        std::cerr << "Error opening manifest!" << std::endl;
+        return 1;
+    }
+    std::vector<batch::Job> jobs;
+    try {
+        jobs = batch::ParseManifest(manifest);
+    } catch (const std::exception& e) {
+        std::cerr << argv[1] << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    batch::BatchRunner runner(std::move(jobs));
+    std::unique_ptr<ResultCache> cache;
+    if (argc == 5) {
+        cache.reset(new ResultCache(argv[4], true));
+        runner.cache = cache.get();
+    }
+    runner.Run(num_threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << runner.jobs.size() << " jobs, " << runner.num_points << " points, " << runner.num_games
+              << " distinct games";
+    if (cache) { std::cout << ", " << runner.cache_hits << " cache hits (" << cache->Size() << " cached)"; }
+    std::cout << ", done in " << seconds << " s" << std::endl;
+
+    for (size_t j = 0; j < runner.jobs.size(); j++) {
+        std::ofstream file(base + runner.jobs[j].output);
+        if (!file.is_open()) {
+            std::cerr << "Error opening file " << base + runner.jobs[j].output << "!" << std::endl;
+            return 1;
+        }
+        runner.Write(j, file);
+        std::cout << runner.jobs[j].name << ": " << runner.jobs[j].NumPoints() << " points -> "
+                  << runner.jobs[j].output << std::endl;
+    }
+    return 0;
+}
@@ -3,6 +3,8 @@
 #include "AllNorms.hpp"
 #include <fstream>
 
+using namespace two_action;
+
 void writeCSV(const std::vector<std::tuple<int, int, double, double, double, double, double, double>>& output, const std::string& filename) {
     std::ofstream file(filename);
 
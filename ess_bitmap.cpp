@@ -0,0 +1,97 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "SweepEngine.hpp"
+#include "ESSBitmap.hpp"
+
+using namespace two_action;
+
+
+void PrintUsage(const char* name) {
+    std::cerr << "Usage:\n"
+              << "  " << name << " build <file> <benefit> <cost> <max_error> <steps>\n"
+              << "  " << name << " info <file>\n"
+              << "  " << name << " intersect <file> [ae_lo ae_hi pe_lo pe_hi mu_lo mu_hi]\n"
+              << "  " << name << " union <file> [ae_lo ae_hi pe_lo pe_hi mu_lo mu_hi]\n"
+              << "  " << name << " norm <file> <norm_id>" << std::endl;
+}
+
+// ESS bitmaps of all 4096 deterministic norms on a (steps + 1)^3 grid over [0, max_error]^3.
+ESSBitmapStore Build(double benefit, double cost, double max_error, int steps) {
+    std::vector<ESSBitmapStore::GridPoint> points;
+    for (int i = 0; i <= steps; i++) {
+        for (int j = 0; j <= steps; j++) {
+            for (int k = 0; k <= steps; k++) {
+                points.push_back({max_error * i / steps, max_error * j / steps, max_error * k / steps, benefit, cost});
+            }
+        }
+    }
+    ESSBitmapStore store(2);
+    store.entries.resize(points.size());
+    ParallelFor(points.size(), [&](size_t begin, size_t end, unsigned) {
+        for (size_t p = begin; p < end; p++) {
+            const auto& x = points[p];
+            store.entries[p].point = x;
+            for (int id = 0; id < 4096; id++) {
+                Game sim(x.assessment_error, x.perception_error, x.mu_e, Norm::ConstructFromID(id));
+                if (sim.isESS(x.benefit, x.cost)) { store.entries[p].ess.Add(id); }
+            }
+        }
+    });
+    return store;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    std::string command = argv[1];
+    std::string file = argv[2];
+
+    if (command == "build") {
+        if (argc != 7) { PrintUsage(argv[0]); return 1; }
+        ESSBitmapStore store = Build(std::stod(argv[3]), std::stod(argv[4]), std::stod(argv[5]), std::stoi(argv[6]));
+        store.Save(file);
+        size_t bytes = 0;
+        for (const auto& e : store.entries) { bytes += e.ess.SerializedSize(); }
+        std::cout << store.entries.size() << " grid points, " << bytes << " bytes of bitmaps" << std::endl;
+        return 0;
+    }
+
+    ESSBitmapStore store = ESSBitmapStore::Load(file);
+
+    if (command == "info") {
+        std::cout << "actions: " << store.num_actions << ", grid points: " << store.entries.size() << "\n";
+        std::cout << "assessment_error,perception_error,mu_e,benefit,cost,num_ess\n";
+        for (const auto& e : store.entries) {
+            const auto& x = e.point;
+            std::cout << x.assessment_error << "," << x.perception_error << "," << x.mu_e << ","
+                      << x.benefit << "," << x.cost << "," << e.ess.Cardinality() << "\n";
+        }
+    } else if (command == "intersect" || command == "union") {
+        if (argc != 3 && argc != 9) { PrintUsage(argv[0]); return 1; }
+        std::array<double, 6> box = {-1.0, 2.0, -1.0, 2.0, -1.0, 2.0};
+        for (int i = 0; i < argc - 3; i++) { box[i] = std::stod(argv[3 + i]); }
+        auto in_region = [&box](const ESSBitmapStore::GridPoint& x) {
+            return box[0] <= x.assessment_error && x.assessment_error <= box[1] &&
+                   box[2] <= x.perception_error && x.perception_error <= box[3] &&
+                   box[4] <= x.mu_e && x.mu_e <= box[5];
+        };
+        RoaringBitmap result = (command == "intersect") ? store.IntersectRegion(in_region) : store.UnionRegion(in_region);
+        std::cout << "count: " << result.Cardinality() << "\n";
+        for (uint32_t id : result.ToVector()) { std::cout << id << "\n"; }
+    } else if (command == "norm") {
+        if (argc != 4) { PrintUsage(argv[0]); return 1; }
+        uint32_t id = std::stoul(argv[3]);
+        std::cout << "assessment_error,perception_error,mu_e,benefit,cost,isESS\n";
+        for (const auto& e : store.entries) {
+            const auto& x = e.point;
+            std::cout << x.assessment_error << "," << x.perception_error << "," << x.mu_e << ","
+                      << x.benefit << "," << x.cost << "," << e.ess.Contains(id) << "\n";
+        }
+    } else {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    return 0;
+}
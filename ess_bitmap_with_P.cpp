@@ -0,0 +1,47 @@
+#include "NormsWithPunishment.hpp"
+#include "GameWithPunishment.hpp"
+#include "SweepEngine.hpp"
+#include "ESSBitmap.hpp"
+
+using namespace with_punishment;
+
+
+// ESS bitmaps of all deterministic three-action norms on a (steps + 1)^2 grid of
+// (assessment_error, perception_error). The file is queried with ess_bitmap.
+int main(int argc, char* argv[]) {
+    if (argc != 8) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <file> <benefit> <cost> <punishment> <punishment_cost> <max_error> <steps>" << std::endl;
+        return 1;
+    }
+    std::string file = argv[1];
+    double benefit = std::stod(argv[2]), cost = std::stod(argv[3]);
+    double punishment = std::stod(argv[4]), punishment_cost = std::stod(argv[5]);
+    double max_error = std::stod(argv[6]);
+    int steps = std::stoi(argv[7]);
+
+    ESSBitmapStore store(3);
+    store.punishment_params = {punishment, punishment_cost};
+    for (int i = 0; i <= steps; i++) {
+        for (int j = 0; j <= steps; j++) {
+            double assessment_error = max_error * i / steps, perception_error = max_error * j / steps;
+            std::cout << "assessment_error " << assessment_error << ", perception_error " << perception_error << std::endl;
+
+            // one partial bitmap per thread; the blocks are ordered, so merging is a union
+            std::vector<RoaringBitmap> partials(NumWorkerThreads());
+            ParallelFor(4096ul * 81ul, [&](size_t begin, size_t end, unsigned t) {
+                for (size_t k = begin; k < end; k++) {
+                    Norm norm{ AssessmentRule::MakeDeterministicRule(k / 81), ActionRule::MakeDeterministicRule(k % 81) };
+                    Game sim(assessment_error, perception_error, norm);
+                    if (sim.isESS(benefit, cost, punishment, punishment_cost)) { partials[t].Add(norm.ID()); }
+                }
+            }, partials.size());
+
+            ESSBitmapStore::Entry entry{{assessment_error, perception_error, 0.0, benefit, cost}, RoaringBitmap()};
+            for (const auto& p : partials) { entry.ess = RoaringBitmap::Or(entry.ess, p); }
+            store.entries.push_back(std::move(entry));
+        }
+    }
+    store.Save(file);
+    return 0;
+}
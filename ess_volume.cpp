@@ -0,0 +1,62 @@
+#include "Norms.hpp"
+#include "NormVolume.hpp"
+
+#include <fstream>
+#include <chrono>
+
+using namespace two_action;
+
+
+// Volume of the ESS and of the cooperative ESS norms among stochastic assessment rules,
+// for each of the 16 deterministic action rules and for stochastic action rules (-1).
+// Every round of every estimate is written, so the file shows the convergence.
+int main(int argc, char* argv[]) {
+    if (argc < 7 || argc > 12) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <output csv> <assessment_error> <perception_error> <mu_e> <benefit> <cost>"
+                  << " [target half width=1e-4] [log2 max points per replicate=26] [replicates=16]"
+                  << " [coop threshold=0.9] [threads]" << std::endl;
+        return 1;
+    }
+    std::string filename = argv[1];
+    double assessment_error = std::stod(argv[2]);
+    double perception_error = std::stod(argv[3]);
+    double mu_e = std::stod(argv[4]);
+    double benefit = std::stod(argv[5]);
+    double cost = std::stod(argv[6]);
+    double target = (argc >= 8) ? std::stod(argv[7]) : 1e-4;
+    int log2_max = (argc >= 9) ? std::stoi(argv[8]) : 26;
+    int replicates = (argc >= 10) ? std::stoi(argv[9]) : 16;
+    double coop_threshold = (argc >= 11) ? std::stod(argv[10]) : 0.9;
+    unsigned num_threads = (argc == 12) ? std::stoul(argv[11]) : 0;
+    if (log2_max < 0 || log2_max > 32) {
+        std::cerr << "log2 max points must be between 0 and 32" << std::endl;
+        return 1;
+    }
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error opening file!" << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    double points = 0.0;
+    file << "action_rule,points_per_replicate,ess,ess_half_width,ess_cooperative,ess_cooperative_half_width,converged\n";
+    for (int action_rule_id = -1; action_rule_id < 16; action_rule_id++) {
+        NormVolume volume(assessment_error, perception_error, mu_e, benefit, cost, coop_threshold, action_rule_id);
+        auto result = volume.Run(replicates, target, uint64_t(1) << log2_max, 1, num_threads,
+                                 [&](const NormVolume::Progress& p) {
+            file << action_rule_id << "," << p.points_per_replicate << "," << p.ess.mean << "," << p.ess.half_width << ","
+                 << p.ess_cooperative.mean << "," << p.ess_cooperative.half_width << "," << p.converged << "\n";
+            file.flush();
+        });
+        points += static_cast<double>(result.points_per_replicate) * replicates;
+        std::cout << "action rule " << action_rule_id << ": ESS " << result.ess.mean << " +- " << result.ess.half_width
+                  << ", cooperative ESS " << result.ess_cooperative.mean << " +- " << result.ess_cooperative.half_width
+                  << (result.converged ? "" : " (not converged)") << std::endl;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << points / seconds << " norms per second, done in " << seconds << " s" << std::endl;
+    return 0;
+}
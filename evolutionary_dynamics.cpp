@@ -0,0 +1,66 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "PolymorphicGame.hpp"
+#include "EvolutionaryDynamics.hpp"
+
+#include <fstream>
+#include <chrono>
+
+using namespace two_action;
+
+
+// Basins of attraction of the 16 action rules under one assessment rule, estimated
+// by integrating replicator or pairwise-comparison dynamics from random initial
+// shares. Each vertex is a norm, listed with its static ESS verdict from Game.
+int main(int argc, char* argv[]) {
+    if (argc < 9 || argc > 12) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <output csv> <assessment rule ID> <assessment_error> <perception_error> <mu_e>"
+                  << " <benefit> <cost> <replicator|fermi> [samples=1000] [t_max=10000] [selection_strength=1]"
+                  << std::endl;
+        return 1;
+    }
+    std::string filename = argv[1];
+    int assessment_id = std::stoi(argv[2]);
+    double assessment_error = std::stod(argv[3]);
+    double perception_error = std::stod(argv[4]);
+    double mu_e = std::stod(argv[5]);
+    double benefit = std::stod(argv[6]);
+    double cost = std::stod(argv[7]);
+    std::string kind = argv[8];
+    size_t samples = (argc > 9) ? std::stoul(argv[9]) : 1000;
+    double t_max = (argc > 10) ? std::stod(argv[10]) : 1e4;
+    double selection_strength = (argc > 11) ? std::stod(argv[11]) : 1.0;
+    if (kind != "replicator" && kind != "fermi") {
+        std::cerr << "Dynamics must be replicator or fermi" << std::endl;
+        return 1;
+    }
+
+    AssessmentRule R = AssessmentRule::MakeDeterministicRule(assessment_id);
+    auto game = PolymorphicGame::AllActionRules(assessment_error, perception_error, mu_e, R);
+    EvolutionaryDynamics evo(game, benefit, cost,
+                             kind == "replicator" ? Dynamics::Replicator : Dynamics::PairwiseComparison,
+                             selection_strength);
+    auto start = std::chrono::steady_clock::now();
+    auto basins = evo.SampleBasins(samples, t_max);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error opening file!" << std::endl;
+        return 1;
+    }
+    file << "ID,action_rule,basin,isESS\n";
+    for (int i = 0; i < 16; i++) {
+        Norm norm(R, ActionRule::MakeDeterministicRule(i));
+        Game single(assessment_error, perception_error, mu_e, norm);
+        file << norm.ID() << "," << i << "," << basins.Share(i) << "," << single.isESS(benefit, cost) << "\n";
+        if (basins.counts[i] > 0) {
+            std::cout << "ID " << norm.ID() << " (action rule " << i << "): " << basins.Share(i) << std::endl;
+        }
+    }
+    file << "-1,-1," << basins.Share(16) << ",0\n";
+    std::cout << "mixed: " << basins.Share(16) << ", not stationary at t_max: " << basins.unconverged << std::endl;
+    std::cout << samples << " trajectories in " << seconds << " s" << std::endl;
+    return 0;
+}
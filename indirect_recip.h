@@ -0,0 +1,62 @@
+#ifndef INDIRECT_RECIP_H
+#define INDIRECT_RECIP_H
+
+/* C interface of libindirect_recip: batch evaluation of the two-action model (Game.hpp)
+ * and of the model with punishment (GameWithPunishment.hpp).
+ *
+ * Every entry point evaluates n independent points. Point i is the norm norm_ids[i]
+ * with the parameter tuple params[i * k], ..., params[i * k + k - 1], where k is the
+ * tuple size given below. Results are written to caller-provided arrays of n elements;
+ * an output pointer may be NULL to skip that quantity. The points are spread over
+ * num_threads threads (0 for all cores). All arguments are checked before anything is
+ * computed; on error nothing is written and ir_last_error() describes the problem. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(INDIRECT_RECIP_BUILD)
+#    define IR_API __declspec(dllexport)
+#  else
+#    define IR_API __declspec(dllimport)
+#  endif
+#else
+#  define IR_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IR_API_VERSION 1
+
+#define IR_OK 0
+#define IR_ERROR_INVALID_ARGUMENT 1
+#define IR_ERROR_INTERNAL 2
+
+/* Version of the interface the library was built with (IR_API_VERSION). */
+IR_API int ir_api_version(void);
+
+/* Message of the last failed call of this thread, or "" after a successful one. */
+IR_API const char* ir_last_error(void);
+
+/* Two-action norms, IDs 0 ... 4095 as in Norm::ConstructFromID.
+ * Tuple (k = 5): assessment_error, perception_error, mu_e, benefit, cost. */
+#define IR_TWO_ACTION_TUPLE 5
+IR_API int ir_two_action_evaluate(size_t n, const int32_t* norm_ids, const double* params, unsigned num_threads,
+                                  double* equilibrium_state, double* cooperation, double* delta_v,
+                                  double* ess_margin, uint8_t* is_ess);
+
+/* Norms with punishment, IDs (assessment ID << 7) | action ID with action ID < 81, as in
+ * Norm::ConstructFromID.
+ * Tuple (k = 6): assessment_error, perception_error, benefit, cost, punishment, punishment_cost. */
+#define IR_WITH_PUNISHMENT_TUPLE 6
+IR_API int ir_with_punishment_evaluate(size_t n, const int32_t* norm_ids, const double* params, unsigned num_threads,
+                                       double* equilibrium_state, double* cooperation, double* punishment,
+                                       double* delta_v, uint8_t* is_ess);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,114 @@
+#include "indirect_recip.h"
+
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "NormsWithPunishment.hpp"
+#include "GameWithPunishment.hpp"
+#include "SweepEngine.hpp"
+
+#include <string>
+#include <mutex>
+#include <cmath>
+#include <exception>
+
+
+namespace {
+
+thread_local std::string last_error;
+
+int Fail(int code, const std::string& message) {
+    last_error = message;
+    return code;
+}
+
+// Checks the norm IDs and the error rates (the first `num_errors` entries of each tuple)
+// before any output is written.
+template <typename ValidID>
+bool Validate(size_t n, const int32_t* norm_ids, const double* params, int tuple, int num_errors,
+              ValidID&& valid_id, std::string& message) {
+    if (n > 0 && (norm_ids == nullptr || params == nullptr)) {
+        message = "norm_ids and params must not be NULL";
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (!valid_id(norm_ids[i])) {
+            message = "norm_ids[" + std::to_string(i) + "] = " + std::to_string(norm_ids[i]) + " is out of range";
+            return false;
+        }
+        for (int k = 0; k < tuple; k++) {
+            double x = params[i * tuple + k];
+            if (!std::isfinite(x) || (k < num_errors && (x < 0.0 || x > 1.0))) {
+                message = "params[" + std::to_string(i * tuple + k) + "] = " + std::to_string(x) + " is invalid";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Runs body(i) for every point on the worker threads, reporting the first exception.
+template <typename Body>
+int Run(size_t n, unsigned num_threads, Body&& body) {
+    std::string error;
+    std::mutex error_mutex;
+    ParallelFor(n, [&](size_t begin, size_t end, unsigned) {
+        try {
+            for (size_t i = begin; i < end; i++) { body(i); }
+        } catch (const std::exception& e) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (error.empty()) { error = e.what(); }
+        }
+    }, num_threads);
+    if (!error.empty()) { return Fail(IR_ERROR_INTERNAL, error); }
+    last_error.clear();
+    return IR_OK;
+}
+
+}  // namespace
+
+
+extern "C" {
+
+int ir_api_version(void) { return IR_API_VERSION; }
+
+const char* ir_last_error(void) { return last_error.c_str(); }
+
+int ir_two_action_evaluate(size_t n, const int32_t* norm_ids, const double* params, unsigned num_threads,
+                           double* equilibrium_state, double* cooperation, double* delta_v,
+                           double* ess_margin, uint8_t* is_ess) {
+    std::string message;
+    if (!Validate(n, norm_ids, params, IR_TWO_ACTION_TUPLE, 3,
+                  [](int32_t id) { return id >= 0 && id < 4096; }, message)) {
+        return Fail(IR_ERROR_INVALID_ARGUMENT, message);
+    }
+    return Run(n, num_threads, [&](size_t i) {
+        const double* p = params + i * IR_TWO_ACTION_TUPLE;
+        two_action::Game game(p[0], p[1], p[2], two_action::Norm::ConstructFromID(norm_ids[i]));
+        if (equilibrium_state) { equilibrium_state[i] = game.equilibrium_state; }
+        if (cooperation) { cooperation[i] = game.resident_coop; }
+        if (delta_v) { delta_v[i] = game.calc_delta_v(p[3], p[4]); }
+        if (ess_margin) { ess_margin[i] = game.calc_ess_margin(p[3], p[4]); }
+        if (is_ess) { is_ess[i] = game.isESS(p[3], p[4]); }
+    });
+}
+
+int ir_with_punishment_evaluate(size_t n, const int32_t* norm_ids, const double* params, unsigned num_threads,
+                                double* equilibrium_state, double* cooperation, double* punishment,
+                                double* delta_v, uint8_t* is_ess) {
+    std::string message;
+    if (!Validate(n, norm_ids, params, IR_WITH_PUNISHMENT_TUPLE, 2,
+                  [](int32_t id) { return id >= 0 && id < (1 << 19) && (id & 0x7F) < 81; }, message)) {
+        return Fail(IR_ERROR_INVALID_ARGUMENT, message);
+    }
+    return Run(n, num_threads, [&](size_t i) {
+        const double* p = params + i * IR_WITH_PUNISHMENT_TUPLE;
+        with_punishment::Game game(p[0], p[1], with_punishment::Norm::ConstructFromID(norm_ids[i]));
+        if (equilibrium_state) { equilibrium_state[i] = game.equilibrium_state; }
+        if (cooperation) { cooperation[i] = game.resident_coop; }
+        if (punishment) { punishment[i] = game.resident_punishment; }
+        if (delta_v) { delta_v[i] = game.calc_delta_v(p[2], p[3], p[4], p[5]); }
+        if (is_ess) { is_ess[i] = game.isESS(p[2], p[3], p[4], p[5]); }
+    });
+}
+
+}  // extern "C"
@@ -0,0 +1,115 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "SweepEngine.hpp"
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+using namespace two_action;
+
+
+// Hands a vector to NumPy without copying: the array views the vector's buffer and a
+// capsule owning the vector frees it with the last reference.
+template <typename T>
+py::array_t<T> ToArray(std::vector<T>&& values, const std::vector<py::ssize_t>& shape) {
+    auto* owner = new std::vector<T>(std::move(values));
+    py::capsule free_owner(owner, [](void* p) { delete static_cast<std::vector<T>*>(p); });
+    return py::array_t<T>(shape, owner->data(), free_owner);
+}
+
+std::vector<double> ToVector(const py::array_t<double, py::array::c_style | py::array::forcecast>& a) {
+    return std::vector<double>(a.data(), a.data() + a.size());
+}
+
+// Game over the grid norm_ids x assessment_errors x perception_errors x mu_e, the loop of
+// leading_eight_ESS_with_errors. Every output has shape (norms, assessment errors,
+// perception errors, mu_e); the sweep runs on all threads with the GIL released.
+py::dict Sweep(const std::vector<int>& norm_ids,
+               const py::array_t<double, py::array::c_style | py::array::forcecast>& assessment_errors,
+               const py::array_t<double, py::array::c_style | py::array::forcecast>& perception_errors,
+               const py::array_t<double, py::array::c_style | py::array::forcecast>& mu_e,
+               double benefit, double cost, unsigned num_threads) {
+    std::vector<Norm> norms;
+    for (int id : norm_ids) { norms.push_back(Norm::ConstructFromID(id)); }
+    const auto ae = ToVector(assessment_errors), pe = ToVector(perception_errors), me = ToVector(mu_e);
+    const size_t na = ae.size(), np = pe.size(), nm = me.size();
+    const size_t total = norms.size() * na * np * nm;
+
+    std::vector<double> h(total), coop(total), delta_v(total), margin(total);
+    std::vector<uint8_t> ess(total);
+    {
+        py::gil_scoped_release release;
+        ParallelFor(total, [&](size_t begin, size_t end, unsigned) {
+            for (size_t k = begin; k < end; k++) {
+                size_t rest = k;
+                const size_t m = rest % nm; rest /= nm;
+                const size_t p = rest % np; rest /= np;
+                const size_t a = rest % na; rest /= na;
+                Game game(ae[a], pe[p], me[m], norms[rest]);
+                h[k] = game.equilibrium_state;
+                coop[k] = game.resident_coop;
+                delta_v[k] = game.calc_delta_v(benefit, cost);
+                margin[k] = game.calc_ess_margin(benefit, cost);
+                ess[k] = game.isESS(benefit, cost);
+            }
+        }, num_threads);
+    }
+
+    const std::vector<py::ssize_t> shape = {static_cast<py::ssize_t>(norms.size()), static_cast<py::ssize_t>(na),
+                                            static_cast<py::ssize_t>(np), static_cast<py::ssize_t>(nm)};
+    py::dict result;
+    result["h"] = ToArray(std::move(h), shape);
+    result["cooperation"] = ToArray(std::move(coop), shape);
+    result["delta_v"] = ToArray(std::move(delta_v), shape);
+    result["ess_margin"] = ToArray(std::move(margin), shape);
+    result["is_ess"] = ToArray(std::move(ess), shape);
+    return result;
+}
+
+PYBIND11_MODULE(indirect_recip, m) {
+    m.doc() = "Norms, games and parallel sweeps of the two-action model";
+
+    py::class_<Norm>(m, "Norm")
+        .def(py::init([](const std::array<double, 8>& good_probs, const std::array<double, 4>& coop_probs) {
+            return Norm(AssessmentRule(good_probs), ActionRule(coop_probs));
+        }), py::arg("good_probs"), py::arg("coop_probs"))
+        .def_static("from_id", &Norm::ConstructFromID, py::arg("id"))
+        .def_static("L1", &Norm::L1)
+        .def_static("L2", &Norm::L2)
+        .def_static("L3", &Norm::L3)
+        .def_static("L4", &Norm::L4)
+        .def_static("L5", &Norm::L5)
+        .def_static("L6", &Norm::L6)
+        .def_static("L7", &Norm::L7)
+        .def_static("L8", &Norm::L8)
+        .def_property_readonly("id", &Norm::ID)
+        .def_property_readonly("is_deterministic", &Norm::IsDeterministic)
+        .def_property_readonly("good_probs", [](const Norm& n) { return n.assessment_rule.good_probs; })
+        .def_property_readonly("coop_probs", [](const Norm& n) { return n.action_rule.coop_probs; })
+        .def("__repr__", [](const Norm& n) { return n.assessment_rule.Inspect() + n.action_rule.Inspect(); });
+
+    py::class_<Game>(m, "Game")
+        .def(py::init<double, double, double, const Norm&>(),
+             py::arg("assessment_error"), py::arg("perception_error"), py::arg("mu_e"), py::arg("norm"))
+        .def_readonly("equilibrium_state", &Game::equilibrium_state)
+        .def_readonly("resident_coop", &Game::resident_coop)
+        .def_readonly("norm", &Game::norm)
+        .def("is_ess", &Game::isESS, py::arg("benefit"), py::arg("cost"))
+        .def("delta_v", &Game::calc_delta_v, py::arg("benefit"), py::arg("cost"))
+        .def("resident_payoff", &Game::calc_resident_payoff, py::arg("benefit"), py::arg("cost"))
+        .def("invader_payoff", [](const Game& g, const std::array<double, 4>& coop_probs, double benefit, double cost) {
+            return g.calc_invader_payoff(ActionRule(coop_probs), benefit, cost);
+        }, py::arg("coop_probs"), py::arg("benefit"), py::arg("cost"))
+        .def("ess_margin", [](const Game& g, double benefit, double cost) {
+            int best = -1;
+            double margin = g.calc_ess_margin(benefit, cost, &best);
+            return py::make_tuple(margin, best);
+        }, py::arg("benefit"), py::arg("cost"));
+
+    m.def("sweep", &Sweep, py::arg("norm_ids"), py::arg("assessment_errors"), py::arg("perception_errors"),
+          py::arg("mu_e"), py::arg("benefit"), py::arg("cost"), py::arg("threads") = 0,
+          "Game over the grid norm_ids x assessment_errors x perception_errors x mu_e; returns a dict of "
+          "arrays of shape (norms, assessment errors, perception errors, mu_e) owned by the module");
+}
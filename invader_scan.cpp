@@ -0,0 +1,62 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "InvaderScan.hpp"
+
+#include <fstream>
+#include <chrono>
+
+using namespace two_action;
+
+
+// Scans the stochastic invaders of every norm that passes the deterministic ESS test,
+// reporting the best invader and how many invaders beat the residents.
+int main(int argc, char* argv[]) {
+    if (argc < 7 || argc > 10) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <output csv> <assessment_error> <perception_error> <mu_e> <benefit> <cost>"
+                  << " [log2 Sobol points=16] [grid points per axis=0] [threads]" << std::endl;
+        return 1;
+    }
+    std::string filename = argv[1];
+    double assessment_error = std::stod(argv[2]);
+    double perception_error = std::stod(argv[3]);
+    double mu_e = std::stod(argv[4]);
+    double benefit = std::stod(argv[5]);
+    double cost = std::stod(argv[6]);
+    int log2_points = (argc >= 8) ? std::stoi(argv[7]) : 16;
+    size_t per_axis = (argc >= 9) ? std::stoul(argv[8]) : 0;
+    unsigned num_threads = (argc == 10) ? std::stoul(argv[9]) : 0;
+    if (log2_points < 0 || log2_points > 32) {
+        std::cerr << "log2 Sobol points must be between 0 and 32" << std::endl;
+        return 1;
+    }
+
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error opening file!" << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    file << "norm_id,cooperation,num_points,max_advantage,p_BB,p_BG,p_GB,p_GG,num_positive\n";
+    long num_ess = 0, num_invaded = 0, points = 0;
+    for (int id = 0; id < 4096; id++) {
+        Norm norm = Norm::ConstructFromID(id);
+        Game game(assessment_error, perception_error, mu_e, norm);
+        if (!game.isESS(benefit, cost)) { continue; }
+        num_ess++;
+
+        InvaderScan scan(game, benefit, cost);
+        auto result = (per_axis > 0) ? scan.ScanGrid(per_axis, num_threads)
+                                     : scan.ScanSobol(uint64_t(1) << log2_points, num_threads);
+        const auto& p = result.argmax.coop_probs;
+        file << id << "," << game.resident_coop << "," << result.num_points << "," << result.max_advantage << ","
+             << p[0] << "," << p[1] << "," << p[2] << "," << p[3] << "," << result.num_positive << "\n";
+        num_invaded += result.num_positive > 0;
+        points += result.num_points;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << num_ess << " deterministic ESS norms, " << num_invaded << " invaded by a stochastic invader" << std::endl;
+    std::cout << points / seconds << " invaders per second, done in " << seconds << " s" << std::endl;
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "Norms.hpp"
+#include "PolymorphicGame.hpp"
+
+#include <fstream>
+#include <chrono>
+
+using namespace two_action;
+
+
+// Finite-frequency invasion analysis between action rules under one assessment rule.
+// With an invader ID the payoffs along the resident-invader edge are written; with
+// "all" every ordered pair of the 16 action rules is classified (dominance,
+// coexistence, bistability) together with its mixed rest points.
+int main(int argc, char* argv[]) {
+    if (argc < 10 || argc > 11) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <output csv> <assessment rule ID> <resident action rule ID> <invader action rule ID|all>"
+                  << " <assessment_error> <perception_error> <mu_e> <benefit> <cost> [points=101]" << std::endl;
+        return 1;
+    }
+    std::string filename = argv[1];
+    AssessmentRule R = AssessmentRule::MakeDeterministicRule(std::stoi(argv[2]));
+    std::string resident_arg = argv[3], invader_arg = argv[4];
+    double assessment_error = std::stod(argv[5]);
+    double perception_error = std::stod(argv[6]);
+    double mu_e = std::stod(argv[7]);
+    double benefit = std::stod(argv[8]);
+    double cost = std::stod(argv[9]);
+    size_t points = (argc == 11) ? std::stoul(argv[10]) : 101;
+
+    auto game = PolymorphicGame::AllActionRules(assessment_error, perception_error, mu_e, R);
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error opening file!" << std::endl;
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    if (invader_arg != "all") {
+        size_t resident = std::stoul(resident_arg), invader = std::stoul(invader_arg);
+        if (resident > 15 || invader > 15 || resident == invader) {
+            std::cerr << "Resident and invader must be distinct action rules between 0 and 15" << std::endl;
+            return 1;
+        }
+        auto edge = game.calc_edge(resident, invader, benefit, cost, points);
+        file << "invader_share,g,resident_payoff,invader_payoff\n";
+        for (const auto& p : edge.curve) {
+            file << p.share << "," << p.g << "," << p.resident_payoff << "," << p.invader_payoff << "\n";
+        }
+        std::cout << EdgeDynamicsToString(edge.dynamics);
+        for (double s : edge.rest_points) { std::cout << ", rest point at invader share " << s; }
+        std::cout << std::endl;
+    } else {
+        file << "resident,invader,dynamics,rest_points\n";
+        std::vector<long> counts(5, 0);
+        for (size_t resident = 0; resident < 16; resident++) {
+            for (size_t invader = 0; invader < 16; invader++) {
+                if (invader == resident) { continue; }
+                auto edge = game.calc_edge(resident, invader, benefit, cost, points);
+                counts[static_cast<int>(edge.dynamics)]++;
+                file << resident << "," << invader << "," << EdgeDynamicsToString(edge.dynamics) << ",";
+                for (size_t n = 0; n < edge.rest_points.size(); n++) {
+                    file << (n ? ";" : "") << edge.rest_points[n];
+                }
+                file << "\n";
+            }
+        }
+        for (int e = 0; e < 5; e++) {
+            std::cout << EdgeDynamicsToString(static_cast<EdgeDynamics>(e)) << ": " << counts[e] << std::endl;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "done in " << seconds << " s" << std::endl;
+    return 0;
+}
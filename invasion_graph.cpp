@@ -0,0 +1,56 @@
+#include "InvasionGraph.hpp"
+
+#include <chrono>
+
+
+// Builds the "can invade" graph from a file written by invasion_matrix or
+// invasion_matrix_with_P and decomposes it into strongly connected components.
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <invasion matrix file> <output prefix>" << std::endl;
+        return 1;
+    }
+    std::string prefix = argv[2];
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&start]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    InvasionMatrix m(argv[1]);
+    InvasionGraph g = InvasionGraph::FromMatrix(m);
+    std::cout << g.NumNodes() << " nodes, " << g.NumEdges() << " edges (" << elapsed() << " s)" << std::endl;
+
+    std::vector<uint32_t> component = g.StronglyConnectedComponents();
+    std::vector<uint64_t> sizes;
+    std::vector<uint8_t> absorbing;
+    g.SummarizeComponents(component, sizes, absorbing);
+    size_t n_absorbing = 0, n_cyclic = 0;
+    for (size_t c = 0; c < sizes.size(); c++) {
+        n_absorbing += absorbing[c];
+        n_cyclic += (sizes[c] > 1);
+    }
+    std::cout << sizes.size() << " components, " << n_cyclic << " with cycles, "
+              << n_absorbing << " absorbing (" << elapsed() << " s)" << std::endl;
+
+    g.WriteCSR(prefix + "_csr.bin");
+
+    std::ofstream nodes(prefix + "_nodes.csv");
+    nodes << "ID,component,out_degree\n";
+    for (size_t v = 0; v < g.NumNodes(); v++) {
+        nodes << g.node_ids[v] << "," << component[v] << "," << g.OutDegree(v) << "\n";
+    }
+
+    // members of each component, space separated
+    std::vector<std::vector<int64_t>> members(sizes.size());
+    for (size_t v = 0; v < g.NumNodes(); v++) { members[component[v]].push_back(g.node_ids[v]); }
+    std::ofstream components(prefix + "_components.csv");
+    components << "component,size,absorbing,members\n";
+    for (size_t c = 0; c < sizes.size(); c++) {
+        components << c << "," << sizes[c] << "," << static_cast<int>(absorbing[c]) << ",";
+        for (size_t i = 0; i < members[c].size(); i++) {
+            components << (i ? " " : "") << members[c][i];
+        }
+        components << "\n";
+    }
+    return 0;
+}
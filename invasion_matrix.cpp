@@ -0,0 +1,57 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "InvasionMatrix.hpp"
+
+using namespace two_action;
+
+
+// Invasion fitness of every deterministic invader against every deterministic
+// two-action resident norm. With "action_rule" the columns are the 16 action rules
+// (invaders under the resident's assessment rule); with "full_norm" the columns
+// are all 4096 norms. Under public assessment an invader is judged by the
+// resident's assessment rule, so its own assessment rule does not change its payoff.
+int main(int argc, char* argv[]) {
+    if (argc != 8) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <file> <action_rule|full_norm> <assessment_error> <perception_error> <mu_e> <benefit> <cost>" << std::endl;
+        return 1;
+    }
+    std::string file = argv[1];
+    std::string kind = argv[2];
+    if (kind != "action_rule" && kind != "full_norm") {
+        std::cerr << "Unknown invader kind: " << kind << std::endl;
+        return 1;
+    }
+
+    InvasionMatrixHeader header;
+    header.num_actions = 2;
+    header.full_norm_invaders = (kind == "full_norm");
+    header.assessment_error = std::stod(argv[3]);
+    header.perception_error = std::stod(argv[4]);
+    header.mu_e = std::stod(argv[5]);
+    header.benefit = std::stod(argv[6]);
+    header.cost = std::stod(argv[7]);
+    const double benefit = header.benefit, cost = header.cost;
+
+    std::vector<int64_t> row_ids(4096), col_ids(header.full_norm_invaders ? 4096 : 16);
+    for (size_t i = 0; i < row_ids.size(); i++) { row_ids[i] = i; }
+    for (size_t i = 0; i < col_ids.size(); i++) { col_ids[i] = i; }
+
+    auto prepare = [&](size_t r) {
+        Game sim(header.assessment_error, header.perception_error, header.mu_e, Norm::ConstructFromID(row_ids[r]));
+        double self_payoff = (benefit - cost) * sim.resident_coop;
+        std::array<double, 16> deltas;
+        for (int i = 0; i < 16; i++) {
+            auto [H, coop_mut_to_res, coop_res_to_mut] = sim.calc_invader_stats(ActionRule::MakeDeterministicRule(i));
+            deltas[i] = benefit * coop_res_to_mut - cost * coop_mut_to_res - self_payoff;
+        }
+        return std::make_pair(self_payoff, deltas);
+    };
+    auto entry = [&](const std::array<double, 16>& deltas, size_t c) {
+        return deltas[col_ids[c] & 0xF];
+    };
+
+    BuildInvasionMatrix(file, header, row_ids, col_ids, prepare, entry);
+    std::cout << row_ids.size() << " x " << col_ids.size() << " matrix written to " << file << std::endl;
+    return 0;
+}
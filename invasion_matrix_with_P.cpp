@@ -0,0 +1,55 @@
+#include "NormsWithPunishment.hpp"
+#include "GameWithPunishment.hpp"
+#include "InvasionMatrix.hpp"
+
+using namespace with_punishment;
+
+
+// Invasion fitness of the 81 deterministic action rules against every deterministic
+// three-action resident norm (4096 x 81 residents, indexed by Norm::ID()).
+int main(int argc, char* argv[]) {
+    if (argc != 8) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <file> <assessment_error> <perception_error> <benefit> <cost> <punishment> <punishment_cost>" << std::endl;
+        return 1;
+    }
+    std::string file = argv[1];
+
+    InvasionMatrixHeader header;
+    header.num_actions = 3;
+    header.assessment_error = std::stod(argv[2]);
+    header.perception_error = std::stod(argv[3]);
+    header.benefit = std::stod(argv[4]);
+    header.cost = std::stod(argv[5]);
+    header.punishment = std::stod(argv[6]);
+    header.punishment_cost = std::stod(argv[7]);
+    const double benefit = header.benefit, cost = header.cost;
+    const double punishment = header.punishment, punishment_cost = header.punishment_cost;
+
+    std::vector<int64_t> row_ids, col_ids(81);
+    for (int i = 0; i < 4096; i++) {
+        for (int j = 0; j < 81; j++) {
+            row_ids.push_back(Norm(AssessmentRule::MakeDeterministicRule(i), ActionRule::MakeDeterministicRule(j)).ID());
+        }
+    }
+    for (size_t i = 0; i < col_ids.size(); i++) { col_ids[i] = i; }
+
+    auto prepare = [&](size_t r) {
+        Game sim(header.assessment_error, header.perception_error, Norm::ConstructFromID(row_ids[r]));
+        double self_payoff = (benefit - cost) * sim.resident_coop - (punishment + punishment_cost) * sim.resident_punishment;
+        std::array<double, 81> deltas;
+        for (int i = 0; i < 81; i++) {
+            auto [H, coop_mut_to_res, coop_res_to_mut, punishment_mut_to_res, punishment_res_to_mut] =
+                sim.calc_invader_stats(ActionRule::MakeDeterministicRule(i));
+            double invader_payoff = (benefit * coop_res_to_mut - cost * coop_mut_to_res
+                                     - punishment * punishment_res_to_mut - punishment_cost * punishment_mut_to_res);
+            deltas[i] = invader_payoff - self_payoff;
+        }
+        return std::make_pair(self_payoff, deltas);
+    };
+    auto entry = [&](const std::array<double, 81>& deltas, size_t c) { return deltas[c]; };
+
+    BuildInvasionMatrix(file, header, row_ids, col_ids, prepare, entry);
+    std::cout << row_ids.size() << " x " << col_ids.size() << " matrix written to " << file << std::endl;
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "AdaptiveSampler.hpp"
+
+#include <fstream>
+
+using namespace two_action;
+
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <location to save output> [quadtree|octree]" << std::endl;
+        return 1;
+    }
+    std::string mode = (argc == 3) ? std::string(argv[2]) : "quadtree";
+    if (mode != "quadtree" && mode != "octree") {
+        std::cerr << "Unknown mode: " << mode << std::endl;
+        return 1;
+    }
+    std::vector<Norm> l8_norms = {Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(),
+                                 Norm::L5(), Norm::L6(), Norm::L7(), Norm::L8()};
+
+    double benefit = 1.0;
+    double cost = 0.8;
+    double max_error = 0.1;
+    double resolution = 0.002;   // same spacing as the uniform grid of leading_eight_with_errors
+    int min_level = 3;
+    double h_tolerance = 0.01;
+
+    // assessment errors of the slices shown in Figures 1 and 4
+    std::vector<double> slices = {0.002, 0.02, 0.04, 0.06, 0.08};
+
+    std::string base = std::string(argv[1]);
+    std::string file = base + "leading_eight_ESS_adaptive" + (mode == "octree" ? "_3d" : "") + ".csv";
+    std::ofstream out(file);
+    if (!out.is_open()) {
+        std::cerr << "Error opening file!" << std::endl;
+        return 1;
+    }
+    out << "order,ID,assessment_error,perception_error,mu_e,"
+        << "size_assessment_error,size_perception_error,size_mu_e,level,h,ess_fraction\n";
+
+    size_t evaluations = 0, uniform_evaluations = 0;
+    int order = 1;
+    for (const auto& norm : l8_norms) {
+        std::cout << "ID" << norm.ID() << std::endl;
+        if (mode == "quadtree") {
+            for (double assessment_error : slices) {
+                // axes: (perception_error, mu_e)
+                AdaptiveSampler<2>::Point lower = {0.0, 0.0}, upper = {max_error, max_error};
+                int max_level = AdaptiveSampler<2>::LevelsForResolution(lower, upper, resolution);
+                AdaptiveSampler<2> sampler(lower, upper, min_level, max_level, h_tolerance,
+                    [&](const AdaptiveSampler<2>::Point& x) {
+                        Game sim(assessment_error, x[0], x[1], norm);
+                        return AdaptiveSampler<2>::Sample{sim.equilibrium_state, sim.isESS(benefit, cost)};
+                    });
+                for (const auto& cell : sampler.Run()) {
+                    auto x = sampler.Lower(cell);
+                    auto size = sampler.Size(cell);
+                    out << order << "," << norm.ID() << ","
+                        << assessment_error << "," << x[0] << "," << x[1] << ","
+                        << 0.0 << "," << size[0] << "," << size[1] << ","
+                        << cell.level << "," << cell.h << "," << cell.ess_fraction << "\n";
+                }
+                evaluations += sampler.NumEvaluations();
+                uniform_evaluations += sampler.NumUniformEvaluations();
+            }
+        } else {
+            // axes: (assessment_error, perception_error, mu_e)
+            AdaptiveSampler<3>::Point lower = {0.0, 0.0, 0.0}, upper = {max_error, max_error, max_error};
+            int max_level = AdaptiveSampler<3>::LevelsForResolution(lower, upper, resolution);
+            AdaptiveSampler<3> sampler(lower, upper, min_level, max_level, h_tolerance,
+                [&](const AdaptiveSampler<3>::Point& x) {
+                    Game sim(x[0], x[1], x[2], norm);
+                    return AdaptiveSampler<3>::Sample{sim.equilibrium_state, sim.isESS(benefit, cost)};
+                });
+            for (const auto& cell : sampler.Run()) {
+                auto x = sampler.Lower(cell);
+                auto size = sampler.Size(cell);
+                out << order << "," << norm.ID() << ","
+                    << x[0] << "," << x[1] << "," << x[2] << ","
+                    << size[0] << "," << size[1] << "," << size[2] << ","
+                    << cell.level << "," << cell.h << "," << cell.ess_fraction << "\n";
+            }
+            evaluations += sampler.NumEvaluations();
+            uniform_evaluations += sampler.NumUniformEvaluations();
+        }
+        order++;
+    }
+    out.close();
+
+    std::cout << "Evaluations: " << evaluations << " (uniform grid at the same resolution: "
+              << uniform_evaluations << ")" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "Dual.hpp"
+#include "SweepEngine.hpp"
+
+#include <fstream>
+#include <chrono>
+
+using namespace two_action;
+
+
+using D1 = Dual<1>;
+
+// Margin of the ESS condition and its derivative with respect to the assessment error,
+// from a single dual evaluation.
+D1 Margin(const Norm& norm, double assessment_error, double perception_error, double mu_e,
+          double benefit, double cost) {
+    BasicGame<D1> game(D1::Variable(assessment_error, 0), perception_error, mu_e, norm);
+    return game.calc_ess_margin(benefit, cost);
+}
+
+// Smallest assessment error in (0, upper] at which the norm stops being an ESS: the
+// first sign change of the margin is bracketed on a grid of `scan` cells and then
+// located by Newton steps that fall back to bisection when they leave the bracket.
+// Returns 0 when the norm is not an ESS without assessment errors and `upper` when it
+// stays one throughout.
+double Threshold(const Norm& norm, double perception_error, double mu_e, double benefit, double cost,
+                 double upper, int scan, int& evaluations) {
+    evaluations = 1;
+    D1 m = Margin(norm, 0.0, perception_error, mu_e, benefit, cost);
+    if (m.v < 0.0) { return 0.0; }
+    double lo = 0.0, hi = upper;
+    bool bracketed = false;
+    for (int i = 1; i <= scan; i++) {
+        double e = upper * i / scan;
+        evaluations++;
+        if (Margin(norm, e, perception_error, mu_e, benefit, cost).v < 0.0) {
+            hi = e;
+            bracketed = true;
+            break;
+        }
+        lo = e;
+    }
+    if (!bracketed) { return upper; }
+
+    double e = 0.5 * (lo + hi);
+    for (int it = 0; it < 100 && hi - lo > 1e-15; it++) {
+        evaluations++;
+        m = Margin(norm, e, perception_error, mu_e, benefit, cost);
+        if (m.v >= 0.0) { lo = e; } else { hi = e; }
+        double next = (m.d[0] != 0.0) ? e - m.v / m.d[0] : 0.5 * (lo + hi);
+        if (!(next > lo && next < hi)) { next = 0.5 * (lo + hi); }
+        if (std::abs(next - e) < 1e-15) { break; }
+        e = next;
+    }
+    return e;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " <location to save output> [benefit=1.0] [cost=0.8]" << std::endl;
+        return 1;
+    }
+    std::vector<Norm> l8_norms = {Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(),
+                                  Norm::L5(), Norm::L6(), Norm::L7(), Norm::L8()};
+    double benefit = (argc >= 3) ? std::stod(argv[2]) : 1.0;
+    double cost = (argc == 4) ? std::stod(argv[3]) : 0.8;
+
+    std::string base = std::string(argv[1]);
+    std::ofstream file(base + "leading_eight_ESS_boundary.csv");
+    if (!file.is_open()) {
+        std::cerr << "Error opening file!" << std::endl;
+        return 1;
+    }
+
+    // Same grid of perception errors and mu_e as leading_eight_ESS_with_errors; the
+    // assessment-error axis is replaced by the exact threshold.
+    std::vector<double> vector_errors;
+    for (double i = 0.0; i < 0.1002; i += 0.002) {
+        vector_errors.push_back(i);
+    }
+    const size_t n = vector_errors.size();
+    const double upper = 0.5;
+
+    auto start = std::chrono::steady_clock::now();
+    file << "order,ID,perception_error,mu_e,threshold_assessment_error,h_at_threshold\n";
+    long total_evaluations = 0;
+    int order = 1;
+    for (const auto& norm : l8_norms) {
+        std::vector<double> thresholds(n * n), hs(n * n);
+        std::vector<int> evaluations(n * n);
+        ParallelFor(n * n, [&](size_t begin, size_t end, unsigned) {
+            for (size_t k = begin; k < end; k++) {
+                double perception_error = vector_errors[k / n], mu_e = vector_errors[k % n];
+                thresholds[k] = Threshold(norm, perception_error, mu_e, benefit, cost, upper, 20, evaluations[k]);
+                hs[k] = Game(thresholds[k], perception_error, mu_e, norm).equilibrium_state;
+            }
+        });
+        for (size_t k = 0; k < n * n; k++) {
+            file << order << "," << norm.ID() << "," << vector_errors[k / n] << "," << vector_errors[k % n] << ","
+                 << thresholds[k] << "," << hs[k] << "\n";
+            total_evaluations += evaluations[k];
+        }
+        order++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << static_cast<double>(total_evaluations) / (l8_norms.size() * n * n) << " evaluations per threshold, "
+              << "done in " << seconds << " s" << std::endl;
+    return 0;
+}
@@ -1,8 +1,12 @@
 #include "Norms.hpp"
 #include "Game.hpp"
+#include "SweepEngine.hpp"
+#include "ErrorBatch.hpp"
 
 #include <fstream>
 
+using namespace two_action;
+
 
 void writeCSV(const std::vector<std::tuple<int, int, double, bool, double, double, double>>& output,
               const std::string& filename) {
@@ -28,11 +32,23 @@ void writeCSV(const std::vector<std::tuple<int, int, double, bool, double, doubl
     file.close();
 }
 
+// Cells per axis of the aggregate raster: 10 x 10 cells of about 5 x 5 grid points.
+constexpr size_t DefaultBins = 10;
+
+// Positive decimal count of at most `max`, or 0 for anything else.
+size_t ParseBins(const std::string& arg, size_t max) {
+    if (arg.empty() || arg.size() > 9 || arg.find_first_not_of("0123456789") != std::string::npos) { return 0; }
+    size_t bins = std::stoul(arg);
+    return (bins <= max) ? bins : 0;
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <location to save output>" << std::endl;
+    auto usage = [&]() {
+        std::cerr << "Usage: " << argv[0] << " <location to save output> [aggregate [bins=" << DefaultBins << "]]"
+                  << std::endl;
         return 1;
-    }
+    };
+    if (argc < 2 || argc > 4 || (argc >= 3 && std::string(argv[2]) != "aggregate")) { return usage(); }
     std::vector<Norm> l8_norms = {Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(),
                                  Norm::L5(), Norm::L6(), Norm::L7(), Norm::L8()};
 
@@ -49,29 +65,91 @@ int main(int argc, char* argv[]) {
         vector_errors.push_back(i);
     }
 
-    std::vector<std::tuple<int, int, double, bool, double, double, double>> output;
-
-    const std::vector<std::pair<Reputation, Reputation>> all_contexts = {
-        {Reputation::G, Reputation::G},
-        {Reputation::G, Reputation::B},
-        {Reputation::B, Reputation::G},
-        {Reputation::B, Reputation::B}
+    // all (assessment_error, perception_error, mu_e) triples, mu_e varying fastest, as
+    // arrays for ErrorBatch
+    const size_t n = vector_errors.size(), num_points = n * n * n;
+    std::vector<double> assessment_errors(num_points), perception_errors(num_points), mu_es(num_points);
+    for (size_t k = 0; k < num_points; k++) {
+        assessment_errors[k] = vector_errors[k / (n * n)];
+        perception_errors[k] = vector_errors[(k / n) % n];
+        mu_es[k] = vector_errors[k % n];
+    }
+    std::vector<double> h(num_points), cooperation(num_points), margin(num_points);
+    std::vector<uint8_t> is_ess(num_points);
+    auto evaluate = [&](const Norm& norm) {
+        ErrorBatch(norm, benefit, cost).EvaluateParallel(num_points, assessment_errors.data(), perception_errors.data(),
+                                                         mu_es.data(), h.data(), cooperation.data(), margin.data(),
+                                                         is_ess.data());
     };
 
+    if (argc >= 3) {
+        // ESS fraction per (mu_e, perception_error) cell of each assessment_error slice, the
+        // panels of the heatmaps, instead of writing one row per point. The raster spans
+        // the grid with cells centred on the grid points when bins is one per grid value.
+        const size_t bins = (argc == 4) ? ParseBins(argv[3], n) : DefaultBins;
+        if (bins == 0) {
+            std::cerr << "bins must be an integer between 1 and " << n << std::endl;
+            return usage();
+        }
+        const double upper = vector_errors.back(), half = 0.5 * upper / (n - 1);
+        const double lower_edge = -half, upper_edge = upper + half, width = (upper_edge - lower_edge) / bins;
+        // the grid value at the centre of a cell, or the centre itself
+        auto center = [&](size_t i) { return (bins == n) ? vector_errors[i] : lower_edge + (i + 0.5) * width; };
+
+        std::ofstream out(base + "leading_eight_ESS_fraction.csv");
+        if (!out.is_open()) {
+            std::cerr << "Error opening file!" << std::endl;
+            return 1;
+        }
+        out << "order,ID,assessment_error,mu_e,perception_error,count,ess_fraction\n";
+
+        int order = 1;
+        for (const auto& norm : l8_norms) {
+            std::cout << "ID" << norm.ID() << std::endl;
+            // each block is evaluated and binned into the sink of its thread in one pass
+            const ErrorBatch batch(norm, benefit, cost);
+            const size_t num_blocks = (num_points + ErrorBatch::BlockSize - 1) / ErrorBatch::BlockSize;
+            const KeyedGridSink prototype(n, GridSink(bins, lower_edge, upper_edge, bins, lower_edge, upper_edge));
+            KeyedGridSink slices = ParallelReduce(num_blocks, prototype, [&](size_t b, KeyedGridSink& sink) {
+                constexpr size_t B = ErrorBatch::BlockSize;
+                double block_h[B], block_coop[B], block_margin[B];
+                uint8_t block_ess[B];
+                const size_t first = b * B;
+                const size_t count = std::min(B, num_points - first);
+                batch.Evaluate(count, assessment_errors.data() + first, perception_errors.data() + first,
+                               mu_es.data() + first, block_h, block_coop, block_margin, block_ess);
+                for (size_t i = 0; i < count; i++) {
+                    const size_t k = first + i;
+                    sink.Add(k / (n * n), mu_es[k], perception_errors[k], block_ess[i] ? 1.0 : 0.0);
+                }
+            });
+            for (size_t a = 0; a < n; a++) {
+                const GridSink& grid = slices.keys[a];
+                for (size_t iy = 0; iy < bins; iy++) {
+                    for (size_t ix = 0; ix < bins; ix++) {
+                        const long count = grid.counts[iy * bins + ix];
+                        if (count == 0) { continue; }
+                        out << order << "," << norm.ID() << "," << vector_errors[a] << "," << center(ix) << ","
+                            << center(iy) << "," << count << "," << grid.Mean(ix, iy) << "\n";
+                    }
+                }
+            }
+            order++;
+        }
+        return 0;
+    }
+
+    std::vector<std::tuple<int, int, double, bool, double, double, double>> output;
+
     int order = 1;
     for (const auto& norm : l8_norms) {
         std::cout << "ID" << norm.ID() << std::endl;
-        for (double assessment_error : vector_errors) {
-            for (double perception_error : vector_errors) {
-                for (double mu_e : vector_errors) {
-                    Game sim(assessment_error, perception_error, mu_e, norm);
-                    double h = sim.equilibrium_state;
-                    bool isESS = sim.isESS(benefit, cost);
-                    output.push_back(std::make_tuple(order, norm.ID(), h, isESS, assessment_error, perception_error, mu_e));
-                }
-            }
+        evaluate(norm);
+        for (size_t k = 0; k < num_points; k++) {
+            output.push_back(std::make_tuple(order, norm.ID(), h[k], is_ess[k] != 0,
+                                             assessment_errors[k], perception_errors[k], mu_es[k]));
         }
-    order++;
+        order++;
     }
 
     writeCSV(output, file);
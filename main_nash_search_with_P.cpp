@@ -1,7 +1,10 @@
 #include "NormsWithPunishment.hpp"
 #include "GameWithPunishment.hpp"
+#include "SweepEngine.hpp"
 #include <fstream>
 
+using namespace with_punishment;
+
 
 int JudgeClass( const Norm& norm ) {
     constexpr Reputation G = Reputation::G, B = Reputation::B;
@@ -29,22 +32,19 @@ std::vector<int> EnumerateCESS(double benefit, double cost, double punishment, d
     const double assessment_error = 0.001;
     const double perception_error = 0.0;
 
-    std::vector<int> class_counts(7, 0); // 0 is for others
-    for (size_t i = 0; i < 4096ul; ++i) {
-        AssessmentRule R = AssessmentRule::MakeDeterministicRule(i);
-        for (size_t j = 0; j < 81; ++j) {
-            ActionRule S = ActionRule::MakeDeterministicRule(j);
-            Norm norm{ R, S };
-            Game sim(assessment_error, perception_error, norm);
-            if ( sim.resident_coop > 0.99 && sim.isESS(benefit, cost, punishment, punishment_cost) ) {
-                if (sim.equilibrium_state >= 0.5) {  // to remove GB-symmetry
-                    int c = JudgeClass(norm);
-                    class_counts[c]++;
-                }
+    // 0 is for others
+    CountSink class_counts = ParallelReduce(4096ul * 81ul, CountSink(7), [&](size_t k, CountSink& sink) {
+        AssessmentRule R = AssessmentRule::MakeDeterministicRule(k / 81);
+        ActionRule S = ActionRule::MakeDeterministicRule(k % 81);
+        Norm norm{ R, S };
+        Game sim(assessment_error, perception_error, norm);
+        if ( sim.resident_coop > 0.99 && sim.isESS(benefit, cost, punishment, punishment_cost) ) {
+            if (sim.equilibrium_state >= 0.5) {  // to remove GB-symmetry
+                sink.Add(JudgeClass(norm));
             }
         }
-    }
-    return class_counts;
+    });
+    return std::vector<int>(class_counts.counts.begin(), class_counts.counts.end());
 }
 
 int main() {
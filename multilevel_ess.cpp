@@ -0,0 +1,87 @@
+#include "Norms.hpp"
+#include "MultiLevelGame.hpp"
+#include "SweepEngine.hpp"
+
+#include <fstream>
+#include <chrono>
+
+using namespace two_action;
+
+
+// Graded versions of all 4096 deterministic two-action norms with M reputation levels:
+// stationary level distribution, cooperation and ESS verdict against the 16 action
+// rules that only look at the good/bad classes of the levels.
+template <int M>
+int Run(const std::string& filename, double assessment_error, double perception_error, double mu_e,
+        double benefit, double cost, unsigned num_threads) {
+    using Game = MultiLevelGame<M>;
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error opening file!" << std::endl;
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<MultiLevelNorm<M>> norms;
+    for (int id = 0; id < 4096; id++) { norms.push_back(MultiLevelNorm<M>::Graded(Norm::ConstructFromID(id))); }
+    std::vector<typename Game::ActionRuleTable> invaders;
+    for (int i = 0; i < 16; i++) { invaders.push_back(MultiLevelNorm<M>::GradedActionRule(ActionRule::MakeDeterministicRule(i))); }
+
+    auto solutions = Game::calc_equilibrium_states(norms, assessment_error, perception_error, mu_e, num_threads);
+    std::vector<double> coop(norms.size());
+    std::vector<uint8_t> ess(norms.size());
+    ParallelFor(norms.size(), [&](size_t begin, size_t end, unsigned) {
+        for (size_t n = begin; n < end; n++) {
+            // the constructor resumes from the batch solution and stops at once
+            Game game(assessment_error, perception_error, mu_e, norms[n], solutions[n].state);
+            coop[n] = game.resident_coop;
+            ess[n] = game.isESS(invaders, benefit, cost);
+        }
+    }, num_threads);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    file << "norm_id,mean_image";
+    for (int l = 0; l < M; l++) { file << ",level_" << l; }
+    file << ",cooperation,isESS,iterations,residual\n";
+    long num_ess = 0, unconverged = 0, iterations = 0;
+    for (size_t n = 0; n < norms.size(); n++) {
+        const auto& sol = solutions[n];
+        file << n << "," << Game::MeanImage(sol.state);
+        for (int l = 0; l < M; l++) { file << "," << sol.state[l]; }
+        file << "," << coop[n] << "," << static_cast<int>(ess[n]) << "," << sol.iterations << "," << sol.residual << "\n";
+        num_ess += ess[n];
+        unconverged += sol.residual >= 1e-12;
+        iterations += sol.iterations;
+    }
+    std::cout << num_ess << " ESS norms, " << unconverged << " unconverged, "
+              << static_cast<double>(iterations) / norms.size() << " iterations per norm" << std::endl;
+    std::cout << "done in " << seconds << " s" << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 8 || argc > 9) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <output csv> <levels 2-5> <assessment_error> <perception_error> <mu_e> <benefit> <cost> [threads]"
+                  << std::endl;
+        return 1;
+    }
+    std::string filename = argv[1];
+    int levels = std::stoi(argv[2]);
+    double assessment_error = std::stod(argv[3]);
+    double perception_error = std::stod(argv[4]);
+    double mu_e = std::stod(argv[5]);
+    double benefit = std::stod(argv[6]);
+    double cost = std::stod(argv[7]);
+    unsigned num_threads = (argc == 9) ? std::stoul(argv[8]) : 0;
+
+    switch (levels) {
+        case 2: return Run<2>(filename, assessment_error, perception_error, mu_e, benefit, cost, num_threads);
+        case 3: return Run<3>(filename, assessment_error, perception_error, mu_e, benefit, cost, num_threads);
+        case 4: return Run<4>(filename, assessment_error, perception_error, mu_e, benefit, cost, num_threads);
+        case 5: return Run<5>(filename, assessment_error, perception_error, mu_e, benefit, cost, num_threads);
+        default:
+            std::cerr << "levels must be between 2 and 5" << std::endl;
+            return 1;
+    }
+}
@@ -0,0 +1,206 @@
+#include "QueryService.hpp"
+
+#include <thread>
+#include <set>
+#include <condition_variable>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace two_action;
+
+
+void PrintUsage(const char* name) {
+    std::cerr << "Usage:\n"
+              << "  " << name << " serve <socket> [--cache <file>] [--bitmaps <file>]... [--threads <n>]\n"
+              << "  " << name << " query <socket> <request>...\n"
+              << "Requests (see QueryService.hpp):\n"
+              << "  ess <norm> <ae> <pe> <mu_e> <b> <c>\n"
+              << "  range <norms> <ae> <pe> <mu_e> <b> <c>    (values as a:b:step or lists)\n"
+              << "  ess_set <ae> <pe> <mu_e> <b> <c>\n"
+              << "  stats | quit | shutdown" << std::endl;
+}
+
+// Output stream over a socket, flushed by the service after every reply.
+class SocketBuffer : public std::streambuf {
+    public:
+        explicit SocketBuffer(int fd) : fd(fd), buffer(1 << 16) { setp(buffer.data(), buffer.data() + buffer.size()); }
+        ~SocketBuffer() override { sync(); }
+
+    protected:
+        int overflow(int c) override {
+            if (sync() != 0) { return traits_type::eof(); }
+            if (c != traits_type::eof()) { *pptr() = static_cast<char>(c); pbump(1); }
+            return c;
+        }
+
+        int sync() override {
+            const char* p = pbase();
+            while (p < pptr()) {
+                ssize_t sent = ::send(fd, p, pptr() - p, MSG_NOSIGNAL);
+                if (sent <= 0) { return -1; }
+                p += sent;
+            }
+            setp(buffer.data(), buffer.data() + buffer.size());
+            return 0;
+        }
+
+    private:
+        int fd;
+        std::vector<char> buffer;
+};
+
+// Calls on_line for every line received on `fd` until it returns false or the peer closes.
+template <typename OnLine>
+void ReadLines(int fd, OnLine&& on_line) {
+    std::string pending;
+    char chunk[4096];
+    for (;;) {
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) { return; }
+        pending.append(chunk, n);
+        size_t newline;
+        while ((newline = pending.find('\n')) != std::string::npos) {
+            std::string line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            if (!on_line(line)) { return; }
+        }
+    }
+}
+
+sockaddr_un Address(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) { throw std::runtime_error("socket path too long: " + path); }
+    std::strcpy(address.sun_path, path.c_str());
+    return address;
+}
+
+int Serve(const std::string& path, ResultCache* cache, std::vector<ESSBitmapStore> bitmaps, unsigned num_threads) {
+    QueryService service(cache, num_threads);
+    for (auto& store : bitmaps) { service.AddBitmaps(std::move(store)); }
+
+    int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address = Address(path);
+    ::unlink(path.c_str());
+    if (server < 0 || ::bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(server, 64) != 0) {
+        std::cerr << "Cannot listen on " << path << std::endl;
+        return 1;
+    }
+    std::cout << "Listening on " << path << std::endl;
+
+    // one thread per connection; "shutdown" from any client stops the server, which then
+    // closes the other connections and waits for their threads
+    std::atomic<bool> stop{false};
+    std::mutex clients_mutex;
+    std::condition_variable clients_done;
+    std::set<int> clients;
+    for (;;) {
+        int client = ::accept(server, nullptr, nullptr);
+        if (stop) {
+            if (client >= 0) { ::close(client); }
+            break;
+        }
+        if (client < 0) { continue; }
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            clients.insert(client);
+        }
+        std::thread([&, client]() {
+            {
+                SocketBuffer buffer(client);
+                std::ostream out(&buffer);
+                ReadLines(client, [&](const std::string& line) {
+                    if (line == "shutdown") {
+                        out << "ok shutdown\n";
+                        out.flush();
+                        stop = true;
+                        ::shutdown(server, SHUT_RDWR);
+                        return false;
+                    }
+                    return service.Handle(line, out);
+                });
+            }
+            ::close(client);
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            clients.erase(client);
+            clients_done.notify_all();
+        }).detach();
+    }
+    std::unique_lock<std::mutex> lock(clients_mutex);
+    for (int client : clients) { ::shutdown(client, SHUT_RDWR); }
+    clients_done.wait(lock, [&] { return clients.empty(); });
+    ::close(server);
+    ::unlink(path.c_str());
+    return 0;
+}
+
+// Sends one request and prints the reply: one line, or rows up to "end".
+int Query(const std::string& path, const std::string& request) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address = Address(path);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Cannot connect to " << path << std::endl;
+        return 1;
+    }
+    const std::string line = request + "\n";
+    if (::send(fd, line.data(), line.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(line.size())) { return 1; }
+    int status = 1;
+    ReadLines(fd, [&](const std::string& reply) {
+        std::cout << reply << "\n";
+        if (reply.compare(0, 5, "error") == 0) { return false; }
+        if (reply.compare(0, 2, "ok") == 0 || reply.compare(0, 3, "end") == 0) {
+            status = 0;
+            return false;
+        }
+        return true;
+    });
+    ::close(fd);
+    return status;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    std::string command = argv[1], path = argv[2];
+    try {
+        if (command == "query") {
+            if (argc < 4) { PrintUsage(argv[0]); return 1; }
+            std::string request = argv[3];
+            for (int i = 4; i < argc; i++) { request += std::string(" ") + argv[i]; }
+            return Query(path, request);
+        }
+        if (command != "serve") { PrintUsage(argv[0]); return 1; }
+
+        std::unique_ptr<ResultCache> cache;
+        std::vector<ESSBitmapStore> bitmaps;
+        unsigned num_threads = 0;
+        for (int i = 3; i < argc; i++) {
+            std::string option = argv[i];
+            if (i + 1 >= argc) { PrintUsage(argv[0]); return 1; }
+            std::string value = argv[++i];
+            if (option == "--cache") {
+                // the writer lock may be held, e.g. by batch_runner: then only read the file
+                try {
+                    cache.reset(new ResultCache(value, true));
+                } catch (const std::runtime_error&) {
+                    cache.reset(new ResultCache(value));
+                    std::cout << value << " is locked, opened read-only" << std::endl;
+                }
+            } else if (option == "--bitmaps") {
+                bitmaps.push_back(ESSBitmapStore::Load(value));
+            } else if (option == "--threads") {
+                num_threads = std::stoul(value);
+            } else {
+                PrintUsage(argv[0]);
+                return 1;
+            }
+        }
+        return Serve(path, cache.get(), std::move(bitmaps), num_threads);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,84 @@
+#include "PrivateAssessment.hpp"
+
+#include <chrono>
+#include <iomanip>
+
+
+// Simulates a resident norm and an invader action rule under private assessment and
+// prints the share of good images, the observers' agreement, the action rates and
+// the payoffs of both types. Replicates run on all threads.
+int main(int argc, char* argv[]) {
+    if (argc != 13 && argc != 15) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <num_actions> <norm ID> <invader action rule ID> <invaders> <population_size>"
+                  << " <assessment_error> <perception_error> <mu_e> <observation_probability> <rounds>"
+                  << " <benefit> <cost> [punishment punishment_cost]" << std::endl;
+        return 1;
+    }
+    int num_actions = std::stoi(argv[1]);
+    int norm_id = std::stoi(argv[2]);
+    int invader_id = std::stoi(argv[3]);
+    size_t invaders = std::stoul(argv[4]);
+    size_t population_size = std::stoul(argv[5]);
+    double assessment_error = std::stod(argv[6]);
+    double perception_error = std::stod(argv[7]);
+    double mu_e = std::stod(argv[8]);
+    double observation_probability = std::stod(argv[9]);
+    size_t rounds = std::stoul(argv[10]);
+    double benefit = std::stod(argv[11]);
+    double cost = std::stod(argv[12]);
+    double punishment = (argc == 15) ? std::stod(argv[13]) : 0.0;
+    double punishment_cost = (argc == 15) ? std::stod(argv[14]) : 0.0;
+    if (invaders >= population_size) {
+        std::cerr << "The population must contain residents" << std::endl;
+        return 1;
+    }
+
+    // norm ID = (assessment ID << action bits) | action rule ID, as in Norm::ID()
+    const int action_bits = (num_actions == 2) ? 4 : 7;
+    int assessment_id = norm_id >> action_bits;
+    int resident_id = norm_id & ((1 << action_bits) - 1);
+    const size_t replicates = NumWorkerThreads();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<PrivateAssessmentSimulator::Stats> stats(replicates);
+    ParallelFor(replicates, [&](size_t begin, size_t end, unsigned) {
+        for (size_t r = begin; r < end; r++) {
+            PrivateAssessmentSimulator sim(num_actions, assessment_id, {resident_id, invader_id},
+                                           {population_size - invaders, invaders}, assessment_error,
+                                           perception_error, mu_e, observation_probability);
+            CounterRNG rng(1, r);
+            sim.Initialize(rng, 1.0);
+            stats[r] = sim.Run(rng, rounds / 10, rounds);
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    auto total = stats[0];
+    for (size_t r = 1; r < replicates; r++) { total.Merge(stats[r]); }
+
+    const double share[2] = {(population_size - invaders) / static_cast<double>(population_size),
+                             invaders / static_cast<double>(population_size)};
+    const char* names[2] = {"resident", "invader"};
+    std::cout << "agreement: " << total.Agreement() << std::endl;
+    for (size_t t = 0; t < 2; t++) {
+        if (share[t] == 0.0) { continue; }
+        double payoff = 0.0;
+        for (size_t j = 0; j < 2; j++) {
+            payoff += share[j] * (benefit * total.Rate(j, t, 1) - cost * total.Rate(t, j, 1));
+            if (num_actions == 3) {
+                payoff -= share[j] * (punishment * total.Rate(j, t, 2) + punishment_cost * total.Rate(t, j, 2));
+            }
+        }
+        std::cout << names[t] << ": good " << total.Good(t) << ", payoff " << payoff;
+        for (size_t j = 0; j < 2; j++) {
+            if (share[j] == 0.0) { continue; }
+            std::cout << ", C to " << names[j] << " " << total.Rate(t, j, 1);
+        }
+        std::cout << std::endl;
+    }
+    // every interaction rewrites one image row of population_size bits
+    double interactions = (rounds + rounds / 10) * population_size * static_cast<double>(replicates);
+    std::cout << interactions / seconds << " interactions per second ("
+              << interactions * population_size / seconds / 1e9 << " G image updates per second)" << std::endl;
+    return 0;
+}
@@ -5,6 +5,11 @@ import matplotlib as mpl
 import sympy as sym
 import sys
 
+try:
+    import indirect_recip
+except ImportError:
+    indirect_recip = None
+
 plt.rcParams["font.family"] = "Arial"
 fontsizesmall = 11
 fontsizelarge = 13
@@ -83,9 +88,27 @@ def get_calc_function(n):
     }
     return functions.get(n, None)
 
+def load_errors(base):
+    # The grid of leading_eight_ESS_with_errors, computed in-process when the
+    # indirect_recip module is built and read from its CSV otherwise.
+    if indirect_recip is None:
+        return pd.read_csv(base + "leading_eight_ESS_with_errors.csv")
+    # rounded like the CSV, so that the lookups of exact error values below match
+    errors = np.round(np.arange(51) * 0.002, 6)
+    ids = [getattr(indirect_recip.Norm, f'L{i}')().id for i in range(1, 9)]
+    res = indirect_recip.sweep(ids, errors, errors, errors, benefit, cost)
+    norm, ae, pe, me = np.meshgrid(np.arange(len(ids)), errors, errors, errors, indexing='ij')
+    return pd.DataFrame({'order': norm.ravel() + 1,
+                         'ID': np.asarray(ids)[norm.ravel()],
+                         'h': res['h'].ravel(),
+                         'isNash': res['is_ess'].ravel(),
+                         'assessment_error': ae.ravel(),
+                         'perception_error': pe.ravel(),
+                         'mu_e': me.ravel()})
+
 if __name__ == "__main__":
     base = sys.argv[1]
-    df = pd.read_csv(base + "leading_eight_ESS_with_errors.csv")
+    df = load_errors(base)
 
     # L3 and L6
     fig, axes = plt.subplot_mosaic("""ABCDE
@@ -1,18 +1,94 @@
+import argparse
+import importlib.util
+import os
 import sys
-import subprocess
 
-if __name__ == "__main__":
-    if len(sys.argv) < 2:
-        print("Usage: python run_all_figures.py <base_data_path>")
-        sys.exit(1)
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from pipeline import Stage, ScriptStage, BatchStage, Pipeline, report
+
+# Producers of the datasets in the data folder: executable and output files. The
+# parameters are compiled in, so the executable's content stands for them.
+PRODUCERS = {
+    "leading_eight_with_errors": ["leading_eight_ESS_with_errors.csv"],
+    "equalizers_norms": ["equalizers_payoffs.csv"],
+    "L6_L3_payoff_difference": ["L6_L3_payoff_difference.csv"],
+}
+
+# Figure scripts, the datasets they read and the figures they write.
+FIGURES = {
+    "generate_figure_l8_errors.py": (["leading_eight_ESS_with_errors.csv"],
+                                     ["Figures/ErrorsL3L6.pdf", "Figures/ErrorsLeadingEight.pdf"]),  # Figures 1 and 4
+    "generate_figure_equalizers.py": (["equalizers_payoffs.csv"], ["Figures/Equalizers.pdf"]),        # Figure 2
+    "generate_figure_l3_l6_payoffs.py": (["L6_L3_payoff_difference.csv"],
+                                         ["Figures/L3_&_L6_payoff_diff.pdf"]),                        # Figure 3
+}
+
+# Figure scripts that compute their data with the indirect_recip module when it is
+# importable: they run in this process, where the module is loaded once, and their
+# stages also hash the module file.
+MODULE_SCRIPTS = {"generate_figure_l8_errors.py"}
+
 
-    base = sys.argv[1]
+def module_file(name):
+    """File of an importable module, or None."""
+    spec = importlib.util.find_spec(name)
+    return spec.origin if spec is not None and spec.origin and os.path.isfile(spec.origin) else None
 
-    # Creates Figures 1 and 4
-    subprocess.run(["python", "scripts/generate_figure_l8_errors.py", base], check=True)
 
-    # Creates Figure 2
-    subprocess.run(["python", "scripts/generate_figure_equalizers.py", base], check=True)
+def build_stages(base, build, batch_manifest=None, cache=None, threads=0):
+    stages, producer_of = [], {}
+    if batch_manifest:
+        batch = BatchStage("batch_runner", os.path.join(build, "batch_runner"), batch_manifest, base, threads, cache)
+        stages.append(batch)
+        producer_of = {o: batch.name for o in batch.outputs}
 
-    # Creates Figure 3
-    subprocess.run(["python", "scripts/generate_figure_l3_l6_payoffs.py", base], check=True)
+    for executable, outputs in PRODUCERS.items():
+        path = os.path.join(build, executable)
+        outputs = [os.path.join(base, o) for o in outputs]
+        if all(o in producer_of for o in outputs):
+            continue   # written by the jobs of the batch manifest
+        if not os.path.exists(path) and all(os.path.exists(o) for o in outputs):
+            continue   # data without a build: used as they are
+        stages.append(Stage(executable, [path, base], inputs=[path], outputs=outputs))
+        for o in outputs:
+            producer_of[o] = executable
+
+    scripts = os.path.dirname(os.path.abspath(__file__))
+    module = module_file("indirect_recip")
+    for script, (datasets, figures) in FIGURES.items():
+        datasets = [os.path.join(base, d) for d in datasets]
+        path = os.path.join(scripts, script)
+        deps = sorted({producer_of[d] for d in datasets if d in producer_of})
+        if script in MODULE_SCRIPTS:
+            inputs = [path] + datasets + ([module] if module else [])
+            stages.append(ScriptStage(script, path, [base], inputs=inputs, outputs=figures, deps=deps))
+        else:
+            stages.append(Stage(script, [sys.executable, path, base], inputs=[path] + datasets, outputs=figures,
+                                deps=deps))
+    return stages
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description="Regenerates the datasets and figures that are out of date.")
+    parser.add_argument("base", help="folder of the data, e.g. Data/")
+    parser.add_argument("--build", default="build", help="folder of the executables (default: build)")
+    parser.add_argument("--jobs", type=int, default=None, help="stages run at once (default: all cores)")
+    parser.add_argument("--batch", metavar="MANIFEST", help="also run the jobs of a batch_runner manifest")
+    parser.add_argument("--cache", metavar="FILE", help="result cache file for batch_runner")
+    parser.add_argument("--force", action="store_true", help="rerun every stage")
+    parser.add_argument("--dry-run", action="store_true", help="print the commands of the stages that would run")
+    parser.add_argument("targets", nargs="*", help="stages to bring up to date (default: all)")
+    args = parser.parse_intermixed_args()
+
+    base = os.path.join(args.base, "")
+    os.makedirs(base, exist_ok=True)
+    os.makedirs("Figures", exist_ok=True)
+    stages = build_stages(base, args.build, args.batch, args.cache)
+    pipeline = Pipeline(base, stages, jobs=args.jobs, force=args.force, dry_run=args.dry_run)
+    try:
+        ran = pipeline.run(args.targets or None)
+    except RuntimeError as e:
+        print(e, file=sys.stderr)
+        sys.exit(1)
+    report(ran, [s.name for s in stages])
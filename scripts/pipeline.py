@@ -0,0 +1,253 @@
+"""
+Incremental pipeline behind generate_figures.py.
+
+A stage runs one command (a data executable, a figure script or batch_runner) and
+records a manifest in `<base>/.manifests/<stage>.json`: the hash of everything the
+stage depends on (the command, its parameters and the content of its input files:
+executables, scripts, manifests and datasets) and the hashes of the files it wrote.
+A stage whose input hash is unchanged and whose outputs are still intact is skipped.
+Since figure stages hash the datasets they read, a producer that reruns but writes
+identical data does not invalidate its figures.
+
+Stages whose dependencies are done run in parallel; script stages run in this
+process, one at a time, so that the modules they import are loaded once. The jobs
+of a batch_runner manifest are partitions: each has its own hash, and only the
+stale jobs are rerun (in one batch_runner call, so they still share their games).
+"""
+import hashlib
+import json
+import os
+import runpy
+import subprocess
+import sys
+import tempfile
+import threading
+from concurrent.futures import ThreadPoolExecutor, FIRST_COMPLETED, wait
+
+_file_hashes = {}
+_in_process = threading.Lock()
+
+
+def file_hash(path):
+    """SHA-256 of a file, memoized on (path, size, mtime)."""
+    st = os.stat(path)
+    key = (os.path.abspath(path), st.st_size, st.st_mtime_ns)
+    if key not in _file_hashes:
+        h = hashlib.sha256()
+        with open(path, "rb") as f:
+            for chunk in iter(lambda: f.read(1 << 20), b""):
+                h.update(chunk)
+        _file_hashes[key] = h.hexdigest()
+    return _file_hashes[key]
+
+
+def digest(obj):
+    return hashlib.sha256(json.dumps(obj, sort_keys=True).encode()).hexdigest()
+
+
+class Stage:
+    """
+    `command` writes `outputs`; `inputs` are the files it reads, `params` anything else
+    that changes its results, and `deps` the stages producing some of its inputs.
+    """
+
+    def __init__(self, name, command, inputs=(), outputs=(), params=None, deps=()):
+        self.name = name
+        self.command = list(command)
+        self.inputs = list(inputs)
+        self.outputs = list(outputs)
+        self.params = params or {}
+        self.deps = list(deps)
+
+    def input_hash(self):
+        missing = [p for p in self.inputs if not os.path.exists(p)]
+        if missing:
+            raise RuntimeError(f"{self.name}: missing input {missing[0]}")
+        return digest({"command": self.command, "params": self.params,
+                       "inputs": {p: file_hash(p) for p in self.inputs}})
+
+    def run(self, pipeline):
+        """Runs the stage unless it is up to date; returns True if it ran."""
+        if pipeline.dry_run and any(d in pipeline.ran for d in self.deps):
+            # the inputs would change first
+            self.execute(pipeline)
+            return True
+        inputs = self.input_hash()
+        manifest = pipeline.load_manifest(self.name)
+        if not pipeline.force and pipeline.is_current(manifest, inputs):
+            return False
+        self.execute(pipeline)
+        pipeline.save_manifest(self.name, inputs, self.outputs)
+        return True
+
+    def execute(self, pipeline):
+        pipeline.execute(self.name, self.command)
+
+
+class ScriptStage(Stage):
+    """
+    A Python script run in this process with runpy instead of a subprocess, so that what
+    it imports (e.g. the indirect_recip module) is loaded once. Script stages take turns:
+    they share sys.argv and the pyplot state.
+    """
+
+    def __init__(self, name, script, args, inputs=(), outputs=(), deps=()):
+        super().__init__(name, [sys.executable, script] + list(args), inputs, outputs, deps=deps)
+        self.script = script
+        self.args = list(args)
+
+    def execute(self, pipeline):
+        print(f"[{self.name}] {' '.join(self.command)} (in process)", flush=True)
+        if pipeline.dry_run:
+            return
+        with _in_process:
+            argv, sys.argv = sys.argv, [self.script] + self.args
+            try:
+                runpy.run_path(self.script, run_name="__main__")
+            except SystemExit as e:
+                if e.code not in (None, 0):
+                    raise RuntimeError(f"{self.name} exited with {e.code}") from e
+            finally:
+                sys.argv = argv
+                pyplot = sys.modules.get("matplotlib.pyplot")
+                if pyplot is not None:
+                    pyplot.close("all")
+
+
+class BatchStage(Stage):
+    """The jobs of a batch_runner manifest, each a partition with its own manifest."""
+
+    def __init__(self, name, executable, manifest, base, threads=0, cache=None):
+        super().__init__(name, [executable], inputs=[executable, manifest])
+        self.manifest = manifest
+        self.base = base
+        self.threads = threads
+        self.cache = cache
+        self.jobs = self.parse(manifest)
+        self.outputs = [os.path.join(base, job["output"]) for job in self.jobs.values()]
+
+    @staticmethod
+    def parse(manifest):
+        """Sections of the manifest, as their normalized lines and output file."""
+        jobs, current = {}, None
+        with open(manifest) as f:
+            for line in f:
+                line = line.split("#", 1)[0].strip()
+                if not line:
+                    continue
+                if line.startswith("[job ") and line.endswith("]"):
+                    current = line[5:-1].strip()
+                    jobs[current] = {"lines": [], "output": None}
+                elif current is not None:
+                    jobs[current]["lines"].append(line)
+                    key, _, value = line.partition("=")
+                    if key.strip() == "output":
+                        jobs[current]["output"] = value.strip()
+        return jobs
+
+    def run(self, pipeline):
+        executable = file_hash(self.command[0])
+        stale = []
+        for job, spec in self.jobs.items():
+            inputs = digest({"executable": executable, "job": spec["lines"]})
+            manifest = pipeline.load_manifest(f"{self.name}.{job}")
+            if pipeline.force or not pipeline.is_current(manifest, inputs):
+                stale.append((job, inputs))
+        if not stale:
+            return False
+        with tempfile.NamedTemporaryFile("w", suffix=".manifest", delete=False) as f:
+            for job, _ in stale:
+                f.write(f"[job {job}]\n" + "\n".join(self.jobs[job]["lines"]) + "\n\n")
+            partial = f.name
+        try:
+            command = [self.command[0], partial, self.base, str(self.threads)]
+            if self.cache:
+                command.append(self.cache)
+            pipeline.execute(f"{self.name}: {', '.join(job for job, _ in stale)}", command)
+        finally:
+            os.remove(partial)
+        for job, inputs in stale:
+            pipeline.save_manifest(f"{self.name}.{job}", inputs,
+                                   [os.path.join(self.base, self.jobs[job]["output"])])
+        return True
+
+
+class Pipeline:
+    def __init__(self, base, stages, jobs=None, force=False, dry_run=False):
+        self.base = base
+        self.stages = {stage.name: stage for stage in stages}
+        self.jobs = jobs or os.cpu_count() or 1
+        self.force = force
+        self.dry_run = dry_run
+        self.manifest_dir = os.path.join(base, ".manifests")
+        self.ran = []
+
+    def load_manifest(self, name):
+        try:
+            with open(os.path.join(self.manifest_dir, name + ".json")) as f:
+                return json.load(f)
+        except (OSError, ValueError):
+            return None
+
+    def save_manifest(self, name, inputs, outputs):
+        if self.dry_run:
+            return
+        os.makedirs(self.manifest_dir, exist_ok=True)
+        record = {"stage": name, "inputs": inputs,
+                  "outputs": {p: file_hash(p) for p in outputs}}
+        path = os.path.join(self.manifest_dir, name + ".json")
+        with open(path + ".tmp", "w") as f:
+            json.dump(record, f, indent=1, sort_keys=True)
+        os.replace(path + ".tmp", path)
+
+    @staticmethod
+    def is_current(manifest, inputs):
+        if manifest is None or manifest.get("inputs") != inputs:
+            return False
+        return all(os.path.exists(p) and file_hash(p) == h for p, h in manifest["outputs"].items())
+
+    def execute(self, name, command):
+        print(f"[{name}] {' '.join(command)}", flush=True)
+        if self.dry_run:
+            return
+        result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+        if result.returncode != 0:
+            raise RuntimeError(f"{name} failed with exit code {result.returncode}:\n{result.stdout}")
+
+    def run(self, targets=None):
+        """Runs `targets` (all stages by default) and their dependencies; returns the stages that ran."""
+        unknown = [t for t in targets or [] if t not in self.stages]
+        if unknown:
+            raise RuntimeError(f"unknown stage {unknown[0]}; stages: {', '.join(self.stages)}")
+        wanted, todo = set(), list(targets or self.stages)
+        while todo:
+            name = todo.pop()
+            if name not in wanted:
+                wanted.add(name)
+                todo.extend(self.stages[name].deps)
+
+        done, ran, running = set(), self.ran, {}
+        ran.clear()
+        with ThreadPoolExecutor(max_workers=self.jobs) as pool:
+            while len(done) < len(wanted):
+                for name in sorted(wanted - done - set(running.values())):
+                    if all(d in done for d in self.stages[name].deps):
+                        running[pool.submit(self.stages[name].run, self)] = name
+                finished, _ = wait(running, return_when=FIRST_COMPLETED)
+                for future in finished:
+                    name = running.pop(future)
+                    try:
+                        if future.result():
+                            ran.append(name)
+                    except Exception as e:
+                        for other in running:
+                            other.cancel()
+                        raise RuntimeError(f"stage {name}: {e}") from e
+                    done.add(name)
+        return ran
+
+
+def report(ran, stages):
+    skipped = [s for s in stages if s not in ran]
+    print(f"{len(ran)} stage(s) ran: {', '.join(ran) or '-'}", file=sys.stderr)
+    print(f"{len(skipped)} stage(s) up to date: {', '.join(skipped) or '-'}", file=sys.stderr)
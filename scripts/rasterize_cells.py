@@ -0,0 +1,21 @@
+import numpy as np
+
+
+def rasterize(cells, x_col, y_col, resolution, extent=(0, 0.1), value="ess_fraction"):
+    """
+    Paints the sparse cell list written by `leading_eight_ESS_adaptive` onto a
+    regular `resolution` x `resolution` grid, so it can be passed to `imshow`
+    like the uniform data. Rows are indexed by `y_col` and columns by `x_col`.
+    """
+    lo, hi = extent
+    step = (hi - lo) / resolution
+    grid = np.zeros((resolution, resolution))
+
+    for _, cell in cells.iterrows():
+        x0 = int(round((cell[x_col] - lo) / step))
+        y0 = int(round((cell[y_col] - lo) / step))
+        x1 = int(round((cell[x_col] + cell["size_" + x_col] - lo) / step))
+        y1 = int(round((cell[y_col] + cell["size_" + y_col] - lo) / step))
+        grid[y0:max(y1, y0 + 1), x0:max(x1, x0 + 1)] = cell[value]
+
+    return grid
@@ -0,0 +1,66 @@
+#include "StationaryDistribution.hpp"
+#include "InvasionMatrix.hpp"
+
+#include <fstream>
+#include <numeric>
+#include <chrono>
+
+
+// Long-run abundance of the two-action norms of an invasion matrix (written by
+// invasion_matrix) in the small-mutation limit of a pairwise-comparison process.
+int main(int argc, char* argv[]) {
+    if (argc < 5 || argc > 6) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <invasion matrix file> <population size> <selection strength> <output csv> [gth|power]" << std::endl;
+        return 1;
+    }
+    InvasionMatrix m(argv[1]);
+    int population_size = std::stoi(argv[2]);
+    double selection_strength = std::stod(argv[3]);
+    std::string method = (argc == 6) ? std::string(argv[5]) : "gth";
+    if (m.Header().num_actions != 2) {
+        std::cerr << "Only two-action invasion matrices are supported" << std::endl;
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&start]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // column holding norm j as an invader; with action-rule columns only its action rule matters
+    const size_t n = m.Rows();
+    std::vector<size_t> column(n);
+    for (size_t j = 0; j < n; j++) {
+        int64_t id = m.Header().full_norm_invaders ? m.RowID(j) : (m.RowID(j) & 0xF);
+        size_t c = 0;
+        while (c < m.Cols() && m.ColID(c) != id) { c++; }
+        if (c == m.Cols()) {
+            std::cerr << "Norm " << m.RowID(j) << " has no invader column" << std::endl;
+            return 1;
+        }
+        column[j] = c;
+    }
+    auto payoffs = [&](size_t i, size_t j) {
+        return (i == j) ? m.ResidentPayoff(i) : m.ResidentPayoff(i) + m.Delta(i, column[j]);
+    };
+
+    MoranChain chain(n, payoffs, population_size, selection_strength);
+    std::cout << "transition matrix: " << elapsed() << " s" << std::endl;
+    std::vector<double> pi = (method == "power") ? chain.StationaryPowerIteration() : chain.StationaryGTH();
+    std::cout << "stationary distribution (" << method << "): " << elapsed() << " s" << std::endl;
+
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&pi](size_t a, size_t b) { return pi[a] > pi[b]; });
+
+    std::ofstream out(argv[4]);
+    out << "rank,ID,abundance,resident_payoff\n";
+    for (size_t r = 0; r < n; r++) {
+        size_t i = order[r];
+        out << r + 1 << "," << m.RowID(i) << "," << pi[i] << "," << m.ResidentPayoff(i) << "\n";
+    }
+    for (size_t r = 0; r < std::min<size_t>(10, n); r++) {
+        std::cout << "ID " << m.RowID(order[r]) << ": " << pi[order[r]] << std::endl;
+    }
+    return 0;
+}
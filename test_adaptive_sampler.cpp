@@ -0,0 +1,82 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "AdaptiveSampler.hpp"
+
+using namespace two_action;
+
+int main() {
+
+    // 1. Leaves of a quadtree cover the box exactly once
+    {
+        auto half_plane = [](const AdaptiveSampler<2>::Point& x) {
+            return AdaptiveSampler<2>::Sample{x[0], x[0] + x[1] < 0.07};
+        };
+        AdaptiveSampler<2> sampler({0.0, 0.0}, {0.1, 0.1}, 2, 6, 1.0, half_plane);
+        auto cells = sampler.Run();
+
+        double area = 0.0;
+        for (const auto& cell : cells) {
+            auto size = sampler.Size(cell);
+            area += size[0] * size[1];
+        }
+        assert (std::abs(area - 0.01) < 1e-12);
+
+        // 2. Only cells on the boundary are refined down to the finest level
+        for (const auto& cell : cells) {
+            auto lower = sampler.Lower(cell);
+            auto size = sampler.Size(cell);
+            if (cell.ess_fraction == 0.0 || cell.ess_fraction == 1.0) {
+                // a uniform cell of a convex region lies entirely on one side
+                double cx = lower[0] + size[0] / 2.0, cy = lower[1] + size[1] / 2.0;
+                assert ((cx + cy < 0.07) == (cell.ess_fraction == 1.0));
+            } else {
+                assert (cell.level == 6);
+            }
+        }
+
+        // 3. Far fewer evaluations than the uniform grid
+        assert (sampler.NumEvaluations() < sampler.NumUniformEvaluations() / 2);
+    }
+
+    // 4. Octree leaves cover the cube
+    {
+        auto sphere = [](const AdaptiveSampler<3>::Point& x) {
+            double r2 = x[0] * x[0] + x[1] * x[1] + x[2] * x[2];
+            return AdaptiveSampler<3>::Sample{0.0, r2 < 0.25};
+        };
+        AdaptiveSampler<3> sampler({0.0, 0.0, 0.0}, {1.0, 1.0, 1.0}, 1, 5, 1.0, sphere);
+        double volume = 0.0;
+        for (const auto& cell : sampler.Run()) {
+            auto size = sampler.Size(cell);
+            volume += size[0] * size[1] * size[2];
+        }
+        assert (std::abs(volume - 1.0) < 1e-12);
+        assert (sampler.NumEvaluations() < sampler.NumUniformEvaluations());
+    }
+
+    // 5. Uniform cells of L3 agree with the ESS verdict at the cell centre
+    {
+        Norm norm = Norm::L3();
+        double benefit = 1.0, cost = 0.8, assessment_error = 0.02;
+        AdaptiveSampler<2> sampler({0.0, 0.0}, {0.1, 0.1}, 3, 6, 0.01,
+            [&](const AdaptiveSampler<2>::Point& x) {
+                Game sim(assessment_error, x[0], x[1], norm);
+                return AdaptiveSampler<2>::Sample{sim.equilibrium_state, sim.isESS(benefit, cost)};
+            });
+        auto cells = sampler.Run();
+        int boundary_cells = 0;
+        for (const auto& cell : cells) {
+            if (cell.ess_fraction != 0.0 && cell.ess_fraction != 1.0) {
+                boundary_cells++;
+                continue;
+            }
+            auto lower = sampler.Lower(cell);
+            auto size = sampler.Size(cell);
+            Game sim(assessment_error, lower[0] + size[0] / 2.0, lower[1] + size[1] / 2.0, norm);
+            assert (sim.isESS(benefit, cost) == (cell.ess_fraction == 1.0));
+        }
+        assert (boundary_cells > 0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "AgentSimulator.hpp"
+
+using namespace two_action;
+
+int main() {
+
+    // 1. The counter-based generator is reproducible and roughly uniform
+    {
+        CounterRNG a(7, 3), b(7, 3), c(7, 4);
+        bool differs = false;
+        for (int i = 0; i < 100; i++) {
+            uint64_t x = a.Next();
+            assert (x == b.Next());
+            differs |= (x != c.Next());
+        }
+        assert (differs);
+        CounterRNG rng(1, 0);
+        std::vector<long> bins(10, 0);
+        double mean = 0.0;
+        for (int i = 0; i < 100000; i++) {
+            double u = rng.Uniform();
+            assert (u >= 0.0 && u < 1.0);
+            mean += u;
+            bins[rng.Index(10)]++;
+        }
+        assert (std::abs(mean / 100000 - 0.5) < 0.01);
+        for (long k : bins) { assert (std::abs(k - 10000) < 500); }
+        assert (!rng.Bernoulli(CounterRNG::Threshold(0.0)));
+        assert (rng.Bernoulli(CounterRNG::Threshold(1.0)));
+    }
+
+    // 2. Without errors ALLC residents under image scoring are all good and fully cooperative
+    {
+        Norm norm(AssessmentRule::ImageScoring(), ActionRule::ALLC());
+        AgentSimulator sim(0.0, 0.0, 0.0, norm, ActionRule::ALLD(), 200, 20);
+        auto result = sim.Run(1.0, 0.2, 5, 50, 2, 5, 1, 2);
+        assert (result.resident_coop.mean == 1.0);
+        assert (result.coop_mut_to_res.mean == 0.0);
+        assert (result.coop_res_to_mut.mean == 1.0);
+        assert (result.invader_h.mean < 0.05);   // only the initial images of the invaders were good
+    }
+
+    // 3. The leading eight with all three errors match the analytic values
+    std::vector<Norm> l8_norms = {Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(),
+                                  Norm::L5(), Norm::L6(), Norm::L7(), Norm::L8()};
+    double assessment_error = 0.05, perception_error = 0.05, mu_e = 0.05;
+    for (const auto& norm : l8_norms) {
+        for (ActionRule invader : {ActionRule::ALLD(), ActionRule::ALLC(), ActionRule::DISC()}) {
+            Game game(assessment_error, perception_error, mu_e, norm);
+            auto [H, coop_mut_to_res, coop_res_to_mut] = game.calc_invader_stats(invader);
+            AgentSimulator sim(assessment_error, perception_error, mu_e, norm, invader, 500, 50);
+            auto result = sim.Run(1.0, 0.2, 200, 2000, 4, 10, 11);
+            // the populations are finite, so allow a little more than the sampling error
+            assert (result.h.Contains(game.equilibrium_state, 3.0));
+            assert (result.resident_coop.Contains(game.resident_coop, 3.0));
+            assert (result.invader_h.Contains(H, 3.0));
+            assert (result.coop_mut_to_res.Contains(coop_mut_to_res, 3.0));
+            assert (result.coop_res_to_mut.Contains(coop_res_to_mut, 3.0));
+            assert (result.h.half_width < 0.01);
+        }
+    }
+
+    // 4. Results do not depend on the number of threads
+    {
+        AgentSimulator sim(0.02, 0.01, 0.01, Norm::L3(), ActionRule::ALLD(), 300, 30);
+        auto r1 = sim.Run(1.0, 0.2, 10, 100, 4, 5, 5, 1);
+        auto r3 = sim.Run(1.0, 0.2, 10, 100, 4, 5, 5, 3);
+        assert (r1.h.mean == r3.h.mean && r1.invader_payoff.mean == r3.invader_payoff.mean);
+        assert (r1.interactions == r3.interactions);
+        assert (r1.threads == 1 && r3.threads == 3);
+        assert (sim.Run(1.0, 0.2, 10, 100, 2, 5, 5, 8).threads == 2);   // no more workers than replicates
+    }
+
+    return 0;
+}
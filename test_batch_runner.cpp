@@ -0,0 +1,238 @@
+#include <iostream>
+#include <cassert>
+#include <sstream>
+#include "BatchRunner.hpp"
+
+std::vector<batch::Job> Parse(const std::string& text) {
+    std::istringstream in(text);
+    return batch::ParseManifest(in);
+}
+
+bool Throws(const std::string& text) {
+    try { Parse(text); } catch (const std::runtime_error&) { return true; }
+    return false;
+}
+
+int main() {
+
+    const std::string two_jobs =
+        "# comment\n"
+        "[job rows]\n"
+        "norms = L1, L6, 765\n"
+        "assessment_error = 0:0.04:0.02   # three values\n"
+        "perception_error = 0.01\n"
+        "mu_e = 0.0,0.05\n"
+        "benefit = 1\n"
+        "cost = 0.2,0.8\n"
+        "columns = h,is_ess,delta_v,ess_margin\n"
+        "output = rows.csv\n"
+        "\n"
+        "[job summary]\n"
+        "model = two_action\n"
+        "norms = leading_eight\n"
+        "assessment_error = 0:0.04:0.02\n"
+        "perception_error = 0.01\n"
+        "mu_e = 0.0,0.05\n"
+        "benefit = 1\n"
+        "cost = 0.5\n"
+        "columns = is_ess,cooperation\n"
+        "sink = summary\n"
+        "output = summary.csv\n";
+
+    // 1. parsing: norm sets, ranges with the stop included and lists
+    {
+        auto jobs = Parse(two_jobs);
+        assert (jobs.size() == 2);
+        assert (jobs[0].name == "rows" && jobs[0].model == batch::Model::TwoAction && jobs[0].sink == "rows");
+        assert ((jobs[0].norms == std::vector<int>{two_action::Norm::L1().ID(), two_action::Norm::L6().ID(), 765}));
+        assert (jobs[0].axes[0].values.size() == 3 && std::abs(jobs[0].axes[0].values[2] - 0.04) < 1e-15);
+        assert (jobs[0].axes[4].name == "cost" && jobs[0].axes[4].values.size() == 2);
+        assert (jobs[0].NumPoints() == 3 * 3 * 1 * 2 * 1 * 2);
+        assert (jobs[1].norms.size() == 8 && jobs[1].NumPoints() == 8 * 6);
+        assert (batch::detail::ParseValues("0:0.1:0.002").size() == 51);
+        assert (batch::detail::ParseNorms("all", batch::Model::TwoAction).size() == 4096);
+        assert (batch::detail::ParseNorms("all", batch::Model::WithPunishment).size() == 4096 * 81);
+    }
+
+    // 2. malformed manifests are rejected
+    {
+        const std::string job = "[job x]\nnorms = 1\nassessment_error = 0\nperception_error = 0\nmu_e = 0\n"
+                                "benefit = 1\ncost = 0.2\ncolumns = h\noutput = x.csv\n";
+        assert (!Throws(job));
+        assert (Throws("norms = 1\n"));
+        assert (Throws(job + "colour = red\n"));
+        assert (Throws(job + "norms = 2\n"));
+        assert (Throws("[job x]\nnorms = 1\noutput = x.csv\ncolumns = h\n"));       // missing axes
+        assert (Throws(job + "sink = histogram\n"));
+        assert (Throws(job + "sink = summary\n"));                                  // no is_ess column
+        assert (Throws(job + "model = three_action\n"));
+        assert (Throws("[job x]\nnorms = 4096\nassessment_error = 0\nperception_error = 0\nmu_e = 0\n"
+                       "benefit = 1\ncost = 0.2\ncolumns = h\noutput = x.csv\n"));
+        assert (Throws("[job x]\nnorms = 1\nassessment_error = 0.1:0:0.01\nperception_error = 0\nmu_e = 0\n"
+                       "benefit = 1\ncost = 0.2\ncolumns = h\noutput = x.csv\n"));
+        assert (Throws("[job x]\nmodel = with_punishment\nnorms = 81\nassessment_error = 0\nperception_error = 0\n"
+                       "benefit = 1\ncost = 0.2\npunishment = 0.5\npunishment_cost = 0.1\ncolumns = h\noutput = x.csv\n"));
+    }
+
+    // 3. results equal those of a direct Game; the games are shared across jobs and
+    //    across the payoff parameters
+    {
+        batch::BatchRunner runner(Parse(two_jobs));
+        runner.Run(3);
+        assert (runner.num_points == 36 + 48);
+        assert (runner.num_games == 8 * 6 + 6);   // the leading eight and 765, times 3 x 2 error rates
+
+        for (size_t j = 0; j < 2; j++) {
+            const auto& job = runner.jobs[j];
+            for (size_t k = 0; k < job.NumPoints(); k++) {
+                auto [id, v] = batch::BatchRunner::Point(job, k);
+                two_action::Game game(v[0], v[1], v[2], two_action::Norm::ConstructFromID(id));
+                const double* row = &runner.results[j][k * job.columns.size()];
+                if (j == 0) {
+                    assert (row[0] == game.equilibrium_state);
+                    assert (row[1] == game.isESS(v[3], v[4]));
+                    assert (row[2] == game.calc_delta_v(v[3], v[4]));
+                    assert (row[3] == game.calc_ess_margin(v[3], v[4]));
+                } else {
+                    assert (row[0] == game.isESS(v[3], v[4]));
+                    assert (row[1] == game.resident_coop);
+                }
+            }
+        }
+
+        batch::BatchRunner serial(Parse(two_jobs));
+        serial.Run(1);
+        assert (serial.results == runner.results);
+
+        std::ostringstream rows, summary;
+        runner.Write(0, rows);
+        runner.Write(1, summary);
+        std::string line;
+        std::istringstream rows_in(rows.str()), summary_in(summary.str());
+        std::getline(rows_in, line);
+        assert (line == "norm_id,assessment_error,perception_error,mu_e,benefit,cost,h,is_ess,delta_v,ess_margin");
+        int num_rows = 0;
+        while (std::getline(rows_in, line)) { num_rows++; }
+        assert (num_rows == 36);
+        std::getline(summary_in, line);
+        assert (line == "norm_id,points,ess_points,ess_fraction,mean_cooperation_ess");
+        int num_norms = 0;
+        while (std::getline(summary_in, line)) {
+            std::istringstream fields(line);
+            std::string id, points;
+            std::getline(fields, id, ',');
+            std::getline(fields, points, ',');
+            assert (points == "6");
+            num_norms++;
+        }
+        assert (num_norms == 8);
+    }
+
+    // 4. the model with punishment; only_ess keeps the ESS rows
+    {
+        auto jobs = Parse("[job p]\nmodel = with_punishment\nnorms = all\nassessment_error = 0.02\n"
+                          "perception_error = 0.02\nbenefit = 1\ncost = 0.2\npunishment = 0.5\n"
+                          "punishment_cost = 0.1\ncolumns = resident_punishment,is_ess\nonly_ess = true\noutput = p.csv\n");
+        // a slice of the norms keeps the test fast
+        jobs[0].norms.resize(81 * 40);
+        batch::BatchRunner runner(jobs);
+        runner.Run(2);
+        long ess = 0;
+        for (size_t k = 0; k < jobs[0].norms.size(); k++) {
+            with_punishment::Game game(0.02, 0.02, with_punishment::Norm::ConstructFromID(jobs[0].norms[k]));
+            assert (runner.results[0][2 * k] == game.resident_punishment);
+            assert (runner.results[0][2 * k + 1] == game.isESS(1.0, 0.2, 0.5, 0.1));
+            ess += game.isESS(1.0, 0.2, 0.5, 0.1);
+        }
+        std::ostringstream out;
+        runner.Write(0, out);
+        std::istringstream in(out.str());
+        std::string line;
+        long num_rows = -1;
+        while (std::getline(in, line)) { num_rows++; }
+        assert (num_rows == ess);
+    }
+
+    // 5. layouts, the invaders sink with rescaled payoffs and the equalizer norms
+    {
+        const std::string job = "[job x]\nnorms = 1\nassessment_error = 0\nperception_error = 0\nmu_e = 0\n"
+                                "benefit = 1\ncost = 0.2\ncolumns = h\noutput = x.csv\n";
+        assert (!Throws(job + "layout = order, norm_id as ID, h\n"));
+        assert (Throws(job + "layout = order, invader\n"));                      // rows sink
+        assert (Throws(job + "layout = is_ess\n"));                              // not a column
+        assert (Throws(job + "skip_resident = true\n"));
+        assert (Throws("[job x]\nnorms = 1\nassessment_error = 0\nperception_error = 0\nmu_e = 0\nbenefit = 1\n"
+                       "cost = 0.2\ncolumns = is_ess\nsink = summary\nlayout = order\noutput = x.csv\n"));
+        assert (Throws("[job x]\nmodel = with_punishment\nnorms = generous_scoring_equalizer\nassessment_error = 0\n"
+                       "perception_error = 0\nbenefit = 1\ncost = 0.2\npunishment = 0.5\npunishment_cost = 0.1\n"
+                       "columns = h\noutput = x.csv\n"));
+        bool rejected = false;   // queries and other callers take IDs only
+        try { batch::detail::ParseNorms("generous_scoring_equalizer", batch::Model::TwoAction); }
+        catch (const std::invalid_argument&) { rejected = true; }
+        assert (rejected);
+
+        auto jobs = Parse("[job l8]\nnorms = L1,L3\nassessment_error = 0.02\nperception_error = 0.01,0.03\nmu_e = 0.02\n"
+                          "benefit = 1\ncost = 0.5\ncolumns = h,is_ess\n"
+                          "layout = order, norm_id as ID, h, is_ess as isNash, assessment_error, perception_error, mu_e\n"
+                          "output = l8.csv\n"
+                          "[job payoffs]\nnorms = L3,generous_scoring_equalizer,cautious_scoring_equalizer\n"
+                          "assessment_error = 0.1\nperception_error = 0.1\nmu_e = 0.1\nbenefit = 1\ncost = 0.2,0.6\n"
+                          "columns = resident_payoff\nsink = invaders\nskip_resident = true\nrescale_payoffs = true\n"
+                          "layout = norm_id as ID, cost, invader as SID, invader_BG as BG, resident_payoff as selfpay, "
+                          "invader_payoff as mutantpay\noutput = payoffs.csv\n");
+        assert (jobs[1].layout[2] == std::make_pair(std::string("SID"), std::string("invader")));
+        batch::BatchRunner runner(jobs);
+        runner.Run(2);
+        assert (runner.num_games == 2 * 2 + 1 + 2 * 2);   // the equalizers differ with the cost
+
+        std::ostringstream l8, payoffs;
+        runner.Write(0, l8);
+        runner.Write(1, payoffs);
+        std::istringstream l8_in(l8.str()), payoffs_in(payoffs.str());
+        std::string line;
+        std::getline(l8_in, line);
+        assert (line == "order,ID,h,isNash,assessment_error,perception_error,mu_e");
+        for (int order = 1; order <= 2; order++) {
+            const two_action::Norm norm = (order == 1) ? two_action::Norm::L1() : two_action::Norm::L3();
+            for (double pe : {0.01, 0.03}) {
+                two_action::Game game(0.02, pe, 0.02, norm);
+                std::ostringstream expected;
+                expected << order << "," << norm.ID() << "," << game.equilibrium_state << ","
+                         << game.isESS(1.0, 0.5) << ",0.02," << pe << ",0.02";
+                std::getline(l8_in, line);
+                assert (line == expected.str());
+            }
+        }
+
+        // the payoffs of L6_L3_payoff_difference, and equalizers built as in equalizers_norms
+        std::getline(payoffs_in, line);
+        assert (line == "ID,cost,SID,BG,selfpay,mutantpay");
+        long num_rows = 0;
+        for (int n = 0; n < 3; n++) {
+            for (double cost : {0.2, 0.6}) {
+                const double y = cost / ((1 - 2 * 0.1) * 1.0), x = 1.0 - y;
+                const two_action::Norm norm = (n == 0) ? two_action::Norm::L3()
+                    : two_action::Norm(two_action::AssessmentRule(n == 1 ? std::array<double, 8>{x, 1, x, 1, x, 1, x, 1}
+                                                                         : std::array<double, 8>{0, y, x, 1, 0, y, x, 1}),
+                                       two_action::ActionRule::DISC());
+                two_action::Game game(0.1, 0.1, 0.1, norm);
+                const double r_benefit = (1.0 - 0.1) * 1.0, r_cost = (1.0 - 0.1) * cost;
+                for (int i = 0; i < 16; i++) {
+                    if (i == norm.action_rule.ID()) { continue; }
+                    const auto invader = two_action::ActionRule::MakeDeterministicRule(i);
+                    std::ostringstream expected;
+                    expected << (n == 0 ? norm.ID() : -n) << "," << cost << "," << i << "," << invader.coop_probs[1] << ","
+                             << (r_benefit - r_cost) * game.resident_coop << ","
+                             << game.calc_invader_payoff(invader, r_benefit, r_cost);
+                    std::getline(payoffs_in, line);
+                    assert (line == expected.str());
+                    num_rows++;
+                }
+            }
+        }
+        assert (num_rows == 3 * 2 * 15 && !std::getline(payoffs_in, line));
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include "indirect_recip.h"
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "NormsWithPunishment.hpp"
+#include "GameWithPunishment.hpp"
+#include <random>
+
+int main() {
+    assert (ir_api_version() == IR_API_VERSION);
+
+    // 1. Two-action batch against Game
+    {
+        const size_t n = 3000;
+        std::mt19937_64 rng(5);
+        std::uniform_real_distribution<double> uniform;
+        std::vector<int32_t> ids(n);
+        std::vector<double> params(n * IR_TWO_ACTION_TUPLE);
+        for (size_t i = 0; i < n; i++) {
+            ids[i] = static_cast<int32_t>(rng() % 4096);
+            double* p = &params[i * IR_TWO_ACTION_TUPLE];
+            p[0] = 0.1 * uniform(rng); p[1] = 0.1 * uniform(rng); p[2] = 0.1 * uniform(rng);
+            p[3] = 1.0; p[4] = uniform(rng);
+        }
+        std::vector<double> h(n), coop(n), delta_v(n), margin(n);
+        std::vector<uint8_t> ess(n);
+        assert (ir_two_action_evaluate(n, ids.data(), params.data(), 3, h.data(), coop.data(), delta_v.data(),
+                                       margin.data(), ess.data()) == IR_OK);
+        assert (std::strlen(ir_last_error()) == 0);
+        for (size_t i = 0; i < n; i++) {
+            const double* p = &params[i * IR_TWO_ACTION_TUPLE];
+            two_action::Game game(p[0], p[1], p[2], two_action::Norm::ConstructFromID(ids[i]));
+            assert (h[i] == game.equilibrium_state && coop[i] == game.resident_coop);
+            assert (delta_v[i] == game.calc_delta_v(p[3], p[4]) && margin[i] == game.calc_ess_margin(p[3], p[4]));
+            assert (static_cast<bool>(ess[i]) == game.isESS(p[3], p[4]));
+        }
+
+        // outputs can be skipped
+        std::vector<double> h_only(n, -1.0);
+        assert (ir_two_action_evaluate(n, ids.data(), params.data(), 0, h_only.data(), nullptr, nullptr, nullptr, nullptr) == IR_OK);
+        assert (h_only == h);
+    }
+
+    // 2. Punishment batch against with_punishment::Game
+    {
+        const size_t n = 500;
+        std::mt19937_64 rng(6);
+        std::uniform_real_distribution<double> uniform;
+        std::vector<int32_t> ids(n);
+        std::vector<double> params(n * IR_WITH_PUNISHMENT_TUPLE);
+        for (size_t i = 0; i < n; i++) {
+            ids[i] = static_cast<int32_t>(((rng() % 4096) << 7) | (rng() % 81));
+            double* p = &params[i * IR_WITH_PUNISHMENT_TUPLE];
+            p[0] = 0.1 * uniform(rng); p[1] = 0.1 * uniform(rng);
+            p[2] = 1.0; p[3] = 0.2; p[4] = uniform(rng); p[5] = 0.1 * uniform(rng);
+        }
+        std::vector<double> h(n), coop(n), pun(n), delta_v(n);
+        std::vector<uint8_t> ess(n);
+        assert (ir_with_punishment_evaluate(n, ids.data(), params.data(), 2, h.data(), coop.data(), pun.data(),
+                                            delta_v.data(), ess.data()) == IR_OK);
+        for (size_t i = 0; i < n; i++) {
+            const double* p = &params[i * IR_WITH_PUNISHMENT_TUPLE];
+            with_punishment::Game game(p[0], p[1], with_punishment::Norm::ConstructFromID(ids[i]));
+            assert (h[i] == game.equilibrium_state && coop[i] == game.resident_coop && pun[i] == game.resident_punishment);
+            assert (delta_v[i] == game.calc_delta_v(p[2], p[3], p[4], p[5]));
+            assert (static_cast<bool>(ess[i]) == game.isESS(p[2], p[3], p[4], p[5]));
+        }
+    }
+
+    // 3. Invalid arguments are rejected before anything is written
+    {
+        int32_t ids[2] = {10, 4096};
+        double params[2 * IR_TWO_ACTION_TUPLE] = {0.01, 0.01, 0.01, 1.0, 0.2, 0.01, 0.01, 0.01, 1.0, 0.2};
+        double h[2] = {-1.0, -1.0};
+        assert (ir_two_action_evaluate(2, ids, params, 0, h, nullptr, nullptr, nullptr, nullptr) == IR_ERROR_INVALID_ARGUMENT);
+        assert (std::strstr(ir_last_error(), "norm_ids[1]") != nullptr);
+        assert (h[0] == -1.0 && h[1] == -1.0);
+
+        assert (ir_with_punishment_evaluate(1, ids, params, 0, h, nullptr, nullptr, nullptr, nullptr) == IR_OK);
+        int32_t unused_action = 81;
+        assert (ir_with_punishment_evaluate(1, &unused_action, params, 0, h, nullptr, nullptr, nullptr, nullptr)
+                == IR_ERROR_INVALID_ARGUMENT);
+
+        ids[1] = 0;
+        params[0] = 1.5;
+        assert (ir_two_action_evaluate(2, ids, params, 0, h, nullptr, nullptr, nullptr, nullptr) == IR_ERROR_INVALID_ARGUMENT);
+        assert (std::strstr(ir_last_error(), "params[0]") != nullptr);
+        assert (ir_two_action_evaluate(1, nullptr, params, 0, h, nullptr, nullptr, nullptr, nullptr) == IR_ERROR_INVALID_ARGUMENT);
+        assert (ir_two_action_evaluate(0, nullptr, nullptr, 0, nullptr, nullptr, nullptr, nullptr, nullptr) == IR_OK);
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <cassert>
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "Dual.hpp"
+
+using namespace two_action;
+
+using D5 = Dual<5>;   // assessment error, perception error, mu_e, benefit, cost
+
+// Every quantity the dual game differentiates, evaluated in double precision.
+std::vector<double> Quantities(const Norm& norm, const std::array<double, 5>& p) {
+    Game game(p[0], p[1], p[2], norm);
+    std::vector<double> q = {game.equilibrium_state, game.resident_coop, game.calc_delta_v(p[3], p[4]),
+                             game.calc_resident_payoff(p[3], p[4])};
+    for (int i = 0; i < 16; i++) { q.push_back(game.calc_invader_payoff(ActionRule::MakeDeterministicRule(i), p[3], p[4])); }
+    return q;
+}
+
+std::vector<D5> DualQuantities(const Norm& norm, const std::array<double, 5>& p) {
+    std::array<D5, 5> x;
+    for (int k = 0; k < 5; k++) { x[k] = D5::Variable(p[k], k); }
+    BasicGame<D5> game(x[0], x[1], x[2], norm);
+    std::vector<D5> q = {game.equilibrium_state, game.resident_coop, game.calc_delta_v(x[3], x[4]),
+                         game.calc_resident_payoff(x[3], x[4])};
+    for (int i = 0; i < 16; i++) { q.push_back(game.calc_invader_payoff(ActionRule::MakeDeterministicRule(i), x[3], x[4])); }
+    return q;
+}
+
+int main() {
+
+    // 1. Arithmetic
+    {
+        using D2 = Dual<2>;
+        D2 x = D2::Variable(3.0, 0), y = D2::Variable(0.5, 1);
+        D2 f = (x * x + 2.0 * y) / (1.0 - y) - sqrt(x) * y;
+        // df/dx = 2x / (1 - y) - y / (2 sqrt x), df/dy = (2 (1 - y) + x^2 + 2y) / (1 - y)^2 - sqrt x
+        assert (std::abs(f.v - ((9.0 + 1.0) / 0.5 - std::sqrt(3.0) * 0.5)) < 1e-14);
+        assert (std::abs(f.d[0] - (6.0 / 0.5 - 0.5 / (2.0 * std::sqrt(3.0)))) < 1e-13);
+        assert (std::abs(f.d[1] - ((1.0 + 9.0 + 1.0) / 0.25 - std::sqrt(3.0))) < 1e-13);
+        assert (abs(-x).v == 3.0 && abs(-x).d[0] == 1.0);
+        assert (x > y && y < 1.0 && !(x == y));
+    }
+
+    // 2. Values are those of the double-precision game, derivatives match central differences
+    std::vector<Norm> norms = {Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(),
+                               Norm::L5(), Norm::L6(), Norm::L7(), Norm::L8()};
+    for (int id = 0; id < 4096; id += 37) { norms.push_back(Norm::ConstructFromID(id)); }
+    for (const auto& norm : norms) {
+        for (const auto& p : std::vector<std::array<double, 5>>{{0.01, 0.02, 0.03, 1.0, 0.2},
+                                                                {0.1, 0.05, 0.0, 2.0, 1.0},
+                                                                {0.2, 0.2, 0.2, 1.5, 0.5}}) {
+            auto exact = Quantities(norm, p);
+            auto dual = DualQuantities(norm, p);
+            for (size_t n = 0; n < exact.size(); n++) { assert (dual[n].v == exact[n]); }
+            for (int k = 0; k < 5; k++) {
+                // fourth-order differences with a step large enough for the quadratic root,
+                // which cancels badly when c2 is small
+                const double step = 1e-4;
+                std::vector<std::vector<double>> q;
+                for (int j : {-2, -1, 1, 2}) {
+                    auto x = p;
+                    x[k] += j * step;
+                    q.push_back(Quantities(norm, x));
+                }
+                for (size_t n = 0; n < exact.size(); n++) {
+                    double fd = (8.0 * (q[2][n] - q[1][n]) - (q[3][n] - q[0][n])) / (12.0 * step);
+                    assert (std::abs(fd - dual[n].d[k]) < 1e-6 * (1.0 + std::abs(fd)));
+                }
+            }
+        }
+    }
+
+    // 3. The ESS margin has the sign of isESS and the derivative of its active invader
+    for (const auto& norm : norms) {
+        for (double c : {0.1, 0.5, 0.9}) {
+            Game game(0.02, 0.02, 0.02, norm);
+            int best = -1;
+            double margin = game.calc_ess_margin(1.0, c, &best);
+            assert ((margin >= 0.0) == game.isESS(1.0, c));
+
+            BasicGame<Dual<1>> dual(Dual<1>::Variable(0.02, 0), 0.02, 0.02, norm);
+            int dual_best = -1;
+            Dual<1> dm = dual.calc_ess_margin(1.0, c, &dual_best);
+            assert (dual_best == best && dm.v == margin);
+            auto margin_of_best = [&](double e) {
+                Game g(e, 0.02, 0.02, norm);
+                return g.calc_resident_payoff(1.0, c) - g.calc_invader_payoff(ActionRule::MakeDeterministicRule(best), 1.0, c);
+            };
+            const double step = 1e-4;
+            double fd = (8.0 * (margin_of_best(0.02 + step) - margin_of_best(0.02 - step))
+                         - (margin_of_best(0.02 + 2.0 * step) - margin_of_best(0.02 - 2.0 * step))) / (12.0 * step);
+            assert (std::abs(dm.d[0] - fd) < 1e-6 * (1.0 + std::abs(fd)));
+        }
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <cassert>
+#include <random>
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "ErrorBatch.hpp"
+
+using namespace two_action;
+
+// Compares ErrorBatch with Game at the points (ae[i], pe[i], mu[i]): bit for bit, unless
+// the compiler may contract the two differently into fused multiply-adds.
+#ifdef __FMA__
+constexpr double Tolerance = 1e-12;
+#else
+constexpr double Tolerance = 0.0;
+#endif
+
+bool Near(double a, double b) { return a == b || std::abs(a - b) <= Tolerance; }
+
+void Check(const Norm& norm, double benefit, double cost, const std::vector<double>& ae,
+           const std::vector<double>& pe, const std::vector<double>& mu) {
+    const size_t n = ae.size();
+    std::vector<double> h(n), coop(n), margin(n);
+    std::vector<uint8_t> ess(n);
+    std::vector<int8_t> best(n);
+    ErrorBatch batch(norm, benefit, cost);
+    batch.Evaluate(n, ae.data(), pe.data(), mu.data(), h.data(), coop.data(), margin.data(), ess.data(), best.data());
+    for (size_t i = 0; i < n; i++) {
+        Game game(ae[i], pe[i], mu[i], norm);
+        int expected_best = -1;
+        double expected_margin = game.calc_ess_margin(benefit, cost, &expected_best);
+        assert (Near(h[i], game.equilibrium_state));
+        assert (Near(coop[i], game.resident_coop));
+        assert (Near(margin[i], expected_margin));
+        if (std::abs(expected_margin) > Tolerance) { assert (ess[i] == game.isESS(benefit, cost)); }
+        if (Tolerance == 0.0) { assert (best[i] == expected_best); }
+    }
+
+    // the parallel version and a call without the optional outputs give the same values
+    std::vector<double> h2(n), coop2(n), margin2(n);
+    batch.EvaluateParallel(n, ae.data(), pe.data(), mu.data(), h2.data(), coop2.data(), margin2.data(), nullptr,
+                           nullptr, 3);
+    assert (h2 == h && coop2 == coop && margin2 == margin);
+}
+
+int main() {
+
+    // 1. the leading eight on a grid of error triples, zero errors included
+    {
+        std::vector<double> ae, pe, mu;
+        for (int i = 0; i <= 10; i++) {
+            for (int j = 0; j <= 10; j++) {
+                for (int k = 0; k <= 10; k++) {
+                    ae.push_back(0.01 * i);
+                    pe.push_back(0.01 * j);
+                    mu.push_back(0.01 * k);
+                }
+            }
+        }
+        for (const auto& norm : {Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(),
+                                 Norm::L5(), Norm::L6(), Norm::L7(), Norm::L8()}) {
+            Check(norm, 1.0, 0.8, ae, pe, mu);
+            Check(norm, 1.0, 0.2, ae, pe, mu);
+        }
+    }
+
+    // 2. random deterministic and stochastic norms at random errors; block sizes that are
+    //    not multiples of BlockSize
+    {
+        std::mt19937_64 rng(7);
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        for (int t = 0; t < 200; t++) {
+            const size_t n = 1 + rng() % 600;
+            std::vector<double> ae(n), pe(n), mu(n);
+            for (size_t i = 0; i < n; i++) {
+                ae[i] = 0.3 * u(rng);
+                pe[i] = 0.3 * u(rng);
+                mu[i] = 0.3 * u(rng);
+            }
+            Norm norm = Norm::ConstructFromID(static_cast<int>(rng() % 4096));
+            if (t % 2) {
+                std::array<double, 8> g;
+                std::array<double, 4> p;
+                for (auto& x : g) { x = u(rng); }
+                for (auto& x : p) { x = u(rng); }
+                norm = Norm(AssessmentRule(g), ActionRule(p));
+            }
+            Check(norm, 1.0 + 4.0 * u(rng), u(rng), ae, pe, mu);
+        }
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
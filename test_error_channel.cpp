@@ -0,0 +1,182 @@
+#include <iostream>
+#include <cassert>
+#include <random>
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "NormsWithPunishment.hpp"
+#include "GameWithPunishment.hpp"
+#include "ErrorChannel.hpp"
+
+bool Close(double a, double b, double tol = 1e-12) { return std::abs(a - b) <= tol * (1.0 + std::abs(b)); }
+
+// The channel's assessment map against the errors applied one after another: perception
+// of the performed action, then the image of the norm, then the assignment error.
+template <int NA>
+void CheckAssessment(const ErrorChannel<NA>& channel, const std::array<double, 4 * NA>& r) {
+    auto out = channel.Assessment(r);
+    for (int k = 0; k < 4; k++) {
+        for (int a = 0; a < NA; a++) {
+            double good = 0.0;
+            for (int b = 0; b < NA; b++) { good += channel.perception[a][b] * r[k * NA + b]; }
+            double expected = good * channel.assignment[1][1] + (1.0 - good) * channel.assignment[0][1];
+            assert (Close(out[k * NA + a], expected));
+        }
+    }
+}
+
+template <int NA>
+typename ErrorChannel<NA>::Matrix RandomStochastic(std::mt19937& rng) {
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    typename ErrorChannel<NA>::Matrix m;
+    for (auto& row : m) {
+        double sum = 0.0;
+        for (auto& x : row) { sum += x = u(rng); }
+        for (auto& x : row) { x /= sum; }
+    }
+    return m;
+}
+
+int main() {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> u(0.0, 1.0), small(0.0, 0.1);
+
+    // 1. The standard channel reproduces the rescaling of Norms.hpp and the action tables of Game
+    for (int t = 0; t < 200; t++) {
+        const double ae = small(rng), pe = small(rng), mu = small(rng);
+        const two_action::Norm norm = two_action::Norm::ConstructFromID(static_cast<int>(rng() % 4096));
+        auto channel = ErrorChannel<2>::Standard(ae, pe, mu);
+        auto r = channel.Assessment(norm.assessment_rule.good_probs);
+        auto expected = norm.assessment_rule.RescaleWithError(ae, pe).good_probs;
+        for (int i = 0; i < 8; i++) { assert (Close(r[i], expected[i], 1e-15)); }
+        auto s = channel.Actions(two_action::Game::ToTable(norm.action_rule));
+        auto s_expected = two_action::Game::ToTable(norm.action_rule, mu);
+        for (int k = 0; k < 4; k++) { assert (s[k] == s_expected[k]); }
+        CheckAssessment(channel, norm.assessment_rule.good_probs);
+    }
+
+    // 2. Games under the standard channel agree with the games of the three rates
+    for (int t = 0; t < 300; t++) {
+        const double ae = small(rng), pe = small(rng), mu = small(rng), c = 0.1 + 0.8 * u(rng);
+        const two_action::Norm norm = two_action::Norm::ConstructFromID(static_cast<int>(rng() % 4096));
+        two_action::Game game(ae, pe, mu, norm);
+        two_action::Game channel_game(ErrorChannel<2>::Standard(ae, pe, mu), norm);
+        assert (channel_game.mu_e == mu && channel_game.perception_error == pe && channel_game.assessment_error == ae);
+        assert (Close(channel_game.equilibrium_state, game.equilibrium_state));
+        assert (Close(channel_game.resident_coop, game.resident_coop));
+        assert (Close(channel_game.calc_delta_v(1.0, c), game.calc_delta_v(1.0, c), 1e-9));
+        assert (Close(channel_game.calc_delta_v2(1.0, c), game.calc_delta_v2(1.0, c), 1e-9));
+        double margin = game.calc_ess_margin(1.0, c), channel_margin = channel_game.calc_ess_margin(1.0, c);
+        assert (Close(channel_margin, margin));
+        if (std::abs(margin) > 1e-9) { assert (channel_game.isESS(1.0, c) == game.isESS(1.0, c)); }
+    }
+
+    // 3. General two-action channels: defections that turn into cooperation, and the
+    //    derivation of Delta_v with implementation errors moved into the assessment
+    for (int t = 0; t < 200; t++) {
+        const double slip = 0.1 * u(rng), lapse = 0.1 * u(rng);
+        ErrorChannel<2> channel({{{1.0 - slip, slip}, {lapse, 1.0 - lapse}}}, RandomStochastic<2>(rng),
+                                {{{0.95, 0.05}, {0.02, 0.98}}});
+        const two_action::Norm norm = two_action::Norm::ConstructFromID(static_cast<int>(rng() % 4096));
+        CheckAssessment(channel, norm.assessment_rule.good_probs);
+        two_action::Game game(channel, norm);
+        for (int k = 0; k < 4; k++) {
+            const double p = norm.action_rule.coop_probs[k];
+            const double coop = p * channel.implementation[1][1] + (1.0 - p) * channel.implementation[0][1];
+            assert (Close(game.engine.S[k][1], coop));
+            assert (Close(game.engine.S[k][0] + game.engine.S[k][1], 1.0));
+        }
+        assert (Close(game.calc_delta_v2(1.0, 0.3), game.calc_delta_v(1.0, 0.3), 1e-9));
+    }
+
+    // 4. Many tables in one pass, as one table at a time
+    {
+        ErrorChannel<2> channel(RandomStochastic<2>(rng), RandomStochastic<2>(rng), {{{0.9, 0.1}, {0.2, 0.8}}});
+        std::vector<double> tables(256 * 8), out(256 * 8);
+        for (int id = 0; id < 256; id++) {
+            auto r = two_action::AssessmentRule::MakeDeterministicRule(id).good_probs;
+            std::copy(r.begin(), r.end(), tables.begin() + id * 8);
+        }
+        channel.Assessments(256, tables.data(), out.data());
+        for (int id = 0; id < 256; id++) {
+            auto r = channel.Assessment(two_action::AssessmentRule::MakeDeterministicRule(id).good_probs);
+            for (int i = 0; i < 8; i++) { assert (out[id * 8 + i] == r[i]); }
+        }
+    }
+
+    // 5. Punishment model: the standard channel, then punishment mistaken for defection
+    for (int t = 0; t < 200; t++) {
+        const double ae = small(rng), pe = small(rng);
+        const int id = static_cast<int>((rng() % 4096) << 7 | (rng() % 81));
+        const with_punishment::Norm norm = with_punishment::Norm::ConstructFromID(id);
+        with_punishment::Game game(ae, pe, norm);
+        with_punishment::Game channel_game(ErrorChannel<3>::Standard(ae, pe), norm);
+        assert (Close(channel_game.equilibrium_state, game.equilibrium_state));
+        assert (Close(channel_game.resident_punishment, game.resident_punishment));
+        assert (Close(channel_game.calc_delta_v(1.0, 0.2, 0.5, 0.1), game.calc_delta_v(1.0, 0.2, 0.5, 0.1), 1e-9));
+
+        auto perception = ErrorChannel<3>::Standard(ae, pe).perception;
+        perception[2] = {0.1, 0.0, 0.9};
+        ErrorChannel<3> confused(ErrorChannel<3>::Identity(), perception, {{{1.0 - ae, ae}, {ae, 1.0 - ae}}});
+        CheckAssessment(confused, norm.assessment_rule.good_probs);
+        with_punishment::Game confused_game(confused, norm);
+        assert (confused_game.equilibrium_state >= 0.0 && confused_game.equilibrium_state <= 1.0);
+    }
+
+    // 6. Implementation errors in the punishment model: punishment sometimes comes out as
+    //    defection; the invader tables of isESS carry the same errors, isESS agrees with
+    //    the payoffs of every invader, and isESS2 with isESS
+    {
+        auto implementation = ErrorChannel<3>::Identity();
+        implementation[2] = {0.2, 0.0, 0.8};
+        ErrorChannel<3> channel(implementation, ErrorChannel<3>::Identity(), {{{1.0, 0.0}, {0.0, 1.0}}});
+        with_punishment::Norm norm = with_punishment::Norm::ConstructFromID(0x7F0 << 7 | 42);
+        with_punishment::Game game(channel, norm);
+        double total = game.resident_coop + game.resident_punishment + game.engine.resident_actions[0];
+        assert (Close(total, 1.0));
+        auto table = game.Performed(with_punishment::ActionRule::MakeDeterministicRule(80));   // always P
+        for (const auto& row : table) { assert (Close(row[0], 0.2) && Close(row[2], 0.8) && row[1] == 0.0); }
+
+        implementation[1] = {0.05, 0.95, 0.0};
+        auto perception = ErrorChannel<3>::Identity();
+        perception[0] = {0.98, 0.02, 0.0};
+        ErrorChannel<3> noisy(implementation, perception, {{{0.99, 0.01}, {0.01, 0.99}}});
+        const double b = 1.0, c = 0.1, p = 0.7, pc = 0.3;
+        int num_ess = 0;
+        for (int i = 0; i < 4096; i += 37) {
+            for (int j = 0; j < 81; j++) {
+                with_punishment::Norm resident{with_punishment::AssessmentRule::MakeDeterministicRule(i),
+                                               with_punishment::ActionRule::MakeDeterministicRule(j)};
+                with_punishment::Game g(noisy, resident);
+                const double self_payoff = (b - c) * g.resident_coop - (p + pc) * g.resident_punishment;
+                bool stable = true;
+                for (int k = 0; k < 81 && stable; k++) {
+                    if (k == j) { continue; }
+                    auto [H, coop_mut_to_res, coop_res_to_mut, pun_mut_to_res, pun_res_to_mut]
+                        = g.calc_invader_stats(with_punishment::ActionRule::MakeDeterministicRule(k));
+                    stable = b * coop_res_to_mut - p * pun_res_to_mut - c * coop_mut_to_res - pc * pun_mut_to_res <= self_payoff;
+                }
+                assert (g.isESS(b, c, p, pc) == stable);
+                assert (g.isESS2(b, c, p, pc) == stable);
+                num_ess += stable;
+            }
+        }
+        assert (num_ess > 0);
+    }
+
+    // 7. Matrices that are not stochastic are rejected
+    {
+        bool threw = false;
+        try {
+            ErrorChannel<2>({{{1.0, 0.0}, {0.5, 0.6}}}, ErrorChannel<2>::Identity(), {{{1.0, 0.0}, {0.0, 1.0}}});
+        } catch (const std::runtime_error&) { threw = true; }
+        assert (threw);
+        threw = false;
+        try {
+            ErrorChannel<2>(ErrorChannel<2>::Identity(), ErrorChannel<2>::Identity(), {{{1.1, -0.1}, {0.0, 1.0}}});
+        } catch (const std::runtime_error&) { threw = true; }
+        assert (threw);
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "ESSBitmap.hpp"
+#include <set>
+#include <random>
+
+using namespace two_action;
+
+int main() {
+
+    // 1. Add, Contains and Cardinality across array and bitset containers
+    RoaringBitmap a, b;
+    std::set<uint32_t> sa, sb;
+    std::mt19937 rng(1);
+    for (int i = 0; i < 20000; i++) {
+        uint32_t x = rng() % (1 << 19);
+        a.Add(x);
+        sa.insert(x);
+    }
+    for (int i = 0; i < 3000; i++) {
+        uint32_t x = rng() % (1 << 19);
+        b.Add(x);
+        sb.insert(x);
+    }
+    for (uint32_t dense = 0; dense < 5000; dense++) {   // forces a bitset container
+        b.Add(dense);
+        sb.insert(dense);
+    }
+    assert (a.Cardinality() == sa.size());
+    assert (b.Cardinality() == sb.size());
+    for (uint32_t x : sa) { assert (a.Contains(x)); }
+    assert (std::vector<uint32_t>(sb.begin(), sb.end()) == b.ToVector());
+
+    // 2. Set operations agree with std::set
+    std::vector<uint32_t> expected;
+    std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(), std::back_inserter(expected));
+    assert (RoaringBitmap::And(a, b).ToVector() == expected);
+    expected.clear();
+    std::set_union(sa.begin(), sa.end(), sb.begin(), sb.end(), std::back_inserter(expected));
+    assert (RoaringBitmap::Or(a, b).ToVector() == expected);
+    expected.clear();
+    std::set_difference(sa.begin(), sa.end(), sb.begin(), sb.end(), std::back_inserter(expected));
+    assert (RoaringBitmap::AndNot(a, b).ToVector() == expected);
+
+    // 3. Store round trip and region queries
+    ESSBitmapStore store(2);
+    for (double e : {0.0, 0.01, 0.02}) {
+        ESSBitmapStore::Entry entry{{e, 0.0, 0.0, 1.0, 0.2}, RoaringBitmap()};
+        for (int id = 0; id < 4096; id++) {
+            Game sim(e, 0.0, 0.0, Norm::ConstructFromID(id));
+            if (sim.isESS(1.0, 0.2)) { entry.ess.Add(id); }
+        }
+        store.entries.push_back(entry);
+    }
+    std::string file = "test_ess_bitmap.bin";
+    store.Save(file);
+    ESSBitmapStore loaded = ESSBitmapStore::Load(file);
+    std::remove(file.c_str());
+    assert (loaded.entries.size() == 3);
+    for (size_t i = 0; i < 3; i++) { assert (loaded.entries[i].ess == store.entries[i].ess); }
+
+    auto with_errors = [](const ESSBitmapStore::GridPoint& x) { return x.assessment_error > 0.0; };
+    RoaringBitmap always = loaded.IntersectRegion(with_errors);
+    RoaringBitmap sometimes = loaded.UnionRegion(with_errors);
+    assert (always == RoaringBitmap::And(store.entries[1].ess, store.entries[2].ess));
+    assert (always.Cardinality() <= sometimes.Cardinality());
+
+    // the leading eight remain ESS at both error rates
+    for (const Norm& norm : {Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(), Norm::L5(), Norm::L6(), Norm::L7(), Norm::L8()}) {
+        assert (always.Contains(norm.ID()));
+    }
+
+    return 0;
+}
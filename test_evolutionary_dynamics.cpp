@@ -0,0 +1,79 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "PolymorphicGame.hpp"
+#include "EvolutionaryDynamics.hpp"
+
+using namespace two_action;
+
+int main() {
+
+    double benefit = 1.0, cost = 0.2;
+
+    // 1. Monomorphic populations reproduce Game, including the rare-invader statistics
+    std::vector<Norm> l8_norms = {Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(),
+                                  Norm::L5(), Norm::L6(), Norm::L7(), Norm::L8()};
+    for (const auto& norm : l8_norms) {
+        Game game(0.02, 0.01, 0.03, norm);
+        auto poly = PolymorphicGame::AllActionRules(0.02, 0.01, 0.03, norm.assessment_rule);
+        int resident = norm.action_rule.ID();
+        std::vector<double> x(16, 0.0);
+        x[resident] = 1.0;
+        double g = poly.calc_equilibrium_state(x);
+        assert (std::abs(g - game.equilibrium_state) < 1e-12);
+        auto h = poly.calc_images(g);
+        auto pi = poly.calc_payoffs(x, h, benefit, cost);
+        assert (std::abs(pi[resident] - (benefit - cost) * game.resident_coop) < 1e-12);
+        auto coop = poly.calc_coop_matrix(h);
+        for (int i = 0; i < 16; i++) {
+            auto [H, coop_mut_to_res, coop_res_to_mut] = game.calc_invader_stats(ActionRule::MakeDeterministicRule(i));
+            assert (std::abs(h[i] - H) < 1e-12);
+            assert (std::abs(coop[i * 16 + resident] - coop_mut_to_res) < 1e-12);
+            assert (std::abs(coop[resident * 16 + i] - coop_res_to_mut) < 1e-12);
+            assert (std::abs(pi[i] - (benefit * coop_res_to_mut - cost * coop_mut_to_res)) < 1e-12);
+        }
+    }
+
+    // 2. ALLC against ALLD when everyone is always judged good: the share of ALLC follows
+    //    the logistic decay x' = -r x (1 - x), with r = c (replicator) or tanh(s c / 2) (Fermi)
+    {
+        PolymorphicGame poly(0.0, 0.0, 0.0, AssessmentRule::AllGood(), {ActionRule::ALLC(), ActionRule::ALLD()});
+        double x0 = 0.9, t = 10.0;
+        for (auto [dynamics, rate] : {std::make_pair(Dynamics::Replicator, cost),
+                                      std::make_pair(Dynamics::PairwiseComparison, std::tanh(2.0 * cost / 2.0))}) {
+            EvolutionaryDynamics evo(poly, benefit, cost, dynamics, 2.0);
+            auto tr = evo.Integrate({x0, 1.0 - x0}, t, 1e-10, 1e-12);
+            double expected = x0 * std::exp(-rate * t) / (1.0 - x0 + x0 * std::exp(-rate * t));
+            assert (std::abs(tr.x[0] - expected) < 1e-7);
+            assert (std::abs(tr.x[0] + tr.x[1] - 1.0) < 1e-14);
+            assert (std::abs(tr.t - t) < 1e-12 && !tr.converged);
+        }
+    }
+
+    // 3. Basins of attraction over the 16 action rules under the L3 assessment rule
+    {
+        auto poly = PolymorphicGame::AllActionRules(0.01, 0.0, 0.01, Norm::L3().assessment_rule);
+        EvolutionaryDynamics evo(poly, benefit, cost);
+        auto basins = evo.SampleBasins(12, 2000.0, 1e-3, 7, 3);
+        long total = 0;
+        for (long n : basins.counts) { total += n; }
+        assert (total == 12);
+        for (size_t n = 0; n < 12; n++) {
+            double sum = 0.0;
+            for (double xi : basins.endpoints[n]) { assert (xi >= 0.0); sum += xi; }
+            assert (std::abs(sum - 1.0) < 1e-12);
+        }
+        // same initial conditions whatever the number of threads
+        auto again = evo.SampleBasins(12, 2000.0, 1e-3, 7, 1);
+        assert (again.outcome == basins.outcome);
+        // a vertex that attracts samples is a Nash equilibrium: no rare action rule earns more
+        for (size_t i = 0; i < 16; i++) {
+            if (basins.counts[i] == 0) { continue; }
+            std::vector<double> x(16, 0.0);
+            x[i] = 1.0;
+            auto pi = poly.calc_payoffs(x, benefit, cost);
+            for (size_t j = 0; j < 16; j++) { assert (pi[j] <= pi[i] + 1e-9); }
+        }
+    }
+
+    return 0;
+}
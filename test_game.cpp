@@ -1,6 +1,8 @@
 #include "Norms.hpp"
 #include "Game.hpp"
 
+using namespace two_action;
+
 int main() {
 
     // 1. Leading Eight Self Cooperation Rate
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <cassert>
+#include "Game.hpp"
+#include "GameWithPunishment.hpp"
+#include "GameEngine.hpp"
+
+// Both models are included, so their classes are named through the namespaces.
+
+// Three-action norm that never punishes and judges D and C as the two-action norm does.
+with_punishment::Norm EmbedNorm(const two_action::Norm& norm) {
+    std::array<double, 12> good{};
+    std::array<with_punishment::Action, 4> actions;
+    for (int k = 0; k < 4; k++) {
+        good[k * 3 + 0] = norm.assessment_rule.good_probs[k * 2 + 0];
+        good[k * 3 + 1] = norm.assessment_rule.good_probs[k * 2 + 1];
+        good[k * 3 + 2] = 0.0;
+        actions[k] = norm.action_rule.coop_probs[k] > 0.5 ? with_punishment::Action::C : with_punishment::Action::D;
+    }
+    return with_punishment::Norm(with_punishment::AssessmentRule(good), with_punishment::ActionRule(actions));
+}
+
+int main() {
+
+    // 1. Without implementation errors the two models agree on norms that never punish
+    for (int id = 0; id < 4096; id += 7) {
+        auto norm = two_action::Norm::ConstructFromID(id);
+        two_action::Game g2(0.02, 0.03, 0.0, norm);
+        with_punishment::Game g3(0.02, 0.03, EmbedNorm(norm));
+        assert (std::abs(g2.equilibrium_state - g3.equilibrium_state) < 1e-12);
+        assert (std::abs(g2.resident_coop - g3.resident_coop) < 1e-12);
+        assert (g3.resident_punishment == 0.0);
+        for (int i = 0; i < 16; i++) {
+            auto inv2 = two_action::ActionRule::MakeDeterministicRule(i);
+            auto inv3 = EmbedNorm(two_action::Norm(norm.assessment_rule, inv2)).action_rule;
+            auto [H2, mr2, rm2] = g2.calc_invader_stats(inv2);
+            auto [H3, mr3, rm3, pmr3, prm3] = g3.calc_invader_stats(inv3);
+            assert (std::abs(H2 - H3) < 1e-12);
+            assert (std::abs(mr2 - mr3) < 1e-12);
+            assert (std::abs(rm2 - rm3) < 1e-12);
+            assert (pmr3 == 0.0 && prm3 == 0.0);
+        }
+    }
+
+    // 2. The engine of a Game gives the same ESS verdict and invader payoffs as the wrapper
+    for (int id = 0; id < 4096; id += 3) {
+        two_action::Game game(0.01, 0.01, 0.01, two_action::Norm::ConstructFromID(id));
+        using Engine = two_action::Game::Engine;
+        Engine engine(game.r_norm.assessment_rule.good_probs, two_action::Game::ToTable(game.r_norm.action_rule));
+        assert (engine.h == game.equilibrium_state);
+        std::vector<Engine::ActionTable> invaders;
+        for (int i = 0; i < 16; i++) {
+            auto rule = two_action::ActionRule::MakeDeterministicRule(i).RescaleWithError(0.01);
+            invaders.push_back(two_action::Game::ToTable(rule));
+            auto [H, mr, rm] = game.calc_invader_stats(two_action::ActionRule::MakeDeterministicRule(i));
+            double payoff = Engine::InvaderPayoff(engine.Invader(invaders.back()), {0.0, 1.0}, {0.0, 0.2});
+            assert (payoff == 1.0 * rm - 0.2 * mr);
+            assert (engine.Invader(invaders.back()).H == H);
+        }
+        assert (engine.IsESS(invaders, id & 15, {0.0, 1.0}, {0.0, 0.2}) == game.isESS(1.0, 0.2));
+    }
+
+    // 3. A model with a fourth action: "reward" (3) is judged like cooperation and gives
+    // the same benefit at the same cost, so a rule that rewards instead of cooperating
+    // is indistinguishable from the cooperating one.
+    {
+        using Engine4 = GameEngine<4>;
+        using Engine2 = GameEngine<2>;
+        auto norm = two_action::Norm::L3().RescaleWithError(0.02, 0.02, 0.01);
+        Engine4::AssessmentTable R4{};
+        for (int k = 0; k < 4; k++) {
+            R4[k * 4 + 0] = norm.assessment_rule.good_probs[k * 2 + 0];
+            R4[k * 4 + 1] = norm.assessment_rule.good_probs[k * 2 + 1];
+            R4[k * 4 + 2] = 0.0;
+            R4[k * 4 + 3] = norm.assessment_rule.good_probs[k * 2 + 1];
+        }
+        auto S2 = two_action::Game::ToTable(norm.action_rule);
+        Engine4::ActionTable S4{}, S4_reward{};
+        for (int k = 0; k < 4; k++) {
+            S4[k] = {S2[k][0], S2[k][1], 0.0, 0.0};
+            S4_reward[k] = {S2[k][0], 0.0, 0.0, S2[k][1]};
+        }
+        Engine2 e2(norm.assessment_rule.good_probs, S2);
+        Engine4 e4(R4, S4), e4_reward(R4, S4_reward);
+        assert (std::abs(e2.h - e4.h) < 1e-15);
+        assert (std::abs(e4.h - e4_reward.h) < 1e-15);
+        assert (std::abs(e4_reward.resident_actions[3] - e2.resident_actions[1]) < 1e-15);
+
+        Engine4::ActionVector benefit = {0.0, 1.0, -0.5, 1.0}, cost = {0.0, 0.2, 0.1, 0.2};
+        assert (std::abs(e4.ResidentPayoff(benefit, cost) - e4_reward.ResidentPayoff(benefit, cost)) < 1e-15);
+        std::vector<Engine4::ActionTable> two_action_invaders;
+        for (int i = 0; i < 256; i++) {   // every deterministic four-action rule
+            Engine4::ActionTable rule{};
+            bool uses_two_actions = true;
+            for (int k = 0, id = i; k < 4; k++, id /= 4) {
+                rule[k][id % 4] = 1.0;
+                uses_two_actions = uses_two_actions && id % 4 < 2;
+            }
+            auto a = e4.Invader(rule), b = e4_reward.Invader(rule);
+            assert (std::abs(a.H - b.H) < 1e-15);
+            assert (std::abs(Engine4::InvaderPayoff(a, benefit, cost) - Engine4::InvaderPayoff(b, benefit, cost)) < 1e-15);
+            if (uses_two_actions) {
+                for (auto& row : rule) { row = {row[0] + 0.01 * row[1], 0.99 * row[1], 0.0, 0.0}; }
+                two_action_invaders.push_back(rule);
+            }
+        }
+        // Restricted to D and C the four-action model gives the two-action verdict
+        for (double c : {0.1, 0.5, 0.9, 1.1}) {
+            bool verdict = e4.IsESS(two_action_invaders, two_action::Norm::L3().action_rule.ID(), benefit, {0.0, c, 0.1, c});
+            assert (verdict == two_action::Game(0.02, 0.02, 0.01, two_action::Norm::L3()).isESS(1.0, c));
+        }
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
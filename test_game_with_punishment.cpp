@@ -1,6 +1,8 @@
 #include "NormsWithPunishment.hpp"
 #include "GameWithPunishment.hpp"
 
+using namespace with_punishment;
+
 int main() {
     constexpr Reputation B = Reputation::B, G = Reputation::G;
     constexpr Action C = Action::C, D = Action::D, P = Action::P;
@@ -0,0 +1,162 @@
+#include <iostream>
+#include <cassert>
+#include <random>
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "HeterogeneousGame.hpp"
+
+using namespace two_action;
+
+bool Close(double a, double b, double tol = 1e-12) { return std::abs(a - b) <= tol * (1.0 + std::abs(b)); }
+
+double Moment(const ErrorMarginal& m, int k) {
+    double sum = 0.0;
+    for (size_t i = 0; i < m.nodes.size(); i++) { sum += m.weights[i] * std::pow(m.nodes[i], k); }
+    return sum;
+}
+
+// Invader payoffs from GameEngine, one engine per donor node with its image set to g,
+// and the equilibrium by bisection.
+std::array<double, 16> ReferencePayoffs(const HeterogeneousGame& game, double benefit, double cost, double& g) {
+    const auto& dist = game.errors;
+    const size_t n = dist.mu_e.size();
+    std::vector<GameEngine<2>> engines;
+    for (size_t i = 0; i < n; i++) { engines.emplace_back(game.R, Game::ToTable(game.norm.action_rule, dist.mu_e[i])); }
+    auto images = [&](double x) {
+        std::vector<double> h(n);
+        for (size_t i = 0; i < n; i++) {
+            engines[i].h = x;
+            h[i] = engines[i].MutantState(engines[i].S);
+        }
+        return h;
+    };
+    double lo = 0.0, hi = 1.0;
+    for (int it = 0; it < 200; it++) {
+        double mid = 0.5 * (lo + hi), f = -mid;
+        auto h = images(mid);
+        for (size_t i = 0; i < n; i++) { f += dist.donor_weight[i] * h[i]; }
+        if (f > 0.0) { lo = mid; } else { hi = mid; }
+    }
+    g = 0.5 * (lo + hi);
+    auto h = images(g);
+    std::array<double, 16> payoffs{};
+    for (int j = 0; j < 16; j++) {
+        for (size_t i = 0; i < n; i++) {
+            auto st = engines[i].Invader(Game::ToTable(ActionRule::MakeDeterministicRule(j), dist.mu_e[i]));
+            double res_to_mut = 0.0;
+            for (size_t d = 0; d < n; d++) {
+                const auto& S = engines[d].S;
+                res_to_mut += dist.donor_weight[d] * (h[d] * st.H * S[3][1] + h[d] * (1.0 - st.H) * S[2][1]
+                                                      + (1.0 - h[d]) * st.H * S[1][1] + (1.0 - h[d]) * (1.0 - st.H) * S[0][1]);
+            }
+            payoffs[j] += dist.donor_weight[i] * (benefit * res_to_mut - cost * st.mut_to_res[1]);
+        }
+    }
+    return payoffs;
+}
+
+int main() {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> u(0.0, 1.0), small(0.0, 0.1);
+    std::vector<Norm> l8_norms = {Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(),
+                                  Norm::L5(), Norm::L6(), Norm::L7(), Norm::L8()};
+
+    // 1. Gauss rules: the 3-point Legendre rule, and exact Beta moments up to degree 2n - 1
+    {
+        auto m = ErrorMarginal::Uniform(0.0, 1.0, 3);
+        assert (Close(m.nodes[0], 0.5 - 0.5 * std::sqrt(0.6)) && Close(m.nodes[1], 0.5) && Close(m.nodes[2], 0.5 + 0.5 * std::sqrt(0.6)));
+        assert (Close(m.weights[0], 5.0 / 18.0) && Close(m.weights[1], 8.0 / 18.0) && Close(m.weights[2], 5.0 / 18.0));
+        for (double mean : {0.02, 0.1, 0.5}) {
+            for (double concentration : {2.0, 10.0, 100.0}) {
+                for (int n : {1, 2, 5, 8}) {
+                    auto beta = ErrorMarginal::Beta(mean, concentration, n);
+                    const double a = mean * concentration, b = (1.0 - mean) * concentration;
+                    double exact = 1.0;
+                    for (int k = 0; k < 2 * n; k++) {
+                        assert (Close(Moment(beta, k), exact, 1e-11));
+                        exact *= (a + k) / (a + b + k);
+                    }
+                }
+            }
+        }
+        auto density = ErrorMarginal::Density(0.0, 1.0, [](double x) { return x * (1.0 - x); }, 6);
+        assert (Close(density.Mean(), 0.5) && Close(Moment(density, 2), 0.3));
+        assert (ErrorMarginal::Beta(0.0, 5.0, 4).nodes.size() == 1);
+    }
+
+    // 2. A point distribution is the homogeneous game
+    for (int t = 0; t < 300; t++) {
+        const double ae = small(rng), pe = small(rng), mu = small(rng), c = 0.1 + 0.8 * u(rng);
+        Norm norm = (t < 8) ? l8_norms[t] : Norm::ConstructFromID(static_cast<int>(rng() % 4096));
+        if (t % 3 == 2) {
+            std::array<double, 8> good;
+            std::array<double, 4> coop;
+            for (auto& x : good) { x = u(rng); }
+            for (auto& x : coop) { x = u(rng); }
+            norm = Norm(AssessmentRule(good), ActionRule(coop));
+        }
+        Game game(ae, pe, mu, norm);
+        HeterogeneousGame het(ErrorDistribution::Point(ae, pe, mu), norm);
+        assert (Close(het.equilibrium_state, game.equilibrium_state, 1e-11));
+        assert (Close(het.resident_coop, game.resident_coop, 1e-11));
+        auto payoffs = het.calc_invader_payoffs(1.0, c);
+        for (int j = 0; j < 16; j++) {
+            assert (Close(payoffs[j], game.calc_invader_payoff(ActionRule::MakeDeterministicRule(j), 1.0, c), 1e-11));
+        }
+        int best = -1, het_best = -1;
+        const double margin = game.calc_ess_margin(1.0, c, &best), het_margin = het.calc_ess_margin(1.0, c, &het_best);
+        assert (Close(het_margin, margin, 1e-11));
+        if (std::abs(margin) > 1e-9) { assert (het.isESS(1.0, c) == game.isESS(1.0, c)); }
+    }
+
+    // 3. Independent spread in the observers' rates acts like their means
+    for (const auto& norm : l8_norms) {
+        auto ae = ErrorMarginal::Beta(0.03, 4.0, 6), pe = ErrorMarginal::Uniform(0.0, 0.08, 5);
+        HeterogeneousGame het(ErrorDistribution::Independent(ae, pe, ErrorMarginal::Point(0.02)), norm);
+        Game game(ae.Mean(), pe.Mean(), 0.02, norm);
+        assert (Close(het.equilibrium_state, game.equilibrium_state, 1e-11));
+        assert (Close(het.calc_ess_margin(1.0, 0.3), game.calc_ess_margin(1.0, 0.3), 1e-11));
+    }
+
+    // 4. Spread in mu_e against engines per node
+    for (int t = 0; t < 40; t++) {
+        const Norm norm = (t < 8) ? l8_norms[t] : Norm::ConstructFromID(static_cast<int>(rng() % 4096));
+        auto mu = ErrorMarginal::Beta(0.01 + small(rng), 2.0 + 20.0 * u(rng), 1 + t % 7);
+        HeterogeneousGame het(ErrorDistribution::Independent(ErrorMarginal::Point(small(rng)),
+                                                             ErrorMarginal::Point(small(rng)), mu), norm);
+        double g = 0.0;
+        auto expected = ReferencePayoffs(het, 1.0, 0.4, g);
+        assert (std::abs(het.equilibrium_state - g) < 1e-12);
+        auto payoffs = het.calc_invader_payoffs(1.0, 0.4);
+        for (int j = 0; j < 16; j++) { assert (std::abs(payoffs[j] - expected[j]) < 1e-11); }
+        double mean_image = 0.0;
+        for (size_t i = 0; i < het.images.size(); i++) { mean_image += het.errors.donor_weight[i] * het.images[i]; }
+        assert (Close(mean_image, het.equilibrium_state, 1e-12));
+    }
+
+    // 5. Quasi-Monte Carlo agrees with the Gauss rule; a spread in mu_e changes the game
+    for (const auto& norm : l8_norms) {
+        HeterogeneousGame gauss(ErrorDistribution::Independent(ErrorMarginal::Point(0.02), ErrorMarginal::Point(0.02),
+                                                               ErrorMarginal::Uniform(0.0, 0.2, 8)), norm);
+        HeterogeneousGame qmc(ErrorDistribution::Sampled(4096, [](const std::array<double, 3>& x) {
+            return std::array<double, 3>{0.02, 0.02, 0.2 * x[2]};
+        }), norm);
+        assert (std::abs(gauss.equilibrium_state - qmc.equilibrium_state) < 1e-5);
+        assert (std::abs(gauss.calc_ess_margin(1.0, 0.3) - qmc.calc_ess_margin(1.0, 0.3)) < 1e-5);
+        // the images of L3 - L8 are linear in mu_e, but the invaders' payoffs are not
+        Game mean(0.02, 0.02, 0.1, norm);
+        assert (std::abs(gauss.calc_ess_margin(1.0, 0.3) - mean.calc_ess_margin(1.0, 0.3)) > 1e-5);
+    }
+
+    // 6. Invalid distributions are rejected
+    for (auto dist : {ErrorDistribution{{0.5}, {0.1}, {0.1}, {1.0}, {0.1}},
+                      ErrorDistribution{{1.0}, {1.5}, {0.1}, {1.0}, {0.1}},
+                      ErrorDistribution{{1.0}, {0.1}, {0.1}, {1.0, 0.0}, {0.1}}}) {
+        bool threw = false;
+        try { HeterogeneousGame(dist, Norm::L1()); } catch (const std::runtime_error&) { threw = true; }
+        assert (threw);
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <cassert>
+#include <random>
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "IncrementalEvaluator.hpp"
+
+using namespace two_action;
+
+// Every norm of the evaluator against a Game built from scratch at the current inputs.
+void CheckAgainstGame(IncrementalEvaluator& eval, size_t stride = 1) {
+    const double b = eval.GetBenefit(), c = eval.GetCost();
+    for (size_t i = 0; i < eval.Size(); i += stride) {
+        const Norm& norm = eval.GetNorm(i);
+        Game game(eval.GetAssessmentError(), eval.GetPerceptionError(), eval.GetMuE(), norm);
+        assert (eval.EquilibriumState(i) == game.equilibrium_state);
+        assert (eval.ResidentCoop(i) == game.resident_coop);
+        int best = -1;
+        assert (eval.EssMargin(i) == game.calc_ess_margin(b, c, &best));
+        assert (eval.BestInvader(i) == best);
+        assert (eval.IsESS(i) == game.isESS(b, c));
+        for (int j = 0; j < 16; j++) {
+            if (j == norm.action_rule.ID()) { continue; }
+            assert (eval.InvaderPayoff(i, j) == game.calc_invader_payoff(ActionRule::MakeDeterministicRule(j), b, c));
+        }
+    }
+}
+
+int main() {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+
+    std::vector<Norm> norms;
+    for (int id = 0; id < 4096; id++) { norms.push_back(Norm::ConstructFromID(id)); }
+    for (int t = 0; t < 64; t++) {
+        std::array<double, 8> good;
+        std::array<double, 4> coop;
+        for (auto& x : good) { x = u(rng); }
+        for (auto& x : coop) { x = u(rng); }
+        norms.push_back(Norm(AssessmentRule(good), ActionRule(coop)));
+    }
+    const size_t n = norms.size();
+    IncrementalEvaluator eval(norms, 0.02, 0.02, 0.02, 1.0, 0.2);
+
+    // 1. The first update computes everything; after that nothing is stale
+    {
+        auto counts = eval.Update();
+        for (auto k : counts) { assert (k == n); }
+        CheckAgainstGame(eval);
+        counts = eval.Update();
+        for (auto k : counts) { assert (k == 0); }
+    }
+
+    // 2. Each input invalidates the nodes downstream of it, in every norm
+    {
+        using Counts = IncrementalEvaluator::Counts;
+        eval.SetBenefit(1.5);
+        assert ((eval.Update() == Counts{0, 0, 0, n}));
+        eval.SetCost(0.4);
+        assert ((eval.Update() == Counts{0, 0, 0, n}));
+        CheckAgainstGame(eval);
+        eval.SetMuE(0.05);
+        assert ((eval.Update() == Counts{0, n, n, n}));
+        CheckAgainstGame(eval, 7);
+        eval.SetAssessmentError(0.01);
+        assert ((eval.Update() == Counts{n, 0, n, n}));
+        eval.SetPerceptionError(0.03);
+        eval.SetBenefit(2.0);
+        assert ((eval.Update() == Counts{n, 0, n, n}));
+        CheckAgainstGame(eval, 5);
+        eval.SetCost(0.4);    // unchanged
+        assert ((eval.Update() == Counts{0, 0, 0, 0}));
+    }
+
+    // 3. Changing or adding a norm recomputes that norm only
+    {
+        using Counts = IncrementalEvaluator::Counts;
+        eval.SetNorm(3, Norm::L6());
+        assert ((eval.Update() == Counts{1, 1, 1, 1}));
+        size_t i = eval.AddNorm(Norm::L3());
+        assert (i == n && eval.Size() == n + 1);
+        assert ((eval.Update() == Counts{1, 1, 1, 1}));
+        Game l6(0.01, 0.03, 0.05, Norm::L6());
+        assert (eval.EssMargin(3) == l6.calc_ess_margin(2.0, 0.4));
+        CheckAgainstGame(eval, 11);
+    }
+
+    // 4. A random walk of one-input moves, results pulled without calling Update
+    for (int t = 0; t < 30; t++) {
+        switch (rng() % 5) {
+            case 0: eval.SetAssessmentError(0.1 * u(rng)); break;
+            case 1: eval.SetPerceptionError(0.1 * u(rng)); break;
+            case 2: eval.SetMuE(0.1 * u(rng)); break;
+            case 3: eval.SetBenefit(1.0 + u(rng)); break;
+            default: eval.SetCost(0.8 * u(rng)); break;
+        }
+        CheckAgainstGame(eval, 97);
+    }
+
+    // 5. The ESS norms of the leading eight, as in Game
+    {
+        IncrementalEvaluator l8({Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(),
+                                 Norm::L5(), Norm::L6(), Norm::L7(), Norm::L8()}, 0.02, 0.02, 0.02, 1.0, 0.2, 1);
+        for (double cost : {0.2, 0.6, 0.95}) {
+            l8.SetCost(cost);
+            std::vector<size_t> expected;
+            for (size_t i = 0; i < l8.Size(); i++) {
+                if (Game(0.02, 0.02, 0.02, l8.GetNorm(i)).isESS(1.0, cost)) { expected.push_back(i); }
+            }
+            assert (l8.ESSNorms() == expected);
+        }
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <cassert>
+#include <set>
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "QuasiRandom.hpp"
+#include "InvaderScan.hpp"
+
+using namespace two_action;
+
+int main() {
+
+    // 1. Sobol sequence: every block of 2^k points is stratified in each coordinate and
+    //    in the first two jointly, and Fill agrees with Point
+    {
+        SobolSequence sobol(4);
+        for (int k = 1; k <= 8; k++) {
+            const uint64_t n = uint64_t(1) << k;
+            std::vector<std::set<int>> cells(4);
+            std::set<int> joint;
+            for (uint64_t i = 0; i < n; i++) {
+                double x[4];
+                sobol.Point(n + i, x);
+                for (int j = 0; j < 4; j++) {
+                    assert (x[j] >= 0.0 && x[j] < 1.0);
+                    cells[j].insert(static_cast<int>(x[j] * n));
+                }
+                joint.insert(static_cast<int>(x[0] * (1 << (k / 2))) * (1 << k) + static_cast<int>(x[1] * (1 << (k - k / 2))));
+            }
+            for (int j = 0; j < 4; j++) { assert (cells[j].size() == n); }
+            assert (joint.size() == n);
+        }
+        std::vector<double> buffer(4 * 100);
+        double* out[4] = {&buffer[0], &buffer[100], &buffer[200], &buffer[300]};
+        sobol.Fill(37, 100, out);
+        for (int i = 0; i < 100; i++) {
+            double x[4];
+            sobol.Point(37 + i, x);
+            for (int j = 0; j < 4; j++) { assert (out[j][i] == x[j]); }
+        }
+        bool thrown = false;
+        try { SobolSequence(17); } catch (const std::runtime_error&) { thrown = true; }
+        assert (thrown);
+
+        // the sequence ends at 2^32 points
+        sobol.Fill(SobolSequence::MaxPoints - 100, 100, out);
+        double last[4];
+        sobol.Point(SobolSequence::MaxPoints - 1, last);
+        for (int j = 0; j < 4; j++) { assert (out[j][99] == last[j]); }
+        thrown = false;
+        try { sobol.Fill(SobolSequence::MaxPoints - 99, 100, out); } catch (const std::runtime_error&) { thrown = true; }
+        assert (thrown);
+    }
+
+    // 2. The batch kernel reproduces calc_invader_payoff for deterministic and mixed invaders
+    std::vector<Norm> norms = {Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(),
+                               Norm::L5(), Norm::L6(), Norm::L7(), Norm::L8()};
+    for (int id = 0; id < 4096; id += 53) { norms.push_back(Norm::ConstructFromID(id)); }
+    SobolSequence sobol(4);
+    for (const auto& norm : norms) {
+        Game game(0.02, 0.03, 0.01, norm);
+        InvaderScan scan(game, 1.0, 0.3);
+        for (uint64_t n = 0; n < 64; n++) {
+            double x[4];
+            sobol.Point(n, x);
+            ActionRule invader = (n < 16) ? ActionRule::MakeDeterministicRule(n) : ActionRule({x[0], x[1], x[2], x[3]});
+            double expected = game.calc_invader_payoff(invader, 1.0, 0.3) - game.calc_resident_payoff(1.0, 0.3);
+            assert (std::abs(scan.Advantage(invader) - expected) < 1e-14);
+        }
+    }
+
+    // 3. The corner grid decides isESS, and the scans agree across thread counts
+    for (const auto& norm : norms) {
+        for (double c : {0.1, 0.5, 0.9}) {
+            Game game(0.02, 0.02, 0.02, norm);
+            InvaderScan scan(game, 1.0, c);
+            auto corners = scan.ScanGrid(2, 2);
+            assert (corners.num_points == 16);
+            assert ((corners.max_advantage <= 1e-12) == game.isESS(1.0, c));
+            assert (std::abs(scan.Advantage(corners.argmax) - corners.max_advantage) < 1e-15);
+
+            auto grid = scan.ScanGrid(7, 1);
+            auto grid_threads = scan.ScanGrid(7, 3);
+            assert (grid.num_points == 7 * 7 * 7 * 7);
+            assert (grid.max_advantage >= corners.max_advantage);
+            assert (grid.max_advantage == grid_threads.max_advantage && grid.num_positive == grid_threads.num_positive);
+            assert (grid.argmax.coop_probs == grid_threads.argmax.coop_probs);
+
+            auto sobol_scan = scan.ScanSobol(1000, 1);
+            auto sobol_threads = scan.ScanSobol(1000, 4);
+            assert (sobol_scan.num_points == 1000);
+            assert (sobol_scan.max_advantage == sobol_threads.max_advantage);
+            assert (sobol_scan.num_positive == sobol_threads.num_positive);
+            assert (std::abs(scan.Advantage(sobol_scan.argmax) - sobol_scan.max_advantage) < 1e-15);
+        }
+    }
+    {
+        // an empty scan has no maximum
+        InvaderScan scan(Game(0.02, 0.02, 0.02, Norm::L3()), 1.0, 0.5);
+        bool thrown = false;
+        try { scan.ScanSobol(0); } catch (const std::runtime_error&) { thrown = true; }
+        assert (thrown);
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "InvasionGraph.hpp"
+
+using namespace two_action;
+
+int main() {
+
+    // 1. Components of a small graph
+    {
+        std::vector<int64_t> ids = {10, 11, 12, 13, 14, 15, 16};
+        InvasionGraph g = InvasionGraph::FromEdges(ids, {{0, 1}, {1, 2}, {2, 0}, {2, 3}, {3, 4}, {4, 3}, {6, 0}, {5, 5}});
+        auto component = g.StronglyConnectedComponents(2);
+        assert (component[0] == component[1] && component[1] == component[2]);
+        assert (component[3] == component[4]);
+        assert (component[0] != component[3]);
+        assert (component[5] != component[6] && component[5] != component[0] && component[6] != component[0]);
+
+        std::vector<uint64_t> sizes;
+        std::vector<uint8_t> absorbing;
+        g.SummarizeComponents(component, sizes, absorbing);
+        assert (sizes.size() == 4);
+        assert (sizes[component[0]] == 3 && sizes[component[3]] == 2);
+        assert (!absorbing[component[0]] && !absorbing[component[6]]);
+        assert (absorbing[component[3]] && absorbing[component[5]]);
+    }
+
+    // 2. Long chain and a big cycle exercise the iterative search
+    {
+        const uint32_t n = 200000;
+        std::vector<int64_t> ids(n);
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        for (uint32_t v = 0; v < n; v++) {
+            ids[v] = v;
+            edges.push_back({v, (v + 1) % n});
+        }
+        edges.push_back({5, 0});
+        auto component = InvasionGraph::FromEdges(ids, edges).StronglyConnectedComponents();
+        for (uint32_t v = 0; v < n; v++) { assert (component[v] == component[0]); }
+    }
+
+    // 3. Nodes without invaders are exactly the ESS norms
+    {
+        double assessment_error = 0.02, perception_error = 0.0, mu_e = 0.01, benefit = 1.0, cost = 0.3;
+        InvasionMatrixHeader header;
+        header.assessment_error = assessment_error;
+        header.perception_error = perception_error;
+        header.mu_e = mu_e;
+        header.benefit = benefit;
+        header.cost = cost;
+        std::vector<int64_t> row_ids(4096), col_ids(16);
+        for (int i = 0; i < 4096; i++) { row_ids[i] = i; }
+        for (int i = 0; i < 16; i++) { col_ids[i] = i; }
+        std::string file = "test_invasion_graph.bin";
+        BuildInvasionMatrix(file, header, row_ids, col_ids,
+            [&](size_t r) {
+                Game sim(assessment_error, perception_error, mu_e, Norm::ConstructFromID(row_ids[r]));
+                double self_payoff = (benefit - cost) * sim.resident_coop;
+                std::array<double, 16> deltas;
+                for (int i = 0; i < 16; i++) {
+                    auto [H, coop_mut_to_res, coop_res_to_mut] = sim.calc_invader_stats(ActionRule::MakeDeterministicRule(i));
+                    deltas[i] = benefit * coop_res_to_mut - cost * coop_mut_to_res - self_payoff;
+                }
+                return std::make_pair(self_payoff, deltas);
+            },
+            [](const std::array<double, 16>& deltas, size_t c) { return deltas[c]; });
+
+        InvasionMatrix m(file);
+        InvasionGraph g = InvasionGraph::FromMatrix(m);
+        std::remove(file.c_str());
+        for (size_t v = 0; v < g.NumNodes(); v++) {
+            Game sim(assessment_error, perception_error, mu_e, Norm::ConstructFromID(g.node_ids[v]));
+            assert ((g.OutDegree(v) == 0) == sim.isESS(benefit, cost));
+            // invaders share the resident's assessment rule
+            for (uint64_t k = g.offsets[v]; k < g.offsets[v + 1]; k++) {
+                assert ((g.node_ids[g.targets[k]] >> 4) == (g.node_ids[v] >> 4));
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "InvasionMatrix.hpp"
+
+using namespace two_action;
+
+int main() {
+    double assessment_error = 0.02, perception_error = 0.01, mu_e = 0.03;
+    double benefit = 1.0, cost = 0.3;
+
+    InvasionMatrixHeader header;
+    header.assessment_error = assessment_error;
+    header.perception_error = perception_error;
+    header.mu_e = mu_e;
+    header.benefit = benefit;
+    header.cost = cost;
+    header.full_norm_invaders = 1;
+
+    // residents: every 7th norm; invaders: all 4096 norms
+    std::vector<int64_t> row_ids, col_ids;
+    for (int i = 0; i < 4096; i += 7) { row_ids.push_back(i); }
+    for (int i = 0; i < 4096; i++) { col_ids.push_back(i); }
+
+    auto prepare = [&](size_t r) {
+        Game sim(assessment_error, perception_error, mu_e, Norm::ConstructFromID(row_ids[r]));
+        double self_payoff = (benefit - cost) * sim.resident_coop;
+        std::array<double, 16> deltas;
+        for (int i = 0; i < 16; i++) {
+            auto [H, coop_mut_to_res, coop_res_to_mut] = sim.calc_invader_stats(ActionRule::MakeDeterministicRule(i));
+            deltas[i] = benefit * coop_res_to_mut - cost * coop_mut_to_res - self_payoff;
+        }
+        return std::make_pair(self_payoff, deltas);
+    };
+    auto entry = [&](const std::array<double, 16>& deltas, size_t c) { return deltas[col_ids[c] & 0xF]; };
+
+    std::string file = "test_invasion_matrix.bin";
+    // tiles that do not divide the matrix evenly
+    BuildInvasionMatrix(file, header, row_ids, col_ids, prepare, entry, 5, 300, 3);
+
+    {
+        InvasionMatrix m(file);
+        assert (m.Rows() == row_ids.size() && m.Cols() == 4096);
+        assert (m.Header().full_norm_invaders == 1 && m.Header().cost == cost);
+
+        for (size_t r = 0; r < m.Rows(); r++) {
+            assert (m.RowID(r) == row_ids[r]);
+            Norm resident = Norm::ConstructFromID(m.RowID(r));
+            Game sim(assessment_error, perception_error, mu_e, resident);
+            double self_payoff = (benefit - cost) * sim.resident_coop;
+            assert (m.ResidentPayoff(r) == self_payoff);
+
+            // 1. Entries agree with Game and the ESS verdict
+            bool can_be_invaded = false;
+            for (size_t c = 0; c < 16; c++) {
+                auto [H, coop_mut_to_res, coop_res_to_mut] = sim.calc_invader_stats(ActionRule::MakeDeterministicRule(c));
+                assert (m.Delta(r, c) == benefit * coop_res_to_mut - cost * coop_mut_to_res - self_payoff);
+                if (static_cast<int>(c) != resident.action_rule.ID() && m.Delta(r, c) > 0.0) { can_be_invaded = true; }
+            }
+            assert (can_be_invaded == !sim.isESS(benefit, cost));
+
+            // 2. Full-norm invaders only differ through their action rule
+            for (size_t c = 16; c < m.Cols(); c += 37) {
+                assert (m.Delta(r, c) == m.Delta(r, c & 0xF));
+            }
+        }
+    }
+    std::remove(file.c_str());
+
+    return 0;
+}
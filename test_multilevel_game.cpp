@@ -0,0 +1,134 @@
+#include <iostream>
+#include <cassert>
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "MultiLevelGame.hpp"
+#include "AgentSimulator.hpp"
+
+using namespace two_action;
+
+template <int M>
+MultiLevelNorm<M> RandomNorm(CounterRNG& rng) {
+    MultiLevelNorm<M> n;
+    for (auto& s : n.coop_probs) { s = rng.Next() & 1; }
+    for (int x = 0; x < M; x++) {
+        for (int y = 0; y < M; y++) {
+            for (int a = 0; a < 2; a++) { n.SetLevel(x, y, a, rng.Index(M)); }
+        }
+    }
+    return n;
+}
+
+template <int M>
+void TestRandomNorms(int num_norms) {
+    CounterRNG rng(M, 0);
+    std::vector<MultiLevelNorm<M>> norms;
+    for (int i = 0; i < num_norms; i++) { norms.push_back(RandomNorm<M>(rng)); }
+    auto batch = MultiLevelGame<M>::calc_equilibrium_states(norms, 0.02, 0.02, 0.01, 2);
+    int converged = 0;
+    for (int i = 0; i < num_norms; i++) {
+        MultiLevelGame<M> game(0.02, 0.02, 0.01, norms[i]);
+        assert (batch[i].state == game.equilibrium_state);
+        if (game.solution.residual >= 1e-14) { continue; }
+        converged++;
+
+        // the solution is stationary under the residents' own transitions
+        auto P = MultiLevelGame<M>::Transition(game.r_norm, game.r_norm.coop_probs, game.equilibrium_state);
+        double sum = 0.0;
+        for (int l = 0; l < M; l++) {
+            double next = 0.0;
+            for (int x = 0; x < M; x++) { next += game.equilibrium_state[x] * P[x][l]; }
+            assert (std::abs(next - game.equilibrium_state[l]) < 1e-13);
+            assert (game.equilibrium_state[l] >= 0.0);
+            sum += game.equilibrium_state[l];
+        }
+        assert (std::abs(sum - 1.0) < 1e-14);
+    }
+    assert (converged > 0.95 * num_norms);
+}
+
+// Anderson acceleration ends where the relaxed rounds alone end, in fewer iterations.
+template <int M>
+void TestAcceleration() {
+    long accelerated = 0, plain = 0;
+    for (const auto& norm : {Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(),
+                             Norm::L5(), Norm::L6(), Norm::L7(), Norm::L8()}) {
+        auto r_norm = MultiLevelNorm<M>::Graded(norm).RescaleWithError(0.02, 0.02, 0.01);
+        auto uniform = MultiLevelGame<M>::UniformDistribution();
+        auto a = MultiLevelGame<M>::Solve(r_norm, uniform);
+        auto p = MultiLevelGame<M>::Solve(r_norm, uniform, 1e-14, 100000, 0);
+        assert (a.residual < 1e-14 && p.residual < 1e-14);
+        for (int l = 0; l < M; l++) { assert (std::abs(a.state[l] - p.state[l]) < 1e-12); }
+        accelerated += a.iterations;
+        plain += p.iterations;
+    }
+    assert (accelerated < plain);
+}
+
+int main() {
+
+    // 1. With two levels the model reproduces Game for every deterministic norm
+    for (int id = 0; id < 4096; id++) {
+        Norm norm = Norm::ConstructFromID(id);
+        Game game(0.02, 0.01, 0.03, norm);
+        MultiLevelGame<2> ml(0.02, 0.01, 0.03, MultiLevelNorm<2>::Graded(norm));
+        assert (std::abs(ml.equilibrium_state[1] - game.equilibrium_state) < 1e-12);
+        assert (std::abs(ml.resident_coop - game.resident_coop) < 1e-12);
+        for (int i = 0; i < 16; i++) {
+            ActionRule invader = ActionRule::MakeDeterministicRule(i);
+            auto [H, coop_mut_to_res, coop_res_to_mut] = game.calc_invader_stats(invader);
+            auto [Hs, ml_mut_to_res, ml_res_to_mut] = ml.calc_invader_stats(MultiLevelNorm<2>::GradedActionRule(invader));
+            assert (std::abs(Hs[1] - H) < 1e-12);
+            assert (std::abs(ml_mut_to_res - coop_mut_to_res) < 1e-12);
+            assert (std::abs(ml_res_to_mut - coop_res_to_mut) < 1e-12);
+        }
+    }
+
+    // 2. Same ESS verdicts for the leading eight over a range of costs
+    {
+        std::vector<std::array<double, 4>> invaders;
+        for (int i = 0; i < 16; i++) {
+            invaders.push_back(MultiLevelNorm<2>::GradedActionRule(ActionRule::MakeDeterministicRule(i)));
+        }
+        for (const auto& norm : {Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(),
+                                 Norm::L5(), Norm::L6(), Norm::L7(), Norm::L8()}) {
+            Game game(0.01, 0.01, 0.01, norm);
+            MultiLevelGame<2> ml(0.01, 0.01, 0.01, MultiLevelNorm<2>::Graded(norm));
+            for (double c = 0.05; c < 1.0; c += 0.1) {
+                assert (ml.isESS(invaders, 1.0, c) == game.isESS(1.0, c));
+            }
+        }
+    }
+
+    // 3. With more levels the solutions are stationary, the batch solve gives the same
+    // results, and Anderson acceleration reaches the fixed point of the plain iteration
+    TestRandomNorms<3>(500);
+    TestRandomNorms<4>(500);
+    TestRandomNorms<5>(500);
+    TestAcceleration<3>();
+    TestAcceleration<4>();
+    TestAcceleration<5>();
+
+    // 4. Under graded L3 more levels keep most residents at the top; the invader who
+    // never cooperates sinks to the bottom level
+    {
+        MultiLevelGame<4> game(0.01, 0.01, 0.01, MultiLevelNorm<4>::Graded(Norm::L3()));
+        assert (game.equilibrium_state[3] > 0.9);
+        auto [H, coop_mut_to_res, coop_res_to_mut] = game.calc_invader_stats(MultiLevelNorm<4>::GradedActionRule(ActionRule::ALLD()));
+        assert (H[0] > 0.9);
+        assert (coop_mut_to_res == 0.0);
+        assert (coop_res_to_mut < 0.1);
+    }
+
+    // 5. A warm start from the solution converges at once
+    {
+        auto norm = MultiLevelNorm<5>::Graded(Norm::L1());
+        MultiLevelGame<5> cold(0.02, 0.02, 0.02, norm);
+        MultiLevelGame<5> warm(0.02, 0.02, 0.02, norm, cold.equilibrium_state);
+        assert (warm.solution.iterations <= 2);
+        assert (cold.solution.iterations < 100);
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
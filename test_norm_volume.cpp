@@ -0,0 +1,117 @@
+#include <iostream>
+#include <cassert>
+#include <set>
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "NormVolume.hpp"
+
+using namespace two_action;
+
+Norm MakeNorm(const double* x) {
+    return Norm(AssessmentRule({x[0], x[1], x[2], x[3], x[4], x[5], x[6], x[7]}),
+                ActionRule({x[8], x[9], x[10], x[11]}));
+}
+
+int main() {
+
+    // 1. Digitally shifted Sobol points stay stratified in every coordinate
+    {
+        SobolSequence sobol(12);
+        uint32_t shift[12];
+        CounterRNG rng(7, 0);
+        for (auto& s : shift) { s = static_cast<uint32_t>(rng.Next() >> 32); }
+        const size_t n = 1024;
+        std::vector<double> buffer(12 * n);
+        std::vector<double*> x(12);
+        for (int j = 0; j < 12; j++) { x[j] = &buffer[j * n]; }
+        sobol.Fill(0, n, x.data(), shift);
+        for (int j = 0; j < 12; j++) {
+            std::set<int> cells;
+            for (size_t i = 0; i < n; i++) { cells.insert(static_cast<int>(x[j][i] * n)); }
+            assert (cells.size() == n);
+        }
+    }
+
+    // 2. The batch kernel reproduces Game, for stochastic action rules and for each fixed
+    //    deterministic action rule
+    for (int action_rule_id = -1; action_rule_id < 16; action_rule_id++) {
+        const double ae = 0.02, pe = 0.05, mu_e = 0.01, b = 1.0, c = 0.3;
+        NormVolume volume(ae, pe, mu_e, b, c, 0.9, action_rule_id);
+        assert (volume.Dimension() == (action_rule_id < 0 ? 12 : 8));
+        CounterRNG rng(11, action_rule_id + 1);
+        const size_t n = 2000;
+        std::vector<double> buffer(12 * n);
+        std::vector<double*> x(12);
+        for (int j = 0; j < 12; j++) { x[j] = &buffer[j * n]; }
+        for (size_t i = 0; i < n; i++) {
+            for (int j = 0; j < 12; j++) {
+                // a third of the probabilities sit on 0 or 1 to reach the boundary of the cube
+                double u = rng.Uniform();
+                x[j][i] = (u < 0.15) ? 0.0 : (u < 0.3) ? 1.0 : rng.Uniform();
+            }
+            if (action_rule_id >= 0) {
+                for (int k = 0; k < 4; k++) { x[8 + k][i] = (action_rule_id >> k) & 1; }
+            }
+        }
+        std::vector<uint8_t> ess(n);
+        std::vector<double> coop(n);
+        volume.Evaluate(n, x.data(), ess.data(), coop.data());
+        for (size_t i = 0; i < n; i++) {
+            double p[12];
+            for (int j = 0; j < 12; j++) { p[j] = x[j][i]; }
+            Game game(ae, pe, mu_e, MakeNorm(p));
+            assert (std::abs(coop[i] - game.resident_coop) < 1e-12);
+            if (std::abs(game.calc_ess_margin(b, c)) > 1e-10) { assert (static_cast<bool>(ess[i]) == game.isESS(b, c)); }
+        }
+    }
+
+    // 3. Estimates: independent of the thread count, consistent with plain Monte Carlo,
+    //    and early stopping at the target precision
+    {
+        const double ae = 0.02, pe = 0.02, mu_e = 0.02, b = 1.0, c = 0.2;
+        NormVolume volume(ae, pe, mu_e, b, c, 0.5, 1);
+        std::vector<uint64_t> rounds;
+        auto one = volume.Run(8, 0.0, 1 << 15, 42, 1, [&](const NormVolume::Progress& p) { rounds.push_back(p.points_per_replicate); });
+        auto many = volume.Run(8, 0.0, 1 << 15, 42, 3);
+        assert ((rounds == std::vector<uint64_t>{4096, 8192, 16384, 32768}));
+        assert (!one.converged && one.points_per_replicate == (1 << 15));
+        assert (one.ess.mean == many.ess.mean && one.ess.half_width == many.ess.half_width);
+        assert (one.ess_cooperative.mean == many.ess_cooperative.mean);
+        assert (one.ess.half_width > 0.0 && one.ess_cooperative.mean <= one.ess.mean);
+
+        CounterRNG rng(3, 0);
+        const long samples = 100000;
+        long num_ess = 0, num_cooperative = 0;
+        for (long s = 0; s < samples; s++) {
+            double p[12] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0};
+            for (int j = 0; j < 8; j++) { p[j] = rng.Uniform(); }
+            Game game(ae, pe, mu_e, MakeNorm(p));
+            bool stable = game.isESS(b, c);
+            num_ess += stable;
+            num_cooperative += stable && game.resident_coop >= 0.5;
+        }
+        auto close = [samples](const Estimate& e, long hits) {
+            double f = static_cast<double>(hits) / samples;
+            double se = std::sqrt(f * (1.0 - f) / samples);
+            return std::abs(e.mean - f) < 4.0 * (se + e.half_width / 1.96);
+        };
+        assert (close(one.ess, num_ess));
+        assert (close(one.ess_cooperative, num_cooperative));
+
+        auto early = volume.Run(8, 1.0, 1 << 20, 42, 2);
+        assert (early.converged && early.points_per_replicate == 4096);
+        auto stopped = volume.Run(8, 2.0 * std::max(one.ess.half_width, one.ess_cooperative.half_width), 1 << 20, 42, 2);
+        assert (stopped.converged && stopped.points_per_replicate <= (1 << 15));
+
+        // stochastic action rules are always beaten by a deterministic invader
+        auto stochastic = NormVolume(ae, pe, mu_e, b, c, 0.5).Run(4, 0.0, 1 << 14, 42, 2);
+        assert (stochastic.ess.mean == 0.0);
+
+        bool thrown = false;
+        try { volume.Run(8, 0.0, SobolSequence::MaxPoints + 1, 42, 1); } catch (const std::runtime_error&) { thrown = true; }
+        assert (thrown);
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -1,5 +1,7 @@
 #include "Norms.hpp"
 
+using namespace two_action;
+
 int main() {
     constexpr Reputation B = Reputation::B, G = Reputation::G;
     constexpr Action C = Action::C, D = Action::D;
@@ -1,5 +1,7 @@
 #include "NormsWithPunishment.hpp"
 
+using namespace with_punishment;
+
 int main() {
     constexpr Reputation B = Reputation::B, G = Reputation::G;
     constexpr Action C = Action::C, D = Action::D, P = Action::P;
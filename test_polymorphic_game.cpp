@@ -0,0 +1,110 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "PolymorphicGame.hpp"
+#include "AgentSimulator.hpp"
+
+using namespace two_action;
+
+double BisectionState(const PolymorphicGame& poly, const std::vector<double>& x) {
+    double lo = 0.0, hi = 1.0;
+    for (int it = 0; it < 200; it++) {
+        double mid = 0.5 * (lo + hi), f = -mid;
+        for (size_t j = 0; j < poly.NumTypes(); j++) { f += x[j] * poly.calc_type_image(j, mid); }
+        if (f > 0.0) { lo = mid; } else { hi = mid; }
+    }
+    return 0.5 * (lo + hi);
+}
+
+std::vector<double> RandomShares(CounterRNG& rng, size_t k) {
+    std::vector<double> x(k);
+    double total = 0.0;
+    for (auto& xi : x) { xi = -std::log(1.0 - rng.Uniform()); total += xi; }
+    for (auto& xi : x) { xi /= total; }
+    return x;
+}
+
+int main() {
+
+    std::vector<Norm> l8_norms = {Norm::L1(), Norm::L2(), Norm::L3(), Norm::L4(),
+                                  Norm::L5(), Norm::L6(), Norm::L7(), Norm::L8()};
+    CounterRNG rng(2, 0);
+
+    // 1. The analytic derivative matches finite differences
+    for (const auto& norm : l8_norms) {
+        auto poly = PolymorphicGame::AllActionRules(0.03, 0.02, 0.01, norm.assessment_rule);
+        for (size_t i = 0; i < 16; i++) {
+            for (double g : {0.1, 0.5, 0.9}) {
+                double fd = (poly.calc_type_image(i, g + 1e-6) - poly.calc_type_image(i, g - 1e-6)) / 2e-6;
+                assert (std::abs(fd - poly.calc_type_image_derivative(i, g)) < 1e-7);
+            }
+        }
+    }
+
+    // 2. Newton agrees with bisection and needs few iterations, fewer still with a warm start
+    for (const auto& norm : l8_norms) {
+        auto poly = PolymorphicGame::AllActionRules(0.02, 0.01, 0.02, norm.assessment_rule);
+        std::vector<double> previous = RandomShares(rng, 16);
+        double g_previous = poly.calc_equilibrium_state(previous);
+        for (int t = 0; t < 50; t++) {
+            auto x = RandomShares(rng, 16);
+            int cold = 0, warm = 0;
+            double g = poly.calc_equilibrium_state(x, -1.0, 1e-14, &cold);
+            assert (std::abs(g - BisectionState(poly, x)) < 1e-12);
+            assert (cold <= 8);
+            // a nearby point
+            std::vector<double> y(16);
+            for (size_t i = 0; i < 16; i++) { y[i] = 0.99 * previous[i] + 0.01 * x[i]; }
+            double gy = poly.calc_equilibrium_state(y, g_previous, 1e-14, &warm);
+            assert (std::abs(gy - BisectionState(poly, y)) < 1e-12);
+            assert (warm <= 4);
+            previous = x;
+            g_previous = g;
+        }
+    }
+
+    // 3. Batch solves match single solves
+    {
+        auto poly = PolymorphicGame::AllActionRules(0.01, 0.0, 0.01, Norm::L6().assessment_rule);
+        std::vector<std::vector<double>> xs;
+        for (int t = 0; t < 40; t++) { xs.push_back(RandomShares(rng, 16)); }
+        auto gs = poly.calc_equilibrium_states(xs, 3);
+        for (size_t n = 0; n < xs.size(); n++) { assert (std::abs(gs[n] - poly.calc_equilibrium_state(xs[n])) < 1e-12); }
+    }
+
+    // 4. The ends of an invasion curve are Game's resident and rare-invader payoffs
+    double benefit = 1.0, cost = 0.2;
+    for (const auto& norm : l8_norms) {
+        Game game(0.02, 0.0, 0.01, norm);
+        auto poly = PolymorphicGame::AllActionRules(0.02, 0.0, 0.01, norm.assessment_rule);
+        int resident = norm.action_rule.ID();
+        for (int i = 0; i < 16; i++) {
+            if (i == resident) { continue; }
+            auto edge = poly.calc_edge(resident, i, benefit, cost, 21);
+            auto [H, coop_mut_to_res, coop_res_to_mut] = game.calc_invader_stats(ActionRule::MakeDeterministicRule(i));
+            const auto& start = edge.curve.front();
+            assert (std::abs(start.resident_payoff - (benefit - cost) * game.resident_coop) < 1e-12);
+            assert (std::abs(start.invader_payoff - (benefit * coop_res_to_mut - cost * coop_mut_to_res)) < 1e-12);
+            // the leading eight are ESS here, so no action rule invades them
+            assert (edge.dynamics == EdgeDynamics::ResidentDominates || edge.dynamics == EdgeDynamics::Bistability
+                    || edge.dynamics == EdgeDynamics::Neutral);
+            for (double s : edge.rest_points) {
+                std::vector<double> x(16, 0.0);
+                x[resident] = 1.0 - s;
+                x[i] = s;
+                auto pi = poly.calc_payoffs(x, benefit, cost);
+                assert (std::abs(pi[resident] - pi[i]) < 1e-9);
+            }
+        }
+    }
+
+    // 5. With everyone judged good ALLD dominates ALLC
+    {
+        PolymorphicGame poly(0.0, 0.0, 0.0, AssessmentRule::AllGood(), {ActionRule::ALLC(), ActionRule::ALLD()});
+        assert (poly.calc_edge(0, 1, benefit, cost).dynamics == EdgeDynamics::InvaderDominates);
+        assert (poly.calc_edge(1, 0, benefit, cost).dynamics == EdgeDynamics::ResidentDominates);
+        PolymorphicGame same(0.0, 0.0, 0.0, AssessmentRule::AllGood(), {ActionRule::ALLD(), ActionRule::ALLD()});
+        assert (same.calc_edge(0, 1, benefit, cost).dynamics == EdgeDynamics::Neutral);
+    }
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "PrivateAssessment.hpp"
+
+#include <cassert>
+
+using namespace private_assessment;
+
+int main() {
+
+    // 1. The word-level update agrees with a bit-by-bit evaluation of the rule
+    CounterRNG rng(5, 0);
+    for (int num_actions : {2, 3}) {
+        int num_rules = 1 << (4 * num_actions);
+        for (int id = 0; id < num_rules; id += (num_actions == 2) ? 1 : 37) {
+            for (int action = 0; action < num_actions; action++) {
+                auto table = ImageTable(num_actions, id, action);
+                uint64_t x[2] = {rng.Next(), rng.Next()}, y[2] = {rng.Next(), rng.Next()};
+                uint64_t e[2] = {rng.Next(), rng.Next()}, f[2] = {rng.Next(), rng.Next()}, h[2] = {rng.Next(), rng.Next()};
+                uint64_t out[2] = {x[0], x[1]};
+                UpdateRow(table, out, y, e, f, h, 2);
+                for (int o = 0; o < 128; o++) {
+                    auto bit = [o](const uint64_t* v) { return static_cast<int>((v[o >> 6] >> (o & 63)) & 1); };
+                    int observed = (bit(e) && action == 0) ? 1 : action;
+                    int expected = RuleBit(num_actions, id, bit(x), bit(y), observed) ^ bit(f);
+                    if (bit(h)) { expected = bit(x); }
+                    assert (bit(out) == expected);
+                }
+            }
+        }
+    }
+
+    // 2. Bernoulli masks have the right density and clean padding
+    for (double p : {0.0, 0.01, 0.3, 0.5, 0.9, 1.0}) {
+        std::vector<uint64_t> mask(16);
+        long ones = 0;
+        for (int t = 0; t < 200; t++) {
+            BernoulliMask(rng, p, 1000, mask.data());
+            for (uint64_t w : mask) { ones += __builtin_popcountll(w); }
+            assert ((mask[15] >> (1000 % 64)) == 0);
+        }
+        assert (std::abs(ones / 200000.0 - p) < 0.01);
+    }
+
+    // 3. Action rule IDs
+    assert ((ActionsFromID(2, 0b1010) == std::array<uint8_t, 4>{0, 1, 0, 1}));
+    assert ((ActionsFromID(3, 1 + 2 * 3 + 0 * 9 + 1 * 27) == std::array<uint8_t, 4>{1, 2, 0, 1}));
+
+    // 4. Without errors and with a shared starting view everyone keeps agreeing
+    int stern_judging = 0b10011001;   // G if (C to G) or (D to B), regardless of the donor
+    {
+        PrivateAssessmentSimulator sim(2, stern_judging, {0b1010}, {300}, 0.0, 0.0);
+        sim.Initialize(rng, 1.0);
+        auto stats = sim.Run(rng, 2, 5);
+        assert (stats.Agreement() == 1.0);
+        assert (stats.Rate(0, 0, 1) == 1.0);
+    }
+
+    // 5. Image scoring: ALLC is seen as good and ALLD as bad by everyone after a few rounds
+    {
+        int image_scoring = 0b10101010;
+        PrivateAssessmentSimulator sim(2, image_scoring, {0b1111, 0b0000}, {150, 50}, 0.0, 0.0);
+        sim.Initialize(rng, 0.5);
+        auto stats = sim.Run(rng, 20, 5);
+        assert (stats.Good(0) == 1.0 && stats.Good(1) == 0.0);
+        assert (stats.Rate(0, 1, 1) == 1.0 && stats.Rate(1, 0, 0) == 1.0);
+    }
+
+    // 6. Private assignment errors let the observers' views drift apart under stern judging,
+    //    and only partial observation lets some images go stale
+    {
+        PrivateAssessmentSimulator sim(2, stern_judging, {0b1010}, {256}, 0.02, 0.0, 0.0, 0.5);
+        sim.Initialize(rng, 1.0);
+        auto stats = sim.Run(rng, 20, 10);
+        assert (stats.Agreement() < 0.9 && stats.Agreement() > 0.4);
+        assert (stats.interactions == 2560);
+    }
+
+    // 7. Three actions: punishing bad recipients under a rule that approves it keeps everyone good
+    {
+        int rule = 0;
+        for (int x = 0; x < 2; x++) {
+            rule |= 1 << ((x * 2 + 1) * 3 + 1);   // C to G is good
+            rule |= 1 << ((x * 2 + 0) * 3 + 2);   // P to B is good
+        }
+        int action_id = 2 + 1 * 3 + 2 * 9 + 1 * 27;   // P to B, C to G
+        PrivateAssessmentSimulator sim(3, rule, {action_id}, {100}, 0.0, 0.0);
+        sim.Initialize(rng, 1.0);
+        auto stats = sim.Run(rng, 1, 5);
+        assert (stats.Good(0) == 1.0 && stats.Rate(0, 0, 1) == 1.0);
+    }
+
+    // 8. Type indices are bytes: 256 types are accepted, more are rejected
+    {
+        PrivateAssessmentSimulator sim(2, stern_judging, std::vector<int>(256, 0b1010), std::vector<size_t>(256, 1),
+                                       0.0, 0.0);
+        assert (sim.type[255] == 255);
+        bool threw = false;
+        try {
+            PrivateAssessmentSimulator(2, stern_judging, std::vector<int>(257, 0b1010), std::vector<size_t>(257, 1),
+                                       0.0, 0.0);
+        } catch (const std::runtime_error&) { threw = true; }
+        assert (threw);
+    }
+
+    return 0;
+}
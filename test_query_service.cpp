@@ -0,0 +1,140 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <sstream>
+#include "QueryService.hpp"
+
+using namespace two_action;
+
+std::string Ask(QueryService& service, const std::string& request) {
+    std::ostringstream out;
+    service.Handle(request, out);
+    return out.str();
+}
+
+// Value of `key=` in a reply line.
+std::string Field(const std::string& reply, const std::string& key) {
+    size_t at = reply.find(" " + key + "=");
+    assert (at != std::string::npos);
+    at += key.size() + 2;
+    return reply.substr(at, reply.find_first_of(" \n", at) - at);
+}
+
+int main() {
+    const std::string path = "test_query_service.cache";
+    std::remove(path.c_str());
+
+    // 1. single queries equal the game, with the invader attaining the margin; the second
+    //    identical query is answered from the cache
+    {
+        ResultCache cache(path, true);
+        QueryService service(&cache, 2);
+        const two_action::Norm norm = two_action::Norm::ConstructFromID(0x2F3);
+        two_action::Game game(0.02, 0.02, 0.02, norm);
+        int best = -1;
+        double margin = game.calc_ess_margin(3.0, 1.0, &best);
+
+        std::string reply = Ask(service, "ess 0x2F3 0.02 0.02 0.02 3 1");
+        assert (reply.compare(0, 3, "ok ") == 0);
+        assert (std::stoi(Field(reply, "norm")) == 0x2F3);
+        assert (std::stoi(Field(reply, "ess")) == game.isESS(3.0, 1.0));
+        assert (std::stoi(Field(reply, "best_invader")) == best);
+        assert (std::abs(std::stod(Field(reply, "margin")) - margin) < 1e-10);
+        assert (std::abs(std::stod(Field(reply, "h")) - game.equilibrium_state) < 1e-10);
+        assert (Ask(service, "ess 755 0.02 0.02 0.02 3 1") == reply);
+        reply = Ask(service, "stats");
+        assert (Field(reply, "computed") == "1" && Field(reply, "cached") == "1" && Field(reply, "cache_entries") == "1");
+
+        assert (Ask(service, "ess 4096 0.02 0.02 0.02 3 1").compare(0, 5, "error") == 0);
+        assert (Ask(service, "ess 1 1.5 0.02 0.02 3 1").compare(0, 5, "error") == 0);
+        assert (Ask(service, "ess 1 0.02 0.02").compare(0, 5, "error") == 0);
+        assert (Ask(service, "frobnicate").compare(0, 5, "error") == 0);
+        std::ostringstream ignored;
+        assert (!service.Handle("quit", ignored) && service.Handle("", ignored));
+    }
+
+    // 2. range queries stream one row per point in grid order, closed by "end"
+    {
+        ResultCache cache(path, true);
+        QueryService service(&cache, 3);
+        std::istringstream reply(Ask(service, "range L3,L6 0.01,0.02 0.02 0:0.04:0.02 1 0.2,0.5"));
+        std::string line;
+        std::getline(reply, line);
+        assert (line.compare(0, 8, "columns ") == 0);
+        int rows = 0;
+        while (std::getline(reply, line) && line.compare(0, 3, "end") != 0) {
+            std::istringstream fields(line);
+            std::vector<double> v;
+            for (std::string f; std::getline(fields, f, ',');) { v.push_back(std::stod(f)); }
+            assert (v.size() == 12);
+            assert (static_cast<int>(v[0]) == (rows < 12 ? two_action::Norm::L3().ID() : two_action::Norm::L6().ID()));
+            two_action::Game game(v[1], v[2], v[3], two_action::Norm::ConstructFromID(static_cast<int>(v[0])));
+            assert (v[6] == game.isESS(v[4], v[5]));
+            assert (std::abs(v[7] - game.calc_ess_margin(v[4], v[5])) < 1e-10);
+            rows++;
+        }
+        assert (rows == 2 * 2 * 1 * 3 * 1 * 2 && line == "end 24");
+    }
+
+    // 3. ESS sets from a bitmap on its grid and computed elsewhere agree
+    {
+        ESSBitmapStore store(2);
+        store.entries.push_back({{0.02, 0.02, 0.02, 1.0, 0.2}, RoaringBitmap()});
+        for (int id = 0; id < 4096; id++) {
+            two_action::Game game(0.02, 0.02, 0.02, two_action::Norm::ConstructFromID(id));
+            if (game.isESS(1.0, 0.2)) { store.entries[0].ess.Add(id); }
+        }
+        QueryService with_bitmap(nullptr, 2), without(nullptr, 2);
+        with_bitmap.AddBitmaps(store);
+        std::string a = Ask(with_bitmap, "ess_set 0.02 0.02 0.02 1 0.2");
+        std::string b = Ask(without, "ess_set 0.02 0.02 0.02 1 0.2");
+        assert (Field(a, "source") == "bitmap" && Field(b, "source") == "computed");
+        assert (Field(a, "count") == Field(b, "count") && Field(a, "ids") == Field(b, "ids"));
+        assert (std::stoi(Field(a, "count")) == static_cast<int>(store.entries[0].ess.Cardinality()));
+        assert (Field(Ask(without, "stats"), "memory_entries") == "4096");
+        bool thrown = false;
+        try { with_bitmap.AddBitmaps(ESSBitmapStore(3)); } catch (const std::runtime_error&) { thrown = true; }
+        assert (thrown);
+    }
+
+    // 4. with a read-only cache, computed results stay in memory and cached ones are read
+    {
+        ResultCache reader(path);
+        QueryService service(&reader, 1);
+        Ask(service, "ess 755 0.02 0.02 0.02 3 1");
+        Ask(service, "ess 755 0.03 0.02 0.02 3 1");
+        std::string reply = Ask(service, "stats");
+        assert (Field(reply, "cached") == "1" && Field(reply, "computed") == "1" && Field(reply, "memory_entries") == "1");
+    }
+
+    // 5. a read-only cache sees the entries of a writer that grew the file since it was opened
+    {
+        const std::string grown_path = "test_query_service_grown.cache";
+        std::remove(grown_path.c_str());
+        ResultCache writer(grown_path, true, 16);
+        ResultCache reader(grown_path);
+        QueryService service(&reader, 2);
+        for (int id = 0; id < 40; id++) {
+            writer.Insert(id, {0.02, 0.02, 0.02, 3.0, 1.0}, ResultCache::Compute(Game(0.02, 0.02, 0.02, Norm::ConstructFromID(id)), 3.0, 1.0));
+        }
+        for (int id : {0, 17, 39}) { Ask(service, "ess " + std::to_string(id) + " 0.02 0.02 0.02 3 1"); }
+        std::string reply = Ask(service, "stats");
+        assert (Field(reply, "cached") == "3" && Field(reply, "computed") == "0");
+        std::remove(grown_path.c_str());
+        std::remove((grown_path + ".lock").c_str());
+    }
+
+    // 6. results kept in memory are capped, dropping the oldest first
+    {
+        QueryService service(nullptr, 1, 2);
+        for (int id : {1, 2, 3, 2, 1}) { Ask(service, "ess " + std::to_string(id) + " 0.02 0.02 0.02 3 1"); }
+        std::string reply = Ask(service, "stats");
+        assert (Field(reply, "computed") == "4" && Field(reply, "cached") == "1" && Field(reply, "memory_entries") == "2");
+        assert (Field(reply, "cache_entries") == "0");
+    }
+
+    std::remove(path.c_str());
+    std::remove((path + ".lock").c_str());
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "ResultCache.hpp"
+#include "BatchRunner.hpp"
+
+using namespace two_action;
+
+bool Same(const ResultCache::Entry& a, const ResultCache::Entry& b) {
+    return a.h == b.h && a.cooperation == b.cooperation && a.ess_margin == b.ess_margin &&
+           a.delta_v == b.delta_v && a.is_ess == b.is_ess;
+}
+
+int main() {
+    const std::string path = "test_result_cache.bin";
+    std::remove(path.c_str());
+
+    // 1. a missing file is empty for readers; entries persist across writers and are seen
+    //    by a reader mapping the same file, with parameters rounded to the quantum
+    {
+        ResultCache empty(path);
+        ResultCache::Entry e;
+        assert (empty.Size() == 0 && !empty.Lookup(1, {0.0, 0.0, 0.0, 1.0, 0.2}, e));
+    }
+    const ResultCache::Params params = {0.02, 0.01, 0.05, 1.0, 0.3};
+    two_action::Game game(params[0], params[1], params[2], two_action::Norm::L3());
+    const ResultCache::Entry expected = ResultCache::Compute(game, params[3], params[4]);
+    {
+        ResultCache writer(path, true, 16);
+        ResultCache reader(path);
+        ResultCache::Entry e;
+        assert (!reader.Lookup(two_action::Norm::L3().ID(), params, e));
+        assert (writer.Insert(two_action::Norm::L3().ID(), params, expected));
+        assert (writer.Size() == 1 && reader.Size() == 1);
+        assert (reader.Lookup(two_action::Norm::L3().ID(), params, e) && Same(e, expected));
+        assert (reader.Lookup(two_action::Norm::L3().ID(), {0.02 + 1e-9, 0.01, 0.05, 1.0, 0.3}, e));
+        assert (!reader.Lookup(two_action::Norm::L3().ID(), {0.02 + 1e-6, 0.01, 0.05, 1.0, 0.3}, e));
+        assert (!reader.Lookup(two_action::Norm::L4().ID(), params, e));
+        assert (!writer.Insert(1, {0.0, 0.0, 0.0, 1e300, 0.2}, expected));
+
+        // one writer at a time; readers cannot write
+        bool thrown = false;
+        try { ResultCache second(path, true); } catch (const std::runtime_error&) { thrown = true; }
+        assert (thrown);
+        thrown = false;
+        try { reader.Insert(1, params, expected); } catch (const std::runtime_error&) { thrown = true; }
+        assert (thrown);
+    }
+    {
+        ResultCache reader(path);
+        ResultCache::Entry e;
+        assert (reader.Size() == 1 && reader.Lookup(two_action::Norm::L3().ID(), params, e) && Same(e, expected));
+    }
+
+    // 2. growing keeps every entry; an old reader keeps its mapping until Refresh
+    {
+        ResultCache reader(path);
+        ResultCache writer(path, true);
+        for (int id = 0; id < 4096; id += 7) {
+            writer.Insert(id, {0.01, 0.01, 0.01, 1.0, 0.2}, {id * 1.0, 0.5, -0.1, 0.2, false});
+        }
+        assert (writer.Size() == 1 + 586 && writer.Capacity() >= 2 * writer.Size());
+        assert (reader.Capacity() == 16);
+        ResultCache::Entry e;
+        assert (reader.Lookup(two_action::Norm::L3().ID(), params, e) && Same(e, expected));
+        reader.Refresh();
+        assert (reader.Size() == writer.Size());
+        for (int id = 0; id < 4096; id++) {
+            bool found = reader.Lookup(id, {0.01, 0.01, 0.01, 1.0, 0.2}, e);
+            assert (found == (id % 7 == 0));
+            if (found) { assert (e.h == id && !e.is_ess); }
+        }
+    }
+
+    // 3. a file written by other model code is ignored by readers and cleared by the writer
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(16);
+        uint64_t other = ResultCache::ModelFingerprint() + 1;
+        file.write(reinterpret_cast<const char*>(&other), sizeof(other));
+    }
+    {
+        ResultCache reader(path);
+        assert (reader.Size() == 0);
+        ResultCache writer(path, true);
+        assert (writer.Size() == 0);
+        ResultCache::Entry e;
+        assert (!writer.Lookup(two_action::Norm::L3().ID(), params, e));
+        writer.Insert(two_action::Norm::L3().ID(), params, ResultCache::Compute(game, params[3], params[4]));
+    }
+    //    and so is one of another model version, whatever its fingerprint
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(40);
+        uint32_t other = ResultCache::ModelVersion + 1;
+        file.write(reinterpret_cast<const char*>(&other), sizeof(other));
+    }
+    {
+        ResultCache reader(path);
+        assert (reader.Size() == 0);
+        ResultCache writer(path, true);
+        assert (writer.Size() == 0);
+    }
+
+    // 4. a batch run through the cache gives the direct results; the second run only reads
+    {
+        std::istringstream manifest(
+            "[job grid]\nnorms = leading_eight,765\nassessment_error = 0:0.02:0.01\nperception_error = 0.01,0.03\n"
+            "mu_e = 0.02\nbenefit = 1\ncost = 0.2,0.8\ncolumns = h,is_ess,ess_margin,delta_v\noutput = grid.csv\n"
+            "[job payoff]\nnorms = L1\nassessment_error = 0.01\nperception_error = 0.01\nmu_e = 0.02\nbenefit = 1\n"
+            "cost = 0.2\ncolumns = h,resident_payoff\noutput = payoff.csv\n");
+        auto jobs = batch::ParseManifest(manifest);
+        batch::BatchRunner direct(jobs);
+        direct.Run(2);
+
+        ResultCache writer(path, true);
+        batch::BatchRunner first(jobs), second(jobs);
+        first.cache = &writer;
+        first.Run(3);
+        assert (first.cache_hits == 0 && writer.Size() == 9 * 3 * 2 * 2);
+        assert (first.results == direct.results);
+        second.cache = &writer;
+        second.Run(3);
+        assert (second.cache_hits == 9 * 3 * 2 * 2);
+        assert (second.results == direct.results);
+    }
+
+    std::remove(path.c_str());
+    std::remove((path + ".lock").c_str());
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
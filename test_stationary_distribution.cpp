@@ -0,0 +1,81 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "StationaryDistribution.hpp"
+#include <random>
+
+using namespace two_action;
+
+// rho = 1 / (1 + sum_i prod_k T-(k)/T+(k)) with the linearly interpolated payoffs
+double BruteForceFixation(double p_rr, double p_rm, double p_mr, double p_mm, int N, double s) {
+    double sum = 1.0, prod = 1.0;
+    for (int k = 1; k < N; k++) {
+        double pi_m = ((k - 1) * p_mm + (N - k) * p_mr) / (N - 1.0);
+        double pi_r = (k * p_rm + (N - k - 1) * p_rr) / (N - 1.0);
+        prod *= std::exp(-s * (pi_m - pi_r));
+        sum += prod;
+    }
+    return 1.0 / sum;
+}
+
+int main() {
+
+    // 1. Neutral drift fixes with probability 1/N
+    assert (std::abs(FixationProbability(0.3, 0.1, 0.7, 0.2, 50, 0.0) - 1.0 / 50) < 1e-15);
+
+    // 2. Agreement with the direct product formula
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> unif(-1.0, 1.0);
+    for (int t = 0; t < 2000; t++) {
+        double p[4] = {unif(rng), unif(rng), unif(rng), unif(rng)};
+        int N = 2 + rng() % 100;
+        double s = 5.0 * (unif(rng) + 1.0);
+        double expected = BruteForceFixation(p[0], p[1], p[2], p[3], N, s);
+        double rho = FixationProbability(p[0], p[1], p[2], p[3], N, s);
+        assert (std::abs(rho - expected) <= 1e-10 * std::max(expected, 1e-300) + 1e-300);
+    }
+
+    // 3. Strong selection neither overflows nor underflows into NaN
+    for (double s : {100.0, 1000.0, 1e5}) {
+        double rho_adv = FixationProbability(0.0, -1.0, 1.0, 0.5, 100, s);
+        double rho_dis = FixationProbability(0.5, 1.0, -1.0, 0.0, 100, s);
+        double rho_bi = FixationProbability(1.0, -1.0, -1.0, 1.0, 100, s);   // bistable
+        assert (std::isfinite(rho_adv) && rho_adv > 0.5 && rho_adv <= 1.0);
+        assert (std::isfinite(rho_dis) && rho_dis >= 0.0 && rho_dis < 1e-10);
+        assert (std::isfinite(rho_bi) && rho_bi >= 0.0 && rho_bi < 1e-10);
+    }
+
+    // 4. Chain over the 16 action rules under the L3 assessment rule: both solvers agree
+    //    and the distribution is stationary
+    {
+        double assessment_error = 0.02, perception_error = 0.0, mu_e = 0.01, benefit = 1.0, cost = 0.3;
+        AssessmentRule R = Norm::L3().assessment_rule;
+        std::vector<Game> games;
+        for (int i = 0; i < 16; i++) {
+            games.emplace_back(assessment_error, perception_error, mu_e, Norm(R, ActionRule::MakeDeterministicRule(i)));
+        }
+        auto payoffs = [&](size_t i, size_t j) {
+            if (i == j) { return (benefit - cost) * games[i].resident_coop; }
+            auto [H, coop_mut_to_res, coop_res_to_mut] = games[i].calc_invader_stats(ActionRule::MakeDeterministicRule(j));
+            return benefit * coop_res_to_mut - cost * coop_mut_to_res;
+        };
+        MoranChain chain(16, payoffs, 50, 1.0, 3);
+        for (size_t i = 0; i < 16; i++) {
+            double row = 0.0;
+            for (size_t j = 0; j < 16; j++) { row += chain.transition[i * 16 + j]; }
+            assert (std::abs(row - 1.0) < 1e-12);
+        }
+        auto pi_gth = chain.StationaryGTH(2);
+        auto pi_power = chain.StationaryPowerIteration(1e-14, 1000000, 2);
+        double total = 0.0;
+        for (size_t j = 0; j < 16; j++) {
+            total += pi_gth[j];
+            assert (std::abs(pi_gth[j] - pi_power[j]) < 1e-8);
+            double flow = 0.0;
+            for (size_t i = 0; i < 16; i++) { flow += pi_gth[i] * chain.transition[i * 16 + j]; }
+            assert (std::abs(flow - pi_gth[j]) < 1e-12);
+        }
+        assert (std::abs(total - 1.0) < 1e-12);
+    }
+
+    return 0;
+}
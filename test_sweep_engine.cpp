@@ -0,0 +1,63 @@
+#include "Norms.hpp"
+#include "Game.hpp"
+#include "SweepEngine.hpp"
+
+using namespace two_action;
+
+int main() {
+
+    // 1. ParallelFor visits every index exactly once
+    for (unsigned threads : {1u, 3u, 8u}) {
+        std::vector<int> visits(1000, 0);
+        ParallelFor(visits.size(), [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; i++) { visits[i]++; }
+        }, threads);
+        for (int v : visits) { assert (v == 1); }
+    }
+
+    // 2. Counting ESS norms does not depend on the number of threads
+    auto count_ess = [](unsigned threads) {
+        return ParallelReduce(4096, CountSink(2), [](size_t id, CountSink& sink) {
+            Game sim(0.01, 0.0, 0.0, Norm::ConstructFromID(id));
+            sink.Add(sim.isESS(3.0, 1.0) ? 1 : 0);
+        }, threads).counts;
+    };
+    auto serial = count_ess(1);
+    assert (serial[0] + serial[1] == 4096);
+    assert (serial[1] > 0);
+    assert (count_ess(4) == serial);
+
+    // 3. Histogram bins, underflow and overflow
+    HistogramSink hist = ParallelReduce(100, HistogramSink(0.0, 1.0, 10), [](size_t i, HistogramSink& sink) {
+        sink.Add((static_cast<double>(i) - 25.0) / 50.0 + 0.01);
+    }, 3);
+    assert (hist.underflow == 25);
+    assert (hist.overflow == 25);
+    for (long c : hist.counts) { assert (c == 5); }
+
+    // 4. Extrema and their arguments; ties go to the smaller index
+    ExtremumSink ext = ParallelReduce(160, ExtremumSink(), [](size_t i, ExtremumSink& sink) {
+        sink.Add((i % 16 == 3) ? 200.0 : static_cast<double>(i % 16), i);
+    }, 4);
+    assert (ext.max == 200.0 && ext.argmax == 3);
+    assert (ext.min == 0.0 && ext.argmin == 0);
+    assert (ext.count == 160);
+
+    // 5. Grid means
+    GridSink grid = ParallelReduce(400, GridSink(2, 0.0, 1.0, 2, 0.0, 1.0), [](size_t i, GridSink& sink) {
+        double x = (i % 20) / 19.0, y = (i / 20) / 19.0;
+        sink.Add(x, y, x < 0.5 ? 1.0 : 0.0);
+    }, 3);
+    assert (grid.counts[0] == 100);
+    assert (grid.Mean(0, 0) == 1.0 && grid.Mean(0, 1) == 1.0);
+    assert (grid.Mean(1, 0) == 0.0 && grid.Mean(1, 1) == 0.0);
+
+    // 6. One grid per key
+    KeyedGridSink slices = ParallelReduce(300, KeyedGridSink(3, GridSink(2, 0.0, 1.0, 2, 0.0, 1.0)),
+        [](size_t i, KeyedGridSink& sink) { sink.Add(i % 3, 0.25, 0.75, static_cast<double>(i % 3)); }, 4);
+    for (size_t key = 0; key < 3; key++) {
+        assert (slices.keys[key].counts[2] == 100 && slices.keys[key].Mean(0, 1) == static_cast<double>(key));
+    }
+
+    return 0;
+}